@@ -0,0 +1,39 @@
+#version 330 core
+// format PackedVertex: pozycja unorm16 w ramce terenu, normalna oktaedryczna, UV half
+layout(location=0) in vec3 aPos;
+layout(location=1) in vec4 aNrm;
+layout(location=2) in vec2 aUV;
+// ramka kwantyzacji: (origin, uvOrigin.x), (extent, uvOrigin.y)
+layout(location=3) in vec4 aQuant0;
+layout(location=4) in vec4 aQuant1;
+
+uniform mat4 model;
+uniform mat4 view;
+uniform mat4 projection;
+
+out VS {
+    vec3 PosWS;
+    vec3 NrmWS;
+    vec2 uv;
+} v;
+
+vec3 octDecode(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    if (n.z < 0.0) {
+        vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(n.yx)) * s;
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec3 pos = aQuant0.xyz + aPos * aQuant1.xyz;
+    vec4 posWS = model * vec4(pos, 1.0);
+    v.PosWS = posWS.xyz;
+
+    mat3 normalMatrix = transpose(inverse(mat3(model)));
+    v.NrmWS = normalize(normalMatrix * octDecode(aNrm.xy));
+    v.uv = aUV + vec2(aQuant0.w, aQuant1.w);
+
+    gl_Position = projection * view * posWS;
+}
@@ -0,0 +1,51 @@
+#version 330 core
+// Szyny wyciągane z ramek bez bufora wierzchołków: gl_VertexID -> (segment, bok, narożnik quada),
+// gl_InstanceID -> szyna (0 lewa, 1 prawa). Bufor tekstury RGBA32F: teksel 0 to
+// (gauge/2, promień, liczba boków, texScaleV), potem po dwa na ramkę: (pos, s), kwaternion (x, y, z, w).
+// Referencja CPU: geometry::extrudeRailVertex.
+uniform samplerBuffer uRailFrames;
+uniform mat4 model, view, projection;
+
+out VS {
+  vec3 posWS;
+  vec3 nWS;
+  vec2 uv;
+} v;
+
+// narożniki quada w kolejności indeksów siatki: (a, b, c), (b, c, d)
+const int kCornerRing[6] = int[6](0, 0, 1, 0, 1, 1);
+const int kCornerSide[6] = int[6](0, 1, 0, 1, 0, 1);
+
+vec3 quatRotate(vec4 q, vec3 p){
+  return p + 2.0 * cross(q.xyz, cross(q.xyz, p) + q.w * p);
+}
+
+void main(){
+  vec4 hdr = texelFetch(uRailFrames, 0);
+  int sides = int(hdr.z);
+  int perSeg = sides * 6;
+  int seg = gl_VertexID / perSeg;
+  int k = gl_VertexID - seg * perSeg;
+  int quad = k / 6;
+  int corner = k - quad * 6;
+  int f = seg + kCornerRing[corner];
+  int side = quad + kCornerSide[corner];
+
+  vec4 posS = texelFetch(uRailFrames, 1 + 2 * f);
+  vec4 q = texelFetch(uRailFrames, 2 + 2 * f);
+  vec3 N = quatRotate(q, vec3(0.0, 1.0, 0.0));
+  vec3 B = quatRotate(q, vec3(0.0, 0.0, 1.0));
+  float u = side == sides ? 1.0 : float(side) / float(sides);
+  float a = 6.28318530718 * u;
+  vec3 circDir = cos(a) * B + sin(a) * N;
+  float railSign = gl_InstanceID == 0 ? 1.0 : -1.0;
+  vec3 pos = posS.xyz + B * (hdr.x * railSign) + circDir * hdr.y;
+
+  vec4 pWS = model * vec4(pos, 1.0);
+  v.posWS = pWS.xyz;
+  // macierz normalnych:
+  v.nWS = mat3(transpose(inverse(model))) * circDir;
+  v.uv = vec2(posS.w * hdr.w, u);
+
+  gl_Position = projection * view * pWS;
+}
@@ -0,0 +1,30 @@
+#version 330 core
+layout(location=0) in vec3 aPos;
+layout(location=1) in vec3 aNormal;
+layout(location=2) in vec2 aUV;
+// przekształcenie instancji (wiersze macierzy 3x4)
+layout(location=3) in vec4 iRow0;
+layout(location=4) in vec4 iRow1;
+layout(location=5) in vec4 iRow2;
+
+uniform mat4 model, view, projection;
+
+out VS {
+  vec3 posWS;
+  vec3 nWS;
+  vec2 uv;
+} v;
+
+void main(){
+  vec4 p = vec4(aPos, 1.0);
+  vec3 pInst = vec3(dot(iRow0, p), dot(iRow1, p), dot(iRow2, p));
+  // szablony mają normalne osiowe/promieniowe - skala instancji nie zmienia ich kierunku
+  vec3 nInst = normalize(vec3(dot(iRow0.xyz, aNormal), dot(iRow1.xyz, aNormal), dot(iRow2.xyz, aNormal)));
+
+  vec4 pWS = model * vec4(pInst, 1.0);
+  v.posWS = pWS.xyz;
+  v.nWS = mat3(transpose(inverse(model))) * nInst;
+  v.uv = aUV;
+
+  gl_Position = projection * view * pWS;
+}
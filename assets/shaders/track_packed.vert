@@ -0,0 +1,36 @@
+#version 330 core
+// format PackedVertex: pozycja unorm16 w ramce kawałka, normalna oktaedryczna, UV half
+layout(location=0) in vec3 aPos;
+layout(location=1) in vec4 aNormal;
+layout(location=2) in vec2 aUV;
+// ramka kwantyzacji kawałka: (origin, uvOrigin.x), (extent, uvOrigin.y)
+layout(location=3) in vec4 aQuant0;
+layout(location=4) in vec4 aQuant1;
+
+uniform mat4 model, view, projection;
+
+out VS {
+  vec3 posWS;
+  vec3 nWS;
+  vec2 uv;
+} v;
+
+vec3 octDecode(vec2 e){
+  vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+  if (n.z < 0.0) {
+    vec2 s = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+    n.xy = (1.0 - abs(n.yx)) * s;
+  }
+  return normalize(n);
+}
+
+void main(){
+  vec3 pos = aQuant0.xyz + aPos * aQuant1.xyz;
+  vec4 pWS = model * vec4(pos,1.0);
+  v.posWS = pWS.xyz;
+  // macierz normalnych:
+  v.nWS = mat3(transpose(inverse(model))) * octDecode(aNormal.xy);
+  v.uv = aUV + vec2(aQuant0.w, aQuant1.w);
+
+  gl_Position = projection * view * pWS;
+}
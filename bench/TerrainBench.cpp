@@ -0,0 +1,99 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// Benchmark generowania terenu bez okna i GL. Dla każdego poziomu SIMD dostępnego na CPU i kolejnych liczb
+// wątków wspólnej puli: Msamples/s (próbki mapy na sekundę) dla fbmRow, fbmRow z gradientem i pełnego
+// Terrain::generate (fBm, normalne, piramida min/max). Najlepszy z kilku przebiegów.
+//
+//   terrain_bench [rozmiar mapy = 1024] [przebiegi = 3]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <span>
+#include <thread>
+#include <vector>
+
+#include "common/ThreadPool.hpp"
+#include "terrain/SimplexNoise.hpp"
+#include "terrain/Terrain.hpp"
+
+namespace {
+    // parametry szumu jak domyślne w aplikacji
+    constexpr int kSeed = 4245221;
+    constexpr float kScale = 0.0010f, kFrequency = 0.02f, kLacunarity = 2.166f, kPersistence = 1.483f;
+    constexpr float kExponent = 1.2f, kHeightScale = 28.0f;
+    constexpr int kOctaves = 10;
+    constexpr float kOffset = 137.0f; // jak Terrain::offset_
+
+    double bestMs(int runs, const std::function<void()>& fn) {
+        double best = 1e300;
+        for (int r = 0; r < runs; r++) {
+            const auto t0 = std::chrono::steady_clock::now();
+            fn();
+            best = std::min(best, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
+        }
+        return best;
+    }
+
+    // wiersze mapy przez fbmRow w pasach puli, jak pierwszy przebieg Terrain::generate
+    void fbmPass(const SimplexNoise& noise, int size, bool withGrad, std::vector<float>& out) {
+        const auto W = static_cast<std::size_t>(size);
+        std::vector<float> xs(W);
+        for (std::size_t x = 0; x < W; x++)
+            xs[x] = static_cast<float>(x) * kScale + kOffset;
+        rc::common::ThreadPool::shared().parallelFor(W, 8, [&](std::size_t y0, std::size_t y1, std::size_t) {
+            std::vector<float> du(withGrad ? W : 0), dv(withGrad ? W : 0);
+            for (std::size_t y = y0; y < y1; y++) {
+                const std::span<float> row(out.data() + y * W, W);
+                const float fy = static_cast<float>(y) * kScale + kOffset;
+                if (withGrad)
+                    noise.fbmRow(xs, fy, row, du, dv, kFrequency, kOctaves, kLacunarity, kPersistence);
+                else
+                    noise.fbmRow(xs, fy, row, kFrequency, kOctaves, kLacunarity, kPersistence);
+            }
+        });
+    }
+} // namespace
+
+int main(int argc, char** argv) {
+    const int size = argc > 1 ? std::max(std::atoi(argv[1]), 2) : 1024;
+    const int runs = argc > 2 ? std::max(std::atoi(argv[2]), 1) : 3;
+    const double samples = static_cast<double>(size) * size;
+    const auto msps = [&](double ms) { return samples / (ms * 1000.0); };
+
+    std::vector<unsigned> threadCounts;
+    const unsigned hw = std::max(std::thread::hardware_concurrency(), 1u);
+    for (unsigned t = 1; t < hw; t *= 2)
+        threadCounts.push_back(t);
+    threadCounts.push_back(hw);
+
+    std::printf("terrain_bench: %d x %d, %d octaves, best of %d runs [Msamples/s]\n", size, size, kOctaves, runs);
+    std::printf("%-8s %7s %10s %12s %10s\n", "simd", "threads", "fbmRow", "fbmRow+grad", "generate");
+
+    const SimplexNoise noise(kSeed);
+    std::vector<float> out(static_cast<std::size_t>(size) * size);
+    Terrain terrain(size, size, kSeed);
+    terrain.setPackedNormals(true);
+    const auto detected = SimplexNoise::simdLevel();
+    for (const auto level: {SimplexNoise::SimdLevel::Scalar, SimplexNoise::SimdLevel::SSE41,
+                            SimplexNoise::SimdLevel::AVX2}) {
+        SimplexNoise::forceSimdLevel(level);
+        if (SimplexNoise::simdLevel() != level)
+            continue; // poziom ponad możliwości CPU
+        for (const unsigned threads: threadCounts) {
+            rc::common::ThreadPool::shared().resize(threads);
+            const double rowMs = bestMs(runs, [&] { fbmPass(noise, size, false, out); });
+            const double gradMs = bestMs(runs, [&] { fbmPass(noise, size, true, out); });
+            const double genMs = bestMs(runs, [&] {
+                terrain.generate(kScale, kFrequency, kOctaves, kLacunarity, kPersistence, kExponent, kHeightScale);
+            });
+            std::printf("%-8s %7u %10.1f %12.1f %10.1f\n", SimplexNoise::simdLevelName(level), threads, msps(rowMs),
+                        msps(gradMs), msps(genMs));
+        }
+    }
+    SimplexNoise::forceSimdLevel(detected);
+    return 0;
+}
@@ -0,0 +1,80 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "AllocStats.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace rc::common {
+    namespace {
+        std::atomic<std::size_t> gAllocs{0}, gFrees{0}, gLive{0}, gPeak{0};
+    } // namespace
+
+    namespace alloc_stats {
+        bool enabled() {
+#ifdef RC_TRACK_ALLOCS
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        AllocCounters snapshot() {
+            return {gAllocs.load(std::memory_order_relaxed), gFrees.load(std::memory_order_relaxed),
+                    gLive.load(std::memory_order_relaxed), gPeak.load(std::memory_order_relaxed)};
+        }
+
+        void resetPeak() {
+            gPeak.store(gLive.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        }
+    } // namespace alloc_stats
+
+#ifdef RC_TRACK_ALLOCS
+    namespace {
+        // rozmiar bloku w nagłówku przed danymi - delete bez rozmiaru też musi go znać
+        constexpr std::size_t kHeader = alignof(std::max_align_t);
+
+        void* countedAlloc(std::size_t n) {
+            auto* base = static_cast<unsigned char*>(std::malloc(n + kHeader));
+            if (!base)
+                return nullptr;
+            *reinterpret_cast<std::size_t*>(base) = n;
+            gAllocs.fetch_add(1, std::memory_order_relaxed);
+            const auto live = gLive.fetch_add(n, std::memory_order_relaxed) + n;
+            auto peak = gPeak.load(std::memory_order_relaxed);
+            while (live > peak && !gPeak.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+            return base + kHeader;
+        }
+
+        void countedFree(void* p) {
+            if (!p)
+                return;
+            auto* base = static_cast<unsigned char*>(p) - kHeader;
+            gFrees.fetch_add(1, std::memory_order_relaxed);
+            gLive.fetch_sub(*reinterpret_cast<std::size_t*>(base), std::memory_order_relaxed);
+            std::free(base);
+        }
+    } // namespace
+#endif
+} // namespace rc::common
+
+#ifdef RC_TRACK_ALLOCS
+// Wersje z wyrównaniem (align_val_t) zostają domyślne - mają własną parę alokacji i nie są liczone.
+void* operator new(std::size_t n) {
+    if (void* p = rc::common::countedAlloc(n ? n : 1))
+        return p;
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t n) { return ::operator new(n); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return rc::common::countedAlloc(n ? n : 1); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return rc::common::countedAlloc(n ? n : 1); }
+void operator delete(void* p) noexcept { rc::common::countedFree(p); }
+void operator delete[](void* p) noexcept { rc::common::countedFree(p); }
+void operator delete(void* p, std::size_t) noexcept { rc::common::countedFree(p); }
+void operator delete[](void* p, std::size_t) noexcept { rc::common::countedFree(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { rc::common::countedFree(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { rc::common::countedFree(p); }
+#endif
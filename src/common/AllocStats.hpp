@@ -0,0 +1,46 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_ALLOCSTATS_HPP
+#define ROLLERCOASTERGL_ALLOCSTATS_HPP
+
+#include <cstddef>
+
+namespace rc::common {
+    // Liczniki globalnego operator new/delete. Działają tylko w buildzie z RC_TRACK_ALLOCS
+    // (opcja CMake) - bez niej enabled() == false i wszystko jest zerem.
+    struct AllocCounters {
+        std::size_t allocations = 0;
+        std::size_t frees = 0;
+        std::size_t liveBytes = 0;
+        std::size_t peakBytes = 0; // szczyt liveBytes od ostatniego resetPeak()
+    };
+
+    namespace alloc_stats {
+        [[nodiscard]] bool enabled();
+        [[nodiscard]] AllocCounters snapshot();
+        // szczyt = bieżące liveBytes
+        void resetPeak();
+    } // namespace alloc_stats
+
+    // Pomiar fragmentu kodu: liczba alokacji i szczyt pamięci ponad stan z początku zakresu.
+    // Szczyt jest globalny - zakresy nie mogą się zagnieżdżać ani nakładać między wątkami.
+    class AllocScope {
+    public:
+        AllocScope() : start_(alloc_stats::snapshot()) { alloc_stats::resetPeak(); }
+
+        [[nodiscard]] std::size_t allocations() const {
+            return alloc_stats::snapshot().allocations - start_.allocations;
+        }
+        [[nodiscard]] std::size_t peakBytes() const {
+            const auto now = alloc_stats::snapshot();
+            return now.peakBytes > start_.liveBytes ? now.peakBytes - start_.liveBytes : 0;
+        }
+
+    private:
+        AllocCounters start_;
+    };
+} // namespace rc::common
+
+#endif // ROLLERCOASTERGL_ALLOCSTATS_HPP
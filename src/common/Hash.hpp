@@ -0,0 +1,44 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_HASH_HPP
+#define ROLLERCOASTERGL_HASH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+
+namespace rc::common {
+    // FNV-1a 64 - skrót zawartości do wykrywania zmian, nie kryptografia
+    class Hasher {
+    public:
+        void bytes(const void* data, std::size_t size) {
+            const auto* p = static_cast<const unsigned char*>(data);
+            for (std::size_t i = 0; i < size; ++i) {
+                h_ ^= p[i];
+                h_ *= 1099511628211ull;
+            }
+        }
+
+        template <typename T>
+        void pod(const T& v) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            bytes(&v, sizeof(T));
+        }
+
+        template <typename T>
+        void span(std::span<const T> v) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            bytes(v.data(), v.size_bytes());
+        }
+
+        [[nodiscard]] std::uint64_t value() const { return h_; }
+
+    private:
+        std::uint64_t h_ = 14695981039346656037ull;
+    };
+} // namespace rc::common
+
+#endif // ROLLERCOASTERGL_HASH_HPP
@@ -0,0 +1,36 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_PROGRESS_HPP
+#define ROLLERCOASTERGL_PROGRESS_HPP
+
+#include <atomic>
+#include <cstddef>
+
+namespace rc::common {
+    // Postęp i przerwanie długiej pracy na innym wątku. Pracujący zgłasza jednostki pracy (addWork) i ich
+    // wykonanie (advance), inny wątek czyta fraction() i ustawia cancel. Praca sprawdza cancelled() między
+    // swoimi porcjami - przerwany wynik nie nadaje się do użycia.
+    struct Progress {
+        std::atomic<std::size_t> done{0};
+        std::atomic<std::size_t> total{0};
+        std::atomic<bool> cancel{false};
+
+        void addWork(std::size_t units) { total.fetch_add(units, std::memory_order_relaxed); }
+        void advance(std::size_t units) { done.fetch_add(units, std::memory_order_relaxed); }
+        [[nodiscard]] bool cancelled() const { return cancel.load(std::memory_order_relaxed); }
+        [[nodiscard]] float fraction() const {
+            const std::size_t t = total.load(std::memory_order_relaxed);
+            const std::size_t d = done.load(std::memory_order_relaxed);
+            return t ? static_cast<float>(d < t ? d : t) / static_cast<float>(t) : 0.0f;
+        }
+        void reset() {
+            done.store(0, std::memory_order_relaxed);
+            total.store(0, std::memory_order_relaxed);
+            cancel.store(false, std::memory_order_relaxed);
+        }
+    };
+} // namespace rc::common
+
+#endif // ROLLERCOASTERGL_PROGRESS_HPP
@@ -0,0 +1,21 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_SIMDTARGET_HPP
+#define ROLLERCOASTERGL_SIMDTARGET_HPP
+
+// Funkcje z intrinsics dla ISA ponad bazową kompilację oznacza się RC_TARGET("avx2") itp. i woła tylko
+// po sprawdzeniu CPU (SimplexNoise::simdLevel). MSVC nie potrzebuje atrybutu - intrinsics są zawsze dostępne.
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define RC_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define RC_TARGET(isa)
+#else
+#define RC_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+#endif // ROLLERCOASTERGL_SIMDTARGET_HPP
@@ -0,0 +1,64 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_SPSCRING_HPP
+#define ROLLERCOASTERGL_SPSCRING_HPP
+
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+namespace rc::common {
+    // Kolejka jeden producent / jeden konsument, stała pojemność (potęga 2), bez blokad.
+    // push() nigdy nie czeka - przy pełnym buforze zwraca false i decyzja należy do producenta.
+    template <typename T>
+    class SpscRing {
+    public:
+        explicit SpscRing(std::size_t capacity) :
+            buf_(std::bit_ceil(capacity < 2 ? std::size_t{2} : capacity)), mask_(buf_.size() - 1) {}
+
+        bool push(const T& v) {
+            const std::size_t head = head_.load(std::memory_order_relaxed);
+            if (head - cachedTail_ > mask_) {
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+                if (head - cachedTail_ > mask_)
+                    return false;
+            }
+            buf_[head & mask_] = v;
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        bool pop(T& out) {
+            const std::size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail == cachedHead_) {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                if (tail == cachedHead_)
+                    return false;
+            }
+            out = buf_[tail & mask_];
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        [[nodiscard]] std::size_t capacity() const {
+            return buf_.size();
+        }
+        // przybliżone, do statystyk
+        [[nodiscard]] std::size_t sizeApprox() const {
+            return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::vector<T> buf_;
+        std::size_t mask_;
+        alignas(64) std::atomic<std::size_t> head_{0}; // pisze producent
+        std::size_t cachedTail_ = 0;                   // kopia producenta
+        alignas(64) std::atomic<std::size_t> tail_{0}; // pisze konsument
+        std::size_t cachedHead_ = 0;                   // kopia konsumenta
+    };
+} // namespace rc::common
+
+#endif // ROLLERCOASTERGL_SPSCRING_HPP
@@ -0,0 +1,106 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace rc::common {
+    ThreadPool::ThreadPool(unsigned threads) {
+        resize(threads);
+    }
+
+    ThreadPool::~ThreadPool() {
+        stopWorkers_();
+    }
+
+    void ThreadPool::stopWorkers_() {
+        {
+            std::lock_guard lk(mutex_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& w: workers_)
+            w.join();
+        workers_.clear();
+        stop_ = false;
+    }
+
+    void ThreadPool::resize(unsigned threads) {
+        const unsigned n = std::max(threads, 1u) - 1u; // wołający jest jednym z wątków
+        if (n == workers_.size())
+            return;
+        stopWorkers_();
+        workers_.reserve(n);
+        for (unsigned i = 0; i < n; ++i)
+            workers_.emplace_back(&ThreadPool::workerLoop_, this);
+    }
+
+    ThreadPool& ThreadPool::shared() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    bool ThreadPool::runOne_(std::unique_lock<std::mutex>& lk, const void* batch) {
+        const auto it = batch ? std::find_if(jobs_.begin(), jobs_.end(), [&](const Job& j) { return j.batch == batch; })
+                              : jobs_.begin();
+        if (it == jobs_.end())
+            return false;
+        auto job = std::move(it->fn);
+        jobs_.erase(it);
+        lk.unlock();
+        job();
+        lk.lock();
+        return true;
+    }
+
+    void ThreadPool::workerLoop_() {
+        std::unique_lock lk(mutex_);
+        for (;;) {
+            cv_.wait(lk, [this] { return stop_ || !jobs_.empty(); });
+            if (stop_ && jobs_.empty())
+                return;
+            runOne_(lk);
+        }
+    }
+
+    std::size_t ThreadPool::chunkCount(std::size_t count, std::size_t minChunk) const {
+        if (count == 0)
+            return 0;
+        const std::size_t byGrain = (count + std::max<std::size_t>(minChunk, 1) - 1) / std::max<std::size_t>(minChunk, 1);
+        return std::clamp<std::size_t>(byGrain, 1, static_cast<std::size_t>(concurrency()) * 4);
+    }
+
+    void ThreadPool::parallelFor(std::size_t count, std::size_t minChunk,
+                                 const std::function<void(std::size_t, std::size_t, std::size_t)>& fn) {
+        const std::size_t chunks = chunkCount(count, minChunk);
+        if (chunks == 0)
+            return;
+        if (chunks == 1 || workers_.empty()) {
+            for (std::size_t c = 0; c < chunks; ++c)
+                fn(count * c / chunks, count * (c + 1) / chunks, c);
+            return;
+        }
+
+        std::size_t pending = chunks;
+        std::unique_lock lk(mutex_);
+        for (std::size_t c = 0; c < chunks; ++c) {
+            auto run = [&, c] {
+                fn(count * c / chunks, count * (c + 1) / chunks, c);
+                std::lock_guard g(mutex_);
+                if (--pending == 0)
+                    done_.notify_all();
+            };
+            jobs_.push_back({std::move(run), &pending});
+        }
+        cv_.notify_all();
+
+        // Pomagaj zamiast czekać, ale tylko przy swoich kawałkach - działa też przy zagnieżdżonym parallelFor
+        // z wątku puli. Gdy wszystkie są już w toku, czekaj na ich koniec.
+        while (pending > 0) {
+            if (!runOne_(lk, &pending))
+                done_.wait(lk, [&] { return pending == 0; });
+        }
+    }
+} // namespace rc::common
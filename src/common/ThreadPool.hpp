@@ -0,0 +1,65 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_THREADPOOL_HPP
+#define ROLLERCOASTERGL_THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace rc::common {
+    class ThreadPool {
+    public:
+        explicit ThreadPool(unsigned threads = std::thread::hardware_concurrency());
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // wspólna pula dla całej aplikacji
+        static ThreadPool& shared();
+
+        // liczba wątków liczących razem z wołającym
+        [[nodiscard]] unsigned concurrency() const {
+            return static_cast<unsigned>(workers_.size()) + 1u;
+        }
+
+        // Nowa liczba wątków (razem z wołającym). Tylko gdy żaden parallelFor nie jest w toku - np. benchmark
+        // między przebiegami; podział na kawałki (chunkCount) zmienia się razem z nią.
+        void resize(unsigned threads);
+
+        // ile kawałków parallelFor utworzy dla count elementów
+        [[nodiscard]] std::size_t chunkCount(std::size_t count, std::size_t minChunk) const;
+
+        // fn(begin, end, chunkIdx) na rozłącznych, kolejnych kawałkach [0, count).
+        // Wołający też liczy (tylko swoje kawałki - długa praca innego wątku w puli go nie zatrzyma);
+        // wraca gdy wszystkie kawałki skończone. Kawałki zależą tylko od count/minChunk i liczby wątków,
+        // więc wynik redukcji po chunkIdx jest powtarzalny.
+        void parallelFor(std::size_t count, std::size_t minChunk,
+                         const std::function<void(std::size_t, std::size_t, std::size_t)>& fn);
+
+    private:
+        struct Job {
+            std::function<void()> fn;
+            const void* batch; // parallelFor, z którego pochodzi
+        };
+        void workerLoop_();
+        void stopWorkers_();
+        // batch == nullptr - dowolne zadanie (wątki puli), inaczej tylko z tego parallelFor
+        bool runOne_(std::unique_lock<std::mutex>& lk, const void* batch = nullptr);
+
+        std::vector<std::thread> workers_;
+        std::deque<Job> jobs_;
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::condition_variable done_;
+        bool stop_ = false;
+    };
+} // namespace rc::common
+
+#endif // ROLLERCOASTERGL_THREADPOOL_HPP
@@ -0,0 +1,53 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_TRIPLEBUFFER_HPP
+#define ROLLERCOASTERGL_TRIPLEBUFFER_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+namespace rc::common {
+    // Jeden producent, jeden konsument, bez blokad.
+    // Producent pisze do writeBuffer() i woła publish(); konsument woła update() i czyta read().
+    // Trzeci bufor ("middle") krąży między nimi przez atomową wymianę indeksu.
+    template <typename T>
+    class TripleBuffer {
+    public:
+        T& writeBuffer() {
+            return buf_[back_];
+        }
+
+        void publish() {
+            const std::uint8_t prev = middle_.exchange(static_cast<std::uint8_t>(back_ | kDirty),
+                                                       std::memory_order_acq_rel);
+            back_ = prev & kIndexMask;
+        }
+
+        // true jeśli od ostatniego wywołania pojawiła się nowa wartość
+        bool update() {
+            if (!(middle_.load(std::memory_order_relaxed) & kDirty))
+                return false;
+            const std::uint8_t prev = middle_.exchange(front_, std::memory_order_acq_rel);
+            front_ = prev & kIndexMask;
+            return true;
+        }
+
+        [[nodiscard]] const T& read() const {
+            return buf_[front_];
+        }
+
+    private:
+        static constexpr std::uint8_t kDirty = 0x4;
+        static constexpr std::uint8_t kIndexMask = 0x3;
+
+        std::array<T, 3> buf_{};
+        std::atomic<std::uint8_t> middle_{1};
+        std::uint8_t back_ = 0;  // tylko producent
+        std::uint8_t front_ = 2; // tylko konsument
+    };
+} // namespace rc::common
+
+#endif // ROLLERCOASTERGL_TRIPLEBUFFER_HPP
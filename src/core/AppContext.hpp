@@ -5,8 +5,12 @@
 #ifndef APPCONTEXT_HPP
 #define APPCONTEXT_HPP
 
+#include <optional>
+
 #include "../camera/FreeFlyCam.hpp"
+#include "../terrain/NoiseLayerCache.hpp"
 #include "../terrain/Terrain.hpp"
+#include "../terrain/TerrainJob.hpp"
 
 enum class CamMode { Free, Ride, Chase };
 
@@ -29,13 +33,24 @@ struct ProjectConfig {
 struct AppContext {
 
     FreeFlyCam camera;
+    NoiseLayerCache noiseCache; // warstwy oktaw między kolejnymi generate (przed terrain - żyje dłużej)
     Terrain terrain;
+    // nowy teren z wątku w tle w trakcie uploadu po kawałku; do podmiany rysowany jest terrain
+    std::optional<Terrain> pendingTerrain;
+    TerrainJob terrainJob; // po noiseCache - kończy pracę, zanim zniknie cache
+    float terrainUploadMs = 4.0f; // budżet uploadu nowego terenu na klatkę
     bool keys[1024]{false};
     float lastFrame = 0.0f, currentFrame = 0.0f, deltaTime = 0.0f;
     int polygonMode = GL_FILL;
     bool cursorLocked = true;
 
     bool showTerrainPanel = false;
+    bool packedVertices = false; // 16 B wierzchołki toru i terenu
+    bool railExtrusion = false;  // szyny z ramek w shaderze zamiast siatki
+    bool meshletCulling = true;  // odrzucanie meshletów toru i terenu na CPU
+    bool chunkedTerrain = false; // teren w łatach quadtree LOD zamiast jednej siatki
+    bool terrainNormals = true;  // analityczne normalne terenu (4 B/wierzchołek) zamiast różnic wysokości
+    bool terrainLiveUpdate = false; // generate po każdej zmianie suwaka szumu
 
     CamMode camMode = CamMode::Free;
     glm::vec3 smoothedEye{0};
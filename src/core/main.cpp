@@ -1,6 +1,9 @@
 #define GLFW_INCLUDE_NONE
 
 #include <GLFW/glfw3.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <glad.h>
 #include <glm/glm.hpp>
@@ -8,12 +11,19 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <glm/gtx/norm.hpp>
 #include <iostream>
+#include <optional>
 #include <sstream>
 #include <string>
 
 #include "AppContext.hpp"
 #include "camera/FreeFlyCam.hpp"
+#include "common/AllocStats.hpp"
+#include "gameplay/BlockDispatcher.hpp"
 #include "gameplay/Car.hpp"
+#include "gameplay/RideAnalysis.hpp"
+#include "gameplay/SimRecording.hpp"
+#include "gameplay/SimulationThread.hpp"
+#include "gameplay/Telemetry.hpp"
 #include "gameplay/TrackComponent.hpp"
 #include "gfx/geometry/RailGeometryBuilder.hpp"
 #include "gfx/render/Texture.hpp"
@@ -21,6 +31,8 @@
 #include "imgui.h"
 #include "imgui_impl_glfw.h"
 #include "imgui_impl_opengl3.h"
+#include "math/Frustum.hpp"
+#include "terrain/SaveHeightmap.hpp"
 #include "terrain/Terrain.hpp"
 
 ProjectConfig cfg{.windowWidth = 1920,
@@ -124,7 +136,97 @@ void mouseCallback(GLFWwindow* window, double xpos, double ypos) {
         ctx->camera.processMouse(xoffset, yoffset);
 }
 
-int main() {
+// nowy teren (bez GL) z opcjami z panelu; kształt daje potem generate albo setHeights w TerrainJob
+Terrain makeTerrain(AppContext& context, int width, int height, int seed) {
+    Terrain terrain(width, height, seed);
+    terrain.setLayerCache(&context.noiseCache);
+    terrain.setPackedVertices(context.packedVertices);
+    terrain.setChunkedLod(context.chunkedTerrain);
+    terrain.setPackedNormals(context.terrainNormals);
+    terrain.setLodRange(context.terrain.lodRange());
+    return terrain;
+}
+
+void buildDemoTrack(rc::gameplay::TrackComponent& trackComp) {
+    auto& spl = trackComp.spline();
+    spl.addNode({{110.f, 22.f, 29.f}});
+    spl.addNode({{62.f, 18.f, 20.f}});
+    spl.addNode({{56.f, 18.f, 21.f}});
+    spl.addNode({{38.f, 18.f, 31.f}});
+    spl.addNode({{43.f, 18.f, 45.f}});
+    spl.addNode({{45.f, 20.f, 50.f}});
+
+    spl.addNode({{88.f, 12.f, 55.f}});
+    spl.addNode({{108.f, 14.f, 50.f}});
+    spl.addNode({{132.f, 16.f, 47.f}});
+    spl.addNode({{157.f, 22.f, 47.f}});
+    spl.addNode({{176.f, 38.f, 49.f}});
+
+
+    /*s.addNode({{166.f, 24.f, 40.f}});
+    s.addNode({{170.f, 32.f, 40.f}});
+    s.addNode({{178.f, 39.f, 43.f}});
+    s.addNode({{191.f, 49.f, 50.f}});*/
+
+    spl.addNode({{196.f, 58.f, 53.f}});
+    spl.addNode({{209.f, 65.f, 67.f}});
+    spl.addNode({{224.f, 70.f, 90.f}});
+    spl.addNode({{224.f, 70.f, 93.f}});
+    spl.addNode({{224.f, 63.f, 103.f}});
+    spl.addNode({{220.f, 51.f, 112.f}});
+    spl.addNode({{215.f, 29.f, 120.f}});
+    spl.addNode({{206.f, 35.f, 121.f}});
+    spl.addNode({{196.f, 39.f, 101.f}});
+    spl.addNode({{199.f, 35.f, 95.f}});
+    spl.addNode({{202.f, 29.f, 92.f}});
+    spl.addNode({{232.f, 11.f, 87.f}});
+    spl.addNode({{239.f, 15.f, 82.f}});
+    spl.addNode({{236.f, 21.f, 62.f}});
+    spl.addNode({{218.f, 24.f, 41.f}});
+    spl.addNode({{182.f, 85.f, 37.f}});
+    spl.addNode({{164.f, 85.f, 35.f}});
+    spl.addNode({{157.f, 72.f, 34.f}});
+    spl.addNode({{147.f, 29.f, 33.f}});
+    spl.addNode({{137.f, 34.f, 32.f}});
+
+    trackComp.setClosed(true);
+    trackComp.setDs(0.05f);
+    trackComp.setUp({0.f, 1.f, 0.f});
+    trackComp.markDirty();
+    trackComp.rebuild();
+}
+
+// tryb bez okna: RollerCoasterGL --capacity [pociągi] [godziny]
+int runCapacityReport(int trains, double hours) {
+    rc::gameplay::TrackComponent trackComp;
+    buildDemoTrack(trackComp);
+    trackComp.setStation(0, 30.f);
+    trackComp.rebuild();
+
+    rc::gameplay::DispatchParams params;
+    rc::gameplay::BlockDispatcher dispatcher(trackComp, params);
+    if (!dispatcher.init(trains))
+        return -1;
+    dispatcher.run(hours * 3600.0);
+
+    const auto& st = dispatcher.stats();
+    std::cout << "Track length:    " << trackComp.totalLength() << " m, " << dispatcher.blocks().size() << " blocks\n"
+              << "Trains:          " << trains << " x " << params.seatsPerTrain << " seats\n"
+              << "Simulated:       " << st.simTime / 3600.0 << " h\n"
+              << "Dispatches:      " << st.dispatches << " (" << st.trainsPerHour() << " trains/h)\n"
+              << "Block holds:     " << st.holds << "\n"
+              << "Dispatch ticks:  " << st.ticksWithEvents << " / " << st.ticks << "\n"
+              << "Capacity:        " << dispatcher.hourlyCapacity() << " riders/h" << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--capacity") {
+        const int trains = (argc > 2) ? std::atoi(argv[2]) : 2;
+        const double hours = (argc > 3) ? std::atof(argv[3]) : 1.0;
+        return runCapacityReport(trains, hours);
+    }
+
     glfwSetErrorCallback(glfwErrorCallback);
     if (!glfwInit()) {
         std::cerr << "Failed to initialize GLFW!" << std::endl;
@@ -168,8 +270,12 @@ int main() {
 
     std::string terrainVerSrc = loadShaderSource("assets/shaders/terrain.vert");
     std::string terrainFragSrc = loadShaderSource("assets/shaders/terrain.frag");
+    std::string terrainPackedVerSrc = loadShaderSource("assets/shaders/terrain_packed.vert");
     std::string trackVerSrc = loadShaderSource("assets/shaders/track.vert");
     std::string trackFragSrc = loadShaderSource("assets/shaders/track.frag");
+    std::string trackInstVerSrc = loadShaderSource("assets/shaders/track_inst.vert");
+    std::string trackPackedVerSrc = loadShaderSource("assets/shaders/track_packed.vert");
+    std::string trackExtrudeVerSrc = loadShaderSource("assets/shaders/track_extrude.vert");
     std::string skyVerSrc   = loadShaderSource("assets/shaders/skybox.vert");
     std::string skyFragSrc  = loadShaderSource("assets/shaders/skybox.frag");
 
@@ -182,16 +288,27 @@ int main() {
 
     GLuint terrainProgram = createShaderProgram(terrainVerSrc, terrainFragSrc);
     GLuint trackProgram   = createShaderProgram(trackVerSrc, trackFragSrc);
+    GLuint trackInstProgram = createShaderProgram(trackInstVerSrc, trackFragSrc); // poprzeczki/słupy
+    // warianty dla PackedVertex (te same fragment shadery)
+    GLuint terrainPackedProgram = createShaderProgram(terrainPackedVerSrc, terrainFragSrc);
+    GLuint trackPackedProgram   = createShaderProgram(trackPackedVerSrc, trackFragSrc);
+    GLuint trackExtrudeProgram  = createShaderProgram(trackExtrudeVerSrc, trackFragSrc); // szyny z ramek
     GLuint skyProgram     = createShaderProgram(skyVerSrc, skyFragSrc);
 
-    glUseProgram(terrainProgram);
-    glUniform1i(glGetUniformLocation(terrainProgram, "texAlbedo"), 0);
-    glUniform1i(glGetUniformLocation(terrainProgram, "texSpec"), 1);
-    glUniform1i(glGetUniformLocation(terrainProgram, "texNormal"), 2);
+    for (GLuint prog : {terrainProgram, terrainPackedProgram}) {
+        glUseProgram(prog);
+        glUniform1i(glGetUniformLocation(prog, "texAlbedo"), 0);
+        glUniform1i(glGetUniformLocation(prog, "texSpec"), 1);
+        glUniform1i(glGetUniformLocation(prog, "texNormal"), 2);
+    }
 
-    glUseProgram(trackProgram);
-    glUniform1i(glGetUniformLocation(trackProgram, "texAlbedo"), 0);
-    glUniform1i(glGetUniformLocation(trackProgram, "texSpec"), 1);
+    for (GLuint prog : {trackProgram, trackInstProgram, trackPackedProgram, trackExtrudeProgram}) {
+        glUseProgram(prog);
+        glUniform1i(glGetUniformLocation(prog, "texAlbedo"), 0);
+        glUniform1i(glGetUniformLocation(prog, "texSpec"), 1);
+    }
+    glUseProgram(trackExtrudeProgram);
+    glUniform1i(glGetUniformLocation(trackExtrudeProgram, "uRailFrames"), rc::gfx::render::RailStream::kTextureUnit);
 
     // VAO nieba
     GLuint skyVAO=0, skyVBO=0;
@@ -229,6 +346,20 @@ int main() {
 //------------------------------------------------------------------------------------------------
 //----------------------------------------TRAKC-----------------------------------------------------
 
+    // --heightmap <plik>: wysokości z pliku (.rchm bez kopii, PGM/PFM/raw16) zamiast generowania z szumu
+    std::optional<Array_2D<float>> startHeights;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (std::string(argv[i]) != "--heightmap")
+            continue;
+        try {
+            startHeights = loadHeightmap(argv[i + 1]);
+            cfg.mapWidth = startHeights->width();
+            cfg.mapHeight = startHeights->height();
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << " - generating terrain from noise" << std::endl;
+        }
+    }
+
     AppContext context(cfg);
     // patrz na środek
     context.camera.lookAtTarget(glm::vec3(static_cast<float>(cfg.mapWidth) * 0.5f, context.camera.position.y, static_cast<float>(cfg.mapHeight) * 0.5f));
@@ -236,63 +367,20 @@ int main() {
     glfwSetKeyCallback(window, keyCallback);
     glfwSetCursorPosCallback(window, mouseCallback);
 
-    context.terrain.generate(cfg.noiseScale, cfg.noiseFreq, cfg.noiseOctaves, cfg.noiseLacunarity, cfg.noisePersistence,
-                             cfg.noiseExponent, cfg.noiseHeightScale);
+    context.terrain.setLayerCache(&context.noiseCache);
+    if (startHeights)
+        context.terrain.setHeights(std::move(*startHeights));
+    else
+        context.terrain.generate(cfg.noiseScale, cfg.noiseFreq, cfg.noiseOctaves, cfg.noiseLacunarity,
+                                 cfg.noisePersistence, cfg.noiseExponent, cfg.noiseHeightScale);
+    startHeights.reset();
     context.terrain.uploadToGPU();
 
     std::cout << "MaxHeight = " << context.terrain.maxH() << std::endl;
     std::cout << "MinHeight = " << context.terrain.minH() << std::endl;
 
     rc::gameplay::TrackComponent trackComp;
-    auto& spl = trackComp.spline();
-    spl.addNode({{110.f, 22.f, 29.f}});
-    spl.addNode({{62.f, 18.f, 20.f}});
-    spl.addNode({{56.f, 18.f, 21.f}});
-    spl.addNode({{38.f, 18.f, 31.f}});
-    spl.addNode({{43.f, 18.f, 45.f}});
-    spl.addNode({{45.f, 20.f, 50.f}});
-
-    spl.addNode({{88.f, 12.f, 55.f}});
-    spl.addNode({{108.f, 14.f, 50.f}});
-    spl.addNode({{132.f, 16.f, 47.f}});
-    spl.addNode({{157.f, 22.f, 47.f}});
-    spl.addNode({{176.f, 38.f, 49.f}});
-
-
-    /*s.addNode({{166.f, 24.f, 40.f}});
-    s.addNode({{170.f, 32.f, 40.f}});
-    s.addNode({{178.f, 39.f, 43.f}});
-    s.addNode({{191.f, 49.f, 50.f}});*/
-
-    spl.addNode({{196.f, 58.f, 53.f}});
-    spl.addNode({{209.f, 65.f, 67.f}});
-    spl.addNode({{224.f, 70.f, 90.f}});
-    spl.addNode({{224.f, 70.f, 93.f}});
-    spl.addNode({{224.f, 63.f, 103.f}});
-    spl.addNode({{220.f, 51.f, 112.f}});
-    spl.addNode({{215.f, 29.f, 120.f}});
-    spl.addNode({{206.f, 35.f, 121.f}});
-    spl.addNode({{196.f, 39.f, 101.f}});
-    spl.addNode({{199.f, 35.f, 95.f}});
-    spl.addNode({{202.f, 29.f, 92.f}});
-    spl.addNode({{232.f, 11.f, 87.f}});
-    spl.addNode({{239.f, 15.f, 82.f}});
-    spl.addNode({{236.f, 21.f, 62.f}});
-    spl.addNode({{218.f, 24.f, 41.f}});
-    spl.addNode({{182.f, 85.f, 37.f}});
-    spl.addNode({{164.f, 85.f, 35.f}});
-    spl.addNode({{157.f, 72.f, 34.f}});
-    spl.addNode({{147.f, 29.f, 33.f}});
-    spl.addNode({{137.f, 34.f, 32.f}});
-
-
-
-
-    trackComp.setClosed(true);
-    trackComp.setDs(0.05f);
-    trackComp.setUp({0.f, 1.f, 0.f});
-    trackComp.markDirty();
-    trackComp.rebuild();
+    buildDemoTrack(trackComp);
     const auto& frames = trackComp.frames();
 
 
@@ -314,6 +402,37 @@ int main() {
     rc::gameplay::Car car;
     car.bindTrack(trackComp);
     car.kick(100.f);
+
+    // fizyka na własnym wątku; edycje toru i wagonika idą pod sim.lock()
+    rc::gameplay::SimulationThread sim(car, trackComp);
+    sim.start();
+    rc::gameplay::SimRecorder recorder;
+    rc::gameplay::SimReplay replay;
+    const std::string recordingPath = "ride_recording.rcr";
+    rc::gameplay::Telemetry telemetry;
+    rc::gameplay::TelemetryConfig telemetryCfg;
+
+    // jeden hook podkroku składany z aktywnych odbiorców; wołać pod sim.lock()
+    auto setSubstepHook = [&](bool rec, bool tel) {
+        if (!rec && !tel) {
+            car.onSubstep = nullptr;
+            return;
+        }
+        car.onSubstep = [&recorder, &telemetry, rec, tel](const rc::gameplay::CarSubstep& st) {
+            if (rec) recorder.record(0, st);
+            if (tel) telemetry.push(st);
+        };
+    };
+
+    auto rebuildTrack = [&]() {
+        {
+            auto simLock = sim.lock();
+            trackComp.rebuild();
+            car.onTrackRebuilt(trackComp);
+        }
+        // siatka z ramek już poza lockiem - symulacja tylko czyta ramki
+        track.build(trackComp.frames(), railP, context.terrain, infraP);
+    };
     GLuint carShader = createShaderProgram(
         loadShaderSource("assets/shaders/car.vert"),
         loadShaderSource("assets/shaders/car.frag")
@@ -382,6 +501,22 @@ int main() {
         if (context.deltaTime >= 0.05f) context.deltaTime = 0.05f;
         context.lastFrame = context.currentFrame;
 
+        // Teren z wątku w tle: upload po kawałku w kolejnych klatkach (budżet terrainUploadMs), podmiana
+        // dopiero po ostatnim - do tego czasu rysuje się poprzedni.
+        if (auto ready = context.terrainJob.take()) {
+            if (context.pendingTerrain)
+                context.pendingTerrain->releaseGL();
+            context.pendingTerrain = std::move(ready);
+            context.pendingTerrain->beginUpload();
+        }
+        if (context.pendingTerrain && context.pendingTerrain->uploadStep(context.terrainUploadMs)) {
+            context.terrain.releaseGL();
+            context.terrain = std::move(*context.pendingTerrain);
+            context.pendingTerrain.reset();
+            cfg.mapWidth = context.terrain.heightmap().width();
+            cfg.mapHeight = context.terrain.heightmap().height();
+        }
+
         static bool prevF1 = false, prevF2 = false;
         bool f1 = context.keys[GLFW_KEY_F1];
         bool f2 = context.keys[GLFW_KEY_F2];
@@ -425,18 +560,101 @@ int main() {
         if (context.showTerrainPanel) {
             ImGui::Begin("Panel terenu", &context.showTerrainPanel);
             ImGui::Text("Parametry szumu i terenu");
-            ImGui::SliderFloat("Height", &cfg.noiseHeightScale, 1.0f, 200.0f);
-            ImGui::SliderFloat("Scale", &cfg.noiseScale, 0.0001f, 0.1f, "%.4f");
-            ImGui::SliderInt("Octaves", &cfg.noiseOctaves, 1, 12);
-            ImGui::SliderFloat("Lacunarity", &cfg.noiseLacunarity, 1.0f, 4.0f);
-            ImGui::SliderFloat("Persistence", &cfg.noisePersistence, 0.1f, 2.0f);
+            // Height / Exponent / Persistence / kolejna oktawa składają mapę z warstw w noiseCache
+            bool noiseChanged = ImGui::SliderFloat("Height", &cfg.noiseHeightScale, 1.0f, 200.0f);
+            noiseChanged |= ImGui::SliderFloat("Exponent", &cfg.noiseExponent, 0.2f, 4.0f);
+            noiseChanged |= ImGui::SliderFloat("Scale", &cfg.noiseScale, 0.0001f, 0.1f, "%.4f");
+            noiseChanged |= ImGui::SliderInt("Octaves", &cfg.noiseOctaves, 1, 12);
+            noiseChanged |= ImGui::SliderFloat("Lacunarity", &cfg.noiseLacunarity, 1.0f, 4.0f);
+            noiseChanged |= ImGui::SliderFloat("Persistence", &cfg.noisePersistence, 0.1f, 2.0f);
+            ImGui::Checkbox("Live update", &context.terrainLiveUpdate);
             ImGui::InputInt("Seed", &cfg.noiseSeed);
-            if (ImGui::Button("Generate Terrain")) {
-                context.terrain.releaseGL();
-                context.terrain = Terrain(cfg.mapWidth, cfg.mapHeight, cfg.noiseSeed);
-                context.terrain.generate(cfg.noiseScale, cfg.noiseFreq, cfg.noiseOctaves, cfg.noiseLacunarity,
-                                         cfg.noisePersistence, cfg.noiseExponent, cfg.noiseHeightScale);
-                context.terrain.uploadToGPU();
+            ImGui::InputInt("Map width", &cfg.mapWidth);
+            ImGui::InputInt("Map height", &cfg.mapHeight);
+            cfg.mapWidth = std::clamp(cfg.mapWidth, 2, 16385);
+            cfg.mapHeight = std::clamp(cfg.mapHeight, 2, 16385);
+            // przełączenie trybu wymaga nowego generate (w trybie łat teren nie ma siatki w całości)
+            const bool chunkedChanged = ImGui::Checkbox("Chunked LOD (quadtree)", &context.chunkedTerrain);
+            const bool normalsChanged = ImGui::Checkbox("Packed normals (4 B/vertex)", &context.terrainNormals);
+            if (ImGui::Button("Generate Terrain") || chunkedChanged || normalsChanged ||
+                (noiseChanged && context.terrainLiveUpdate)) {
+                // w tle - do podmiany rysuje się obecny teren; kolejny start przerywa poprzedni
+                context.terrainJob.start(makeTerrain(context, cfg.mapWidth, cfg.mapHeight, cfg.noiseSeed),
+                                         [c = cfg](Terrain& t) {
+                                             t.generate(c.noiseScale, c.noiseFreq, c.noiseOctaves, c.noiseLacunarity,
+                                                        c.noisePersistence, c.noiseExponent, c.noiseHeightScale);
+                                         });
+            }
+            if (context.terrainJob.running()) {
+                ImGui::ProgressBar(context.terrainJob.progress(), ImVec2(-80.0f, 0.0f), "generating");
+                ImGui::SameLine();
+                if (ImGui::Button("Cancel"))
+                    context.terrainJob.cancel();
+            } else if (context.pendingTerrain) {
+                ImGui::ProgressBar(context.pendingTerrain->uploadProgress(), ImVec2(-80.0f, 0.0f), "uploading");
+            }
+            if (!context.terrainJob.running() && !context.terrainJob.error().empty())
+                ImGui::TextUnformatted(context.terrainJob.error().c_str());
+            ImGui::SliderFloat("Upload budget (ms/frame)", &context.terrainUploadMs, 0.5f, 16.0f, "%.1f");
+            {
+                const auto& gs = context.terrain.lastGenerate();
+                ImGui::Text("Generate: noise %.1f ms (%.1f Msamples/s, %u threads, %s), heights %.1f ms, "
+                            "upload %.1f ms in %d frames",
+                            gs.noiseMs, gs.megasamplesPerSec, gs.threads, gs.simd, gs.meshMs, gs.uploadMs,
+                            gs.uploadSteps);
+                ImGui::Text("Octave layers: %d computed, %d reused (cache %zu layers, %.1f / %.0f MB)",
+                            gs.layersComputed, gs.layersReused, context.noiseCache.size(),
+                            static_cast<double>(context.noiseCache.bytes()) / (1024.0 * 1024.0),
+                            static_cast<double>(context.noiseCache.budget()) / (1024.0 * 1024.0));
+                ImGui::Text("Memory: CPU %.1f MB, GPU %.1f MB%s",
+                            static_cast<double>(context.terrain.cpuBytes()) / (1024.0 * 1024.0),
+                            static_cast<double>(context.terrain.gpuBytes()) / (1024.0 * 1024.0),
+                            context.terrain.heightmap().isView() ? " (heights mapped from file)" : "");
+            }
+            {
+                // plik wysokości: format zapisu z listy, wczytanie po sygnaturze (raw16 - kwadrat, zakres 0..Height)
+                static char heightmapPath[256] = "terrain.rchm";
+                static int exportFormat = 0;
+                static std::string heightmapStatus;
+                ImGui::InputText("Heightmap file", heightmapPath, sizeof(heightmapPath));
+                ImGui::Combo("Format", &exportFormat, "RCHM (float, tiled)\0PFM (float)\0PGM P5 (16-bit)\0RAW (16-bit)\0");
+                if (ImGui::Button("Export heightmap")) {
+                    const auto t0 = std::chrono::steady_clock::now();
+                    try {
+                        const auto& hm = context.terrain.heightmap();
+                        switch (exportFormat) {
+                            case 0: saveTiled(hm, heightmapPath); break;
+                            case 1: savePFM(hm, heightmapPath); break;
+                            case 2: savePGM(hm, heightmapPath); break;
+                            default: saveRaw16(hm, heightmapPath, heightRangeOf(hm)); break;
+                        }
+                        heightmapStatus = "saved in " + std::to_string(static_cast<int>(
+                                std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count())) + " ms";
+                    } catch (const std::exception& e) {
+                        heightmapStatus = e.what();
+                    }
+                }
+                ImGui::SameLine();
+                if (ImGui::Button("Import heightmap")) {
+                    // w tle jak generate; wymiary z pliku, zakres raw16 i PGM bez komentarza - 0..Height
+                    context.terrainJob.start(makeTerrain(context, 2, 2, cfg.noiseSeed),
+                                             [path = std::string(heightmapPath),
+                                              range = HeightRange{0.0f, cfg.noiseHeightScale}](Terrain& t) {
+                                                 t.setHeights(loadHeightmap(path, range));
+                                             });
+                    heightmapStatus.clear();
+                }
+                if (!heightmapStatus.empty())
+                    ImGui::TextUnformatted(heightmapStatus.c_str());
+            }
+            if (context.terrain.chunkedLod()) {
+                float lodRange = context.terrain.lodRange();
+                if (ImGui::SliderFloat("LOD range", &lodRange, TerrainQuadtree::kMinLodRange, 4.0f))
+                    context.terrain.setLodRange(lodRange);
+                const auto& ls = context.terrain.lastLod();
+                ImGui::Text("LOD: %zu patches (%zu culled subtrees), %zu resident, %zu uploaded, %zu dropped, %.2fM tris",
+                            ls.nodes, ls.culled, ls.resident, ls.uploaded, ls.dropped,
+                            static_cast<double>(ls.triangles) / 1e6);
             }
 
             ImGui::End();
@@ -444,11 +662,12 @@ int main() {
 
         // --- scena
         glm::vec3 upWS{0,1,0};
+        const rc::gameplay::CarPose carPose = sim.interpolatedPose();
 
         auto makeCarCamera = [&](CamMode mode, float dt) -> glm::mat4 {
             constexpr glm::vec3 UP_LOCAL = glm::vec3(0,1,0);
-            const glm::quat q = car.getOrientation();
-            const glm::vec3 pp = car.getPos();
+            const glm::quat q = carPose.q;
+            const glm::vec3 pp = carPose.pos;
             upWS = glm::normalize(q * UP_LOCAL);
 
             glm::vec3 eye, target;
@@ -480,8 +699,10 @@ int main() {
         glm::mat4 view;
         glm::vec3 camPosWorld;
         if (context.camMode == CamMode::Free) {
-            if (!io.WantCaptureKeyboard)
+            if (!io.WantCaptureKeyboard) {
+                auto simLock = sim.lock();
                 context.camera.processKeyboard(context.keys, context.deltaTime, &car);
+            }
             view = context.camera.getViewMatrix();
             camPosWorld = context.camera.position;
         } else {
@@ -489,11 +710,41 @@ int main() {
             camPosWorld = context.smoothedEye;
         }
 
+        // punkt terenu pod kursorem (kursor wolny, nie nad oknem ImGui) - promień z odwrotności projection * view
+        bool terrainHover = false;
+        glm::vec3 terrainPick(0.0f);
+        if (!context.cursorLocked && !io.WantCaptureMouse) {
+            double mx = 0.0, my = 0.0;
+            int ww = 0, wh = 0;
+            glfwGetCursorPos(window, &mx, &my);
+            glfwGetWindowSize(window, &ww, &wh);
+            if (ww > 0 && wh > 0) {
+                const glm::vec2 ndc(2.0f * static_cast<float>(mx) / static_cast<float>(ww) - 1.0f,
+                                    1.0f - 2.0f * static_cast<float>(my) / static_cast<float>(wh));
+                const glm::mat4 invViewProj = glm::inverse(projection * view);
+                glm::vec4 nearP = invViewProj * glm::vec4(ndc.x, ndc.y, -1.0f, 1.0f);
+                glm::vec4 farP = invViewProj * glm::vec4(ndc.x, ndc.y, 1.0f, 1.0f);
+                nearP /= nearP.w;
+                farP /= farP.w;
+                const glm::vec3 rayDir = glm::vec3(farP) - glm::vec3(nearP);
+                float tHit = 0.0f;
+                if (context.terrain.raycast(glm::vec3(nearP), rayDir, 1.0f, tHit)) {
+                    terrainHover = true;
+                    terrainPick = glm::vec3(nearP) + rayDir * tHit;
+                }
+            }
+        }
+        static bool prevLmb = false;
+        const bool lmb = glfwGetMouseButton(window, GLFW_MOUSE_BUTTON_LEFT) == GLFW_PRESS;
+        const bool terrainClicked = terrainHover && lmb && !prevLmb;
+        prevLmb = lmb;
+
         // Toggle min-speed
         {
             static bool prevM = false;
             bool curM = context.keys[GLFW_KEY_M];
             if (curM && !prevM && !io.WantCaptureKeyboard) {
+                auto simLock = sim.lock();
                 car.minSpeedEnabled = !car.minSpeedEnabled;
                 if (car.minSpeedEnabled && car.minSpeed < 1.0f) car.minSpeed = 20.0f;
             }
@@ -503,15 +754,147 @@ int main() {
         // Car
         {
             ImGui::Begin("Car Controls");
-            ImGui::Text("Speed: %.1f m/s", car.v);
-            ImGui::Checkbox("Min speed enabled", &car.minSpeedEnabled);
-            ImGui::SliderFloat("Min speed (m/s)", &car.minSpeed, 0.0f, 100.0f, "%.1f");
+            ImGui::Text("Speed: %.1f m/s", carPose.v);
+            {
+                auto simLock = sim.lock();
+                ImGui::Checkbox("Min speed enabled", &car.minSpeedEnabled);
+                ImGui::SliderFloat("Min speed (m/s)", &car.minSpeed, 0.0f, 100.0f, "%.1f");
+            }
+            float simScale = sim.timeScale();
+            if (ImGui::SliderFloat("Sim speed (x)", &simScale, 0.0f, 16.0f, "%.2f"))
+                sim.setTimeScale(simScale);
+            ImGui::Text("Sim time: %.1f s", carPose.simTime);
+
+            // nagrywanie stanu po każdym podkroku i odtwarzanie zamiast fizyki
+            ImGui::Separator();
+            if (!recorder.isOpen()) {
+                if (!sim.replaying() && ImGui::Button("Record") && recorder.open(recordingPath)) {
+                    auto simLock = sim.lock();
+                    setSubstepHook(true, telemetry.running());
+                }
+            } else {
+                if (ImGui::Button("Stop recording")) {
+                    {
+                        auto simLock = sim.lock();
+                        setSubstepHook(false, telemetry.running());
+                    }
+                    recorder.close();
+                }
+                ImGui::SameLine();
+                ImGui::Text("%llu steps, %llu dropped", static_cast<unsigned long long>(recorder.written()),
+                            static_cast<unsigned long long>(recorder.dropped()));
+            }
+            // telemetria 240 Hz: pliki kawałkami + CSV po TCP na 127.0.0.1
+            ImGui::Text("Physics: %.3f us/step", sim.stepMicros());
+            if (!telemetry.running()) {
+                static bool binary = false;
+                ImGui::Checkbox("Binary files", &binary);
+                ImGui::SameLine();
+                ImGui::Checkbox("Publish TCP", &telemetryCfg.publish);
+                telemetryCfg.format = binary ? rc::gameplay::TelemetryFormat::Binary : rc::gameplay::TelemetryFormat::Csv;
+                if (ImGui::Button("Start telemetry") && telemetry.start(telemetryCfg)) {
+                    auto simLock = sim.lock();
+                    setSubstepHook(recorder.isOpen(), true);
+                }
+            } else {
+                if (ImGui::Button("Stop telemetry")) {
+                    {
+                        auto simLock = sim.lock();
+                        setSubstepHook(recorder.isOpen(), false);
+                    }
+                    telemetry.stop();
+                }
+                ImGui::SameLine();
+                ImGui::Text("%llu samples, %llu dropped, %zu clients (port %u)",
+                            static_cast<unsigned long long>(telemetry.samples()),
+                            static_cast<unsigned long long>(telemetry.dropped()), telemetry.clients(),
+                            static_cast<unsigned>(telemetry.port()));
+            }
+            if (!sim.replaying()) {
+                if (!recorder.isOpen() && ImGui::Button("Replay") && replay.open(recordingPath)) {
+                    auto simLock = sim.lock();
+                    sim.setReplay(&replay);
+                }
+            } else {
+                static int seekStep = 0;
+                const int first = static_cast<int>(replay.firstStep());
+                const int last = static_cast<int>(replay.lastStep());
+                seekStep = std::clamp(seekStep, first, last);
+                if (ImGui::SliderInt("Seek (step)", &seekStep, first, last)) {
+                    auto simLock = sim.lock();
+                    replay.seek(static_cast<std::uint64_t>(seekStep));
+                }
+                if (ImGui::Button("Stop replay")) {
+                    auto simLock = sim.lock();
+                    sim.setReplay(nullptr);
+                }
+            }
+
+            // analiza przeciążeń całego toru (profil v z bilansu energii, nie z jazdy wagonika)
+            static rc::gameplay::RideReport rideReport;
+            static float rideV0 = 15.0f;
+            ImGui::Separator();
+            ImGui::SliderFloat("Analysis v0 (m/s)", &rideV0, 0.0f, 60.0f, "%.1f");
+            // bez locka: czyta tylko ramki i parametry modelu, które zmienia wyłącznie ten wątek
+            if (ImGui::Button("Analyze Ride"))
+                rideReport = rc::gameplay::analyzeRide(trackComp, car, rideV0);
+            if (rideReport.ch.size() > 0) {
+                auto row = [](const char* name, const rc::gameplay::ChannelStats& c) {
+                    ImGui::Text("%-6s min %7.2f @%6.1f m  max %7.2f @%6.1f m  over %.2f s", name, c.min, c.sAtMin,
+                                c.max, c.sAtMax, c.timeOver);
+                };
+                row("vert", rideReport.vert);
+                row("lat", rideReport.lat);
+                row("long", rideReport.lon);
+                row("jerk", rideReport.jerk);
+                row("roll", rideReport.roll);
+                ImGui::Text("Lap: %.1f s", rideReport.lapTime);
+                if (rideReport.stallS >= 0.f) ImGui::Text("Stall at s = %.1f m", rideReport.stallS);
+                if (ImGui::Button("Export CSV")) rc::gameplay::writeRideCsv(rideReport, "ride_analysis.csv");
+                ImGui::SameLine();
+                if (ImGui::Button("Export binary")) rc::gameplay::writeRideBinary(rideReport, "ride_analysis.bin");
+            }
             ImGui::End();
         }
 
         // edycja toru
         {
             ImGui::Begin("Track Editor");
+            {
+                const auto& tb = track.lastBuild();
+                ImGui::Text("Track mesh: %zu/%zu chunks rebuilt, %.1f KB%s, %.1f ms", tb.rebuilt, tb.chunks,
+                            static_cast<double>(tb.bytesUploaded) / 1024.0, tb.fullUpload ? " (full)" : "", tb.ms);
+                ImGui::Text("Support instances: %zu", tb.instances);
+                ImGui::Text("Rail LOD0 vertex cache: ACMR %.3f, ATVR %.3f", tb.cache.acmr(), tb.cache.atvr());
+                ImGui::Text("GPU: rails %.1f MB, terrain %.1f MB", static_cast<double>(tb.gpuBytes) / (1024.0 * 1024.0),
+                            static_cast<double>(context.terrain.gpuBytes()) / (1024.0 * 1024.0));
+                ImGui::Text("CPU: rail meshes %.1f MB", static_cast<double>(tb.cpuBytes) / (1024.0 * 1024.0));
+                if (rc::common::alloc_stats::enabled())
+                    ImGui::Text("Build allocations: %zu, peak %.1f MB", tb.allocations,
+                                static_cast<double>(tb.peakAllocBytes) / (1024.0 * 1024.0));
+                if (ImGui::Checkbox("Packed vertices (16 B)", &context.packedVertices)) {
+                    track.setVertexFormat(context.packedVertices ? rc::gfx::geometry::VertexFormat::Packed
+                                                                 : rc::gfx::geometry::VertexFormat::Float);
+                    rebuildTrack();
+                    context.terrain.setPackedVertices(context.packedVertices);
+                    context.terrain.uploadToGPU();
+                    if (context.pendingTerrain) {
+                        context.pendingTerrain->setPackedVertices(context.packedVertices);
+                        context.pendingTerrain->beginUpload();
+                    }
+                }
+                if (ImGui::Checkbox("GPU rail extrusion", &context.railExtrusion)) {
+                    track.setRailExtrusion(context.railExtrusion);
+                    rebuildTrack();
+                }
+                ImGui::Checkbox("Meshlet culling", &context.meshletCulling);
+                if (context.meshletCulling) {
+                    for (const auto& [name, c]: {std::pair{"Rails", track.lastCull()},
+                                                 std::pair{"Terrain", context.terrain.lastCull()}})
+                        ImGui::Text("%-7s meshlets %zu: %zu frustum, %zu backface, %zu visible in %zu draws", name,
+                                    c.meshlets, c.frustumCulled, c.backfaceCulled, c.visible(), c.ranges);
+                }
+            }
 
             bool canEdit = (context.camMode == CamMode::Free);
             glm::vec3 camPosUI = context.camera.position;
@@ -524,11 +907,11 @@ int main() {
 
             bool isClosed = trackComp.isClosed();
             if (ImGui::Checkbox("Closed loop", &isClosed)) {
-                trackComp.setClosed(isClosed);
-                trackComp.rebuild();
-                car.onTrackRebuilt(trackComp);
-                const auto& frames2 = trackComp.frames();
-                track.build(frames2, railP, context.terrain, infraP);
+                {
+                    auto simLock = sim.lock();
+                    trackComp.setClosed(isClosed);
+                }
+                rebuildTrack();
             }
 
             ImGui::BeginDisabled(!canEdit);
@@ -536,16 +919,28 @@ int main() {
             static float snapClearance = 0.5f;
             ImGui::Checkbox("Snap to terrain", &snapToGround);
             if (snapToGround) ImGui::SliderFloat("Clearance", &snapClearance, 0.0f, 5.0f, "%.2f m");
+            // klik w teren (P - wolny kursor): nowy nod albo pozycja wybranego noda w "Edit Pos"
+            static int clickMode = 0; // 0=nic, 1=dodaj nod, 2=pozycja wybranego
+            ImGui::Text("Click on terrain:"); ImGui::SameLine();
+            ImGui::RadioButton("None##click", &clickMode, 0); ImGui::SameLine();
+            ImGui::RadioButton("Add node##click", &clickMode, 1); ImGui::SameLine();
+            ImGui::RadioButton("Pick selected pos##click", &clickMode, 2);
+            if (terrainHover) ImGui::Text("Cursor on terrain: %.2f  %.2f  %.2f", terrainPick.x, terrainPick.y, terrainPick.z);
+            else ImGui::Text("Cursor on terrain: -");
+            const glm::vec3 clickPos = terrainPick + glm::vec3(0.0f, snapToGround ? snapClearance : 0.0f, 0.0f);
+            if (canEdit && terrainClicked && clickMode == 1) {
+                float r = (splineRef.nodeCount() > 0) ? splineRef.getNode(splineRef.nodeCount()-1).roll : 0.0f;
+                splineRef.addNode({clickPos, r, 0.f, 0.f, 0.f});
+                trackComp.markDirty();
+                rebuildTrack();
+            }
             if (ImGui::Button("Add Node @ Camera")) {
                 glm::vec3 P = camPosUI;
                 if (snapToGround) P.y = context.terrain.sampleHeightBilinear(P.x, P.z) + snapClearance;
                 float r = (splineRef.nodeCount() > 0) ? splineRef.getNode(splineRef.nodeCount()-1).roll : 0.0f;
                 splineRef.addNode({P, r, 0.f, 0.f, 0.f});
                 trackComp.markDirty();
-                trackComp.rebuild();
-                car.onTrackRebuilt(trackComp);
-                const auto& frames2 = trackComp.frames();
-                track.build(frames2, railP, context.terrain, infraP);
+                rebuildTrack();
             }
             // dodaj ogon - 2 nody
             static float tailSegLen = 5.0f;
@@ -563,10 +958,7 @@ int main() {
                 splineRef.addNode({P1, r, 0.f, 0.f, 0.f});
                 splineRef.addNode({P2, r, 0.f, 0.f, 0.f});
                 trackComp.markDirty();
-                trackComp.rebuild();
-                car.onTrackRebuilt(trackComp);
-                const auto& frames2 = trackComp.frames();
-                track.build(frames2, railP, context.terrain, infraP);
+                rebuildTrack();
             }
             // dodaj nod po indeksie
             static int insertAfter = -1; if (insertAfter < -1) insertAfter = -1;
@@ -579,10 +971,7 @@ int main() {
                 float rPrev = (pos > 0) ? splineRef.getNode(pos-1).roll : (n>0 ? splineRef.getNode(0).roll : 0.0f);
                 splineRef.insertNode(pos, {P, rPrev, 0.f, 0.f, 0.f});
                 trackComp.markDirty();
-                trackComp.rebuild();
-                car.onTrackRebuilt(trackComp);
-                const auto& frames2 = trackComp.frames();
-                track.build(frames2, railP, context.terrain, infraP);
+                rebuildTrack();
             }
             // dodaj nod w miejsuc kamery
             static int moveIdx = 0; if (moveIdx < 0) moveIdx = 0;
@@ -594,10 +983,7 @@ int main() {
                     if (snapToGround) P.y = context.terrain.sampleHeightBilinear(P.x, P.z) + snapClearance;
                     splineRef.moveNode(idx, P);
                     trackComp.markDirty();
-                    trackComp.rebuild();
-                    car.onTrackRebuilt(trackComp);
-                    const auto& frames2 = trackComp.frames();
-                    track.build(frames2, railP, context.terrain, infraP);
+                    rebuildTrack();
                 }
             }
             // linearyzowanie ostatnich nodów
@@ -612,10 +998,7 @@ int main() {
                     }
                 }
                 trackComp.markDirty();
-                trackComp.rebuild();
-                car.onTrackRebuilt(trackComp);
-                const auto& frames2 = trackComp.frames();
-                track.build(frames2, railP, context.terrain, infraP);
+                rebuildTrack();
             }
             ImGui::EndDisabled();
 
@@ -633,10 +1016,7 @@ int main() {
                 if (ImGui::Button("Apply Roll")) {
                     if (splineRef.nodeCount() > 0) {
                         trackComp.setNodeRoll(static_cast<std::size_t>(rollIdx), glm::radians(rollDeg));
-                        trackComp.rebuild();
-                        car.onTrackRebuilt(trackComp);
-                        const auto& frames2 = trackComp.frames();
-                        track.build(frames2, railP, context.terrain, infraP);
+                        rebuildTrack();
                     }
                 }
 
@@ -666,10 +1046,7 @@ int main() {
                             splineRef.setNodeRoll(i, r);
                         }
                         trackComp.markDirty();
-                        trackComp.rebuild();
-                        car.onTrackRebuilt(trackComp);
-                        const auto& frames2 = trackComp.frames();
-                        track.build(frames2, railP, context.terrain, infraP);
+                        rebuildTrack();
                     }
                 }
             }
@@ -706,25 +1083,22 @@ int main() {
                     if (ImGui::Button("Apply Selected")) {
                         splineRef.moveNode(static_cast<std::size_t>(selectedIdx), {editPos[0], editPos[1], editPos[2]});
                         trackComp.setNodeRoll(static_cast<std::size_t>(selectedIdx), glm::radians(editRollDeg));
-                        trackComp.rebuild();
-                        car.onTrackRebuilt(trackComp);
-                        const auto& frames2 = trackComp.frames();
-                        track.build(frames2, railP, context.terrain, infraP);
+                        rebuildTrack();
                     }
                     ImGui::SameLine();
                     if (ImGui::Button("SnapY Selected")) {
                         float y = context.terrain.sampleHeightBilinear(editPos[0], editPos[2]);
                         editPos[1] = y;
                     }
+                    if (canEdit && terrainClicked && clickMode == 2) {
+                        editPos[0] = clickPos.x; editPos[1] = clickPos.y; editPos[2] = clickPos.z;
+                    }
                     ImGui::SameLine();
                     if (ImGui::Button("Delete Selected")) {
                         splineRef.removeNode(static_cast<std::size_t>(selectedIdx));
                         selectedIdx = -1; lastSel = -2;
                         trackComp.markDirty();
-                        trackComp.rebuild();
-                        car.onTrackRebuilt(trackComp);
-                        const auto& frames2 = trackComp.frames();
-                        track.build(frames2, railP, context.terrain, infraP);
+                        rebuildTrack();
                     }
                 } else {
                     ImGui::Text("Select a node to edit.");
@@ -747,10 +1121,7 @@ int main() {
                         splineRef.setNodeRoll(i, r);
                     }
                     trackComp.markDirty();
-                    trackComp.rebuild();
-                    car.onTrackRebuilt(trackComp);
-                    const auto& frames2 = trackComp.frames();
-                    track.build(frames2, railP, context.terrain, infraP);
+                    rebuildTrack();
                 }
             }
             ImGui::SameLine();
@@ -764,20 +1135,35 @@ int main() {
                     if (idx < splineRef.nodeCount()) {
                         splineRef.removeNode(idx);
                         trackComp.markDirty();
-                        trackComp.rebuild();
-                        car.onTrackRebuilt(trackComp);
-                        const auto& frames2 = trackComp.frames();
-                        track.build(frames2, railP, context.terrain, infraP);
+                        rebuildTrack();
                     }
                 }
             }
 
+            // odcinki między kolejnymi ramkami toru bliżej terenu niż zadany odstęp
+            ImGui::Separator();
+            static float groundClearance = 1.0f;
+            static int clearanceHits = -1;
+            static float clearanceFirstS = 0.0f;
+            ImGui::SliderFloat("Ground clearance", &groundClearance, 0.0f, 5.0f, "%.2f m");
+            if (ImGui::Button("Check Ground Clearance")) {
+                const auto& fr = trackComp.frames();
+                clearanceHits = 0;
+                for (std::size_t i = 1; i < fr.size(); ++i) {
+                    if (context.terrain.segmentClear(fr[i-1].pos, fr[i].pos, groundClearance)) continue;
+                    if (clearanceHits == 0) clearanceFirstS = fr[i-1].s;
+                    ++clearanceHits;
+                }
+            }
+            if (clearanceHits == 0) { ImGui::SameLine(); ImGui::Text("OK"); }
+            else if (clearanceHits > 0) {
+                ImGui::SameLine();
+                ImGui::Text("%d segments too low, first at s=%.1f m", clearanceHits, clearanceFirstS);
+            }
+
             ImGui::Separator();
             if (ImGui::Button("Rebuild Track")) {
-                trackComp.rebuild();
-                car.onTrackRebuilt(trackComp);
-                const auto& frames2 = trackComp.frames();
-                track.build(frames2, railP, context.terrain, infraP);
+                rebuildTrack();
             }
 
             ImGui::End();
@@ -806,49 +1192,67 @@ int main() {
         glDepthMask(GL_TRUE);
 
         // ===== TERRAIN =====
-        glUseProgram(terrainProgram);
+        const GLuint terrainProg = context.terrain.packedVertices() ? terrainPackedProgram : terrainProgram;
+        glUseProgram(terrainProg);
 
         glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, texGrassD);
         glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, texGrassS);
         glActiveTexture(GL_TEXTURE2); glBindTexture(GL_TEXTURE_2D, texGrassN);
 
-        glUniformMatrix4fv(glGetUniformLocation(terrainProgram,"model"),      1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(glGetUniformLocation(terrainProgram,"view"),       1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(terrainProgram,"projection"), 1, GL_FALSE, glm::value_ptr(projection));
-
-        glUniform3f (glGetUniformLocation(terrainProgram,"dirLightDir"),   0.2f,-0.9f,0.1f);
-        glUniform3f (glGetUniformLocation(terrainProgram,"dirLightColor"), 1.0f,0.98f,0.95f);
-        glUniform3fv(glGetUniformLocation(terrainProgram,"uCamPos"), 1, glm::value_ptr(camPosWorld));
-        glUniform3f (glGetUniformLocation(terrainProgram,"fogColor"),   0.04f,0.045f,0.055f);
-        glUniform1f (glGetUniformLocation(terrainProgram,"fogDensity"), 0.020f);
-
-        context.terrain.draw();
+        glUniformMatrix4fv(glGetUniformLocation(terrainProg,"model"),      1, GL_FALSE, glm::value_ptr(model));
+        glUniformMatrix4fv(glGetUniformLocation(terrainProg,"view"),       1, GL_FALSE, glm::value_ptr(view));
+        glUniformMatrix4fv(glGetUniformLocation(terrainProg,"projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+        glUniform3f (glGetUniformLocation(terrainProg,"dirLightDir"),   0.2f,-0.9f,0.1f);
+        glUniform3f (glGetUniformLocation(terrainProg,"dirLightColor"), 1.0f,0.98f,0.95f);
+        glUniform3fv(glGetUniformLocation(terrainProg,"uCamPos"), 1, glm::value_ptr(camPosWorld));
+        glUniform3f (glGetUniformLocation(terrainProg,"fogColor"),   0.04f,0.045f,0.055f);
+        glUniform1f (glGetUniformLocation(terrainProg,"fogDensity"), 0.020f);
+
+        const auto frustum = rc::math::Frustum::fromMatrix(projection * view * model);
+        if (context.terrain.chunkedLod()) {
+            context.terrain.updateLod(camPosWorld, frustum);
+            context.terrain.draw();
+        } else if (context.meshletCulling) {
+            context.terrain.draw(frustum, camPosWorld);
+        } else {
+            context.terrain.draw();
+        }
 
         // ===== TRACK =====
-        glUseProgram(trackProgram);
-
         glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, texSteelD);
         glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, texSteelS);
 
-        glUniformMatrix4fv(glGetUniformLocation(trackProgram,"model"),      1, GL_FALSE, glm::value_ptr(model));
-        glUniformMatrix4fv(glGetUniformLocation(trackProgram,"view"),       1, GL_FALSE, glm::value_ptr(view));
-        glUniformMatrix4fv(glGetUniformLocation(trackProgram,"projection"), 1, GL_FALSE, glm::value_ptr(projection));
-
-        glUniform3fv(glGetUniformLocation(trackProgram,"uViewPos"), 1, glm::value_ptr(camPosWorld));
-        glUniform3f (glGetUniformLocation(trackProgram,"dirLightDir"),   0.2f,-0.9f,0.1f);
-        glUniform3f (glGetUniformLocation(trackProgram,"dirLightColor"), 1.0f,0.98f,0.95f);
-        glUniform3fv(glGetUniformLocation(trackProgram,"pointPos"),  1, glm::value_ptr(car.getPos()));
-        glUniform3f (glGetUniformLocation(trackProgram,"pointColor"),    1.0f,0.9f,0.7f);
-        glUniform1f (glGetUniformLocation(trackProgram,"pointRange"),    25.0f);
-
-        track.draw();
+        // szyny (trackProgram / trackPackedProgram / trackExtrudeProgram) i instancje podpór (trackInstProgram)
+        // - te same uniformy
+        const GLuint railProg = track.railExtrusion() ? trackExtrudeProgram
+                                : track.vertexFormat() == rc::gfx::geometry::VertexFormat::Packed ? trackPackedProgram
+                                                                                                  : trackProgram;
+        for (GLuint prog : {railProg, trackInstProgram}) {
+            glUseProgram(prog);
+            glUniformMatrix4fv(glGetUniformLocation(prog,"model"),      1, GL_FALSE, glm::value_ptr(model));
+            glUniformMatrix4fv(glGetUniformLocation(prog,"view"),       1, GL_FALSE, glm::value_ptr(view));
+            glUniformMatrix4fv(glGetUniformLocation(prog,"projection"), 1, GL_FALSE, glm::value_ptr(projection));
+
+            glUniform3fv(glGetUniformLocation(prog,"uViewPos"), 1, glm::value_ptr(camPosWorld));
+            glUniform3f (glGetUniformLocation(prog,"dirLightDir"),   0.2f,-0.9f,0.1f);
+            glUniform3f (glGetUniformLocation(prog,"dirLightColor"), 1.0f,0.98f,0.95f);
+            glUniform3fv(glGetUniformLocation(prog,"pointPos"),  1, glm::value_ptr(carPose.pos));
+            glUniform3f (glGetUniformLocation(prog,"pointColor"),    1.0f,0.9f,0.7f);
+            glUniform1f (glGetUniformLocation(prog,"pointRange"),    25.0f);
+
+            if (prog == railProg && context.meshletCulling)
+                track.draw(camPosWorld, frustum);
+            else if (prog == railProg)
+                track.draw(camPosWorld);
+            else
+                track.drawSupports();
+        }
 
         // ===== CAR =====
-        car.update(context.deltaTime, trackComp);
-
         glm::mat4 carBase(1.0f);
-        carBase = glm::translate(carBase, car.getPos());
-        carBase *= glm::mat4(car.getOrientation());
+        carBase = glm::translate(carBase, carPose.pos);
+        carBase *= glm::mat4_cast(carPose.q);
 
         float bodyLift = 0.50f; //żeby box był ponad torem ^^
         glm::mat4 carModel = carBase
@@ -933,6 +1337,10 @@ int main() {
     }
 
     // Sprzątanie
+    sim.stop();
+    car.onSubstep = nullptr;
+    recorder.close();
+    telemetry.stop();
     context.terrain.releaseGL();
     track.releaseGL();
     ImGui_ImplOpenGL3_Shutdown();
@@ -943,6 +1351,10 @@ int main() {
     if (skyVAO) glDeleteVertexArrays(1, &skyVAO);
     if (skyVBO) glDeleteBuffers(1, &skyVBO);
     glDeleteProgram(trackProgram);
+    glDeleteProgram(trackInstProgram);
+    glDeleteProgram(trackPackedProgram);
+    glDeleteProgram(trackExtrudeProgram);
+    glDeleteProgram(terrainPackedProgram);
     glDeleteProgram(carShader);
     GLuint texToDelete[5] = {texGrassD, texGrassS, texGrassN, texSteelD, texSteelS};
     glDeleteTextures(5, texToDelete);
@@ -0,0 +1,259 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "BlockDispatcher.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <glm/geometric.hpp>
+#include <iostream>
+
+namespace rc::gameplay {
+    float BlockDispatcher::dist_(float from, float to) const {
+        float d = std::fmod(to - from, L_);
+        if (d > 0.5f * L_) d -= L_;
+        if (d < -0.5f * L_) d += L_;
+        return d;
+    }
+
+    double BlockDispatcher::eta_(float dist, float v) const {
+        if (dist <= 0.f) return now_;
+        return now_ + static_cast<double>(dist / std::max(v, 0.5f));
+    }
+
+    float BlockDispatcher::brakeAccel_(const Train& t, float s, float v) const {
+        if (!t.braking) return 0.f;
+        // hamulec kasuje grawitację i wytraca v dokładnie do sStop
+        const float aG = -t.car.g * glm::dot(t.car.up, track_.tangentAtS(s));
+        if (v <= 0.f) return -aG;
+        const float d = dist_(s, t.sStop);
+        const float need = (d > 0.01f) ? v * v / (2.f * d) : 3.f * params_.brakeDecel;
+        return -aG - need;
+    }
+
+    void BlockDispatcher::partition_() {
+        blocks_.clear();
+        L_ = track_.totalLength();
+
+        std::vector<std::pair<float, float>> st = track_.stations();
+        // stacja przez szew pętli jest zapisana jako (a, L) + (0, b)
+        if (st.size() > 1 && st.front().first <= 1e-3f && st.back().second >= L_ - 1e-3f) {
+            st.back().second = L_ + st.front().second;
+            st.erase(st.begin());
+        }
+
+        for (std::size_t i = 0; i < st.size(); ++i) {
+            const auto [a, b] = st[i];
+            blocks_.push_back({a, b, true});
+
+            const float gapBegin = b;
+            const float gapEnd = (i + 1 < st.size()) ? st[i + 1].first : st.front().first + L_;
+            const float gap = gapEnd - gapBegin;
+            if (gap <= 1e-3f) continue;
+            const int n = std::max(1, static_cast<int>(std::lround(gap / params_.blockLength)));
+            for (int k = 0; k < n; ++k) {
+                const float b0 = gapBegin + gap * static_cast<float>(k) / static_cast<float>(n);
+                const float b1 = gapBegin + gap * static_cast<float>(k + 1) / static_cast<float>(n);
+                blocks_.push_back({b0, b1, false});
+            }
+        }
+    }
+
+    bool BlockDispatcher::init(int trainCount) {
+        trains_.clear();
+        events_ = {};
+        stats_ = {};
+        now_ = 0.0;
+
+        if (!track_.isClosed() || track_.frames().empty()) {
+            std::cerr << "BlockDispatcher: track must be a closed, built circuit" << std::endl;
+            return false;
+        }
+        partition_();
+        if (blocks_.empty()) {
+            std::cerr << "BlockDispatcher: no station on track" << std::endl;
+            return false;
+        }
+        // każdy pociąg potrzebuje wolnego bloku przed sobą, inaczej zakleszczenie
+        if (trainCount < 1 || static_cast<std::size_t>(trainCount) * 2 > blocks_.size()) {
+            std::cerr << "BlockDispatcher: " << trainCount << " trains do not fit in " << blocks_.size()
+                      << " blocks" << std::endl;
+            return false;
+        }
+
+        trains_.resize(static_cast<std::size_t>(trainCount));
+        for (std::size_t i = 0; i < trains_.size(); ++i) {
+            Train& t = trains_[i];
+            const std::size_t b = i * blocks_.size() / trains_.size();
+            const Block& blk = blocks_[b];
+
+            t.car.bindTrack(track_);
+            t.car.minSpeed = params_.cruiseMinSpeed;
+            t.car.extraAccel = [this, i](float s, float v) { return brakeAccel_(trains_[i], s, v); };
+            t.block = b;
+            blocks_[b].occupant = static_cast<int>(i);
+
+            if (blk.station) {
+                t.car.s = std::fmod(blk.sEnd - params_.stopMargin, L_);
+                t.car.v = 0.f;
+                brakeTo_(t, t.car.s);
+                t.state = TrainState::Loading;
+                push_(now_ + params_.dwellTime, EventType::Dispatch, i);
+            } else {
+                const float len = blk.sEnd - blk.sBegin;
+                t.car.s = std::fmod(blk.sBegin + std::min(params_.trainLength, 0.5f * len), L_);
+                t.car.kick(params_.launchSpeed);
+                t.car.minSpeedEnabled = true;
+                t.state = TrainState::Running;
+                push_(now_, EventType::CheckPoint, i);
+            }
+        }
+        return true;
+    }
+
+    void BlockDispatcher::step(float dt) {
+        for (auto& t: trains_)
+            t.car.update(dt, track_);
+        now_ += dt;
+        stats_.simTime = now_;
+        ++stats_.ticks;
+
+        if (events_.empty() || events_.top().t > now_)
+            return;
+        ++stats_.ticksWithEvents;
+        while (!events_.empty() && events_.top().t <= now_) {
+            const Event e = events_.top();
+            events_.pop();
+            process_(e);
+            ++stats_.eventsProcessed;
+        }
+    }
+
+    void BlockDispatcher::run(double seconds) {
+        const double end = now_ + seconds;
+        while (now_ < end)
+            step(kStep);
+    }
+
+    void BlockDispatcher::push_(double t, EventType type, std::size_t train, std::size_t block) {
+        events_.push({t, type, train, block});
+    }
+
+    void BlockDispatcher::process_(const Event& e) {
+        switch (e.type) {
+            case EventType::CheckPoint: checkPoint_(e.train); break;
+            case EventType::Release: release_(e.train, e.block); break;
+            case EventType::Stopped: stopped_(e.train); break;
+            case EventType::Dispatch: dispatch_(e.train); break;
+        }
+    }
+
+    void BlockDispatcher::brakeTo_(Train& t, float sStop) {
+        t.braking = true;
+        t.sStop = std::fmod(std::fmod(sStop, L_) + L_, L_);
+        t.car.minSpeedEnabled = false;
+    }
+
+    void BlockDispatcher::checkPoint_(std::size_t ti) {
+        Train& t = trains_[ti];
+        if (t.state != TrainState::Running) return;
+
+        const Block& blk = blocks_[t.block];
+        const float v = std::max(t.car.v, 0.f);
+        const float stopAt = blk.sEnd - params_.stopMargin;
+        // punkt decyzji = ostatnia chwila, żeby zdążyć wyhamować przed końcem bloku
+        const float toDecision = dist_(t.car.s, stopAt) - v * v / (2.f * params_.brakeDecel);
+        if (toDecision > 0.05f) {
+            push_(eta_(toDecision, v), EventType::CheckPoint, ti);
+            return;
+        }
+
+        const std::size_t nb = next_(t.block);
+        if (blocks_[nb].occupant < 0) {
+            enterNext_(ti);
+            return;
+        }
+        t.state = TrainState::Holding;
+        t.waitingFor = nb;
+        ++stats_.holds;
+        brakeTo_(t, stopAt);
+        push_(eta_(2.f * dist_(t.car.s, t.sStop), v), EventType::Stopped, ti);
+    }
+
+    void BlockDispatcher::enterNext_(std::size_t ti) {
+        Train& t = trains_[ti];
+        const std::size_t b = t.block;
+        const std::size_t nb = next_(b);
+
+        blocks_[nb].occupant = static_cast<int>(ti);
+        t.block = nb;
+        t.waitingFor = kNone;
+        // poprzedni blok zwalnia się dopiero gdy ogon go opuści
+        push_(eta_(dist_(t.car.s, blocks_[b].sEnd + params_.trainLength), t.car.v), EventType::Release, ti, b);
+
+        if (t.car.v < params_.launchSpeed)
+            t.car.kick(params_.launchSpeed);
+
+        if (blocks_[nb].station) {
+            t.state = TrainState::Approach;
+            brakeTo_(t, blocks_[nb].sEnd - params_.stopMargin);
+            push_(eta_(2.f * dist_(t.car.s, t.sStop), t.car.v), EventType::Stopped, ti);
+        } else {
+            t.state = TrainState::Running;
+            t.braking = false;
+            t.car.minSpeedEnabled = true;
+            push_(now_, EventType::CheckPoint, ti);
+        }
+    }
+
+    void BlockDispatcher::release_(std::size_t ti, std::size_t b) {
+        const Train& t = trains_[ti];
+        const float d = dist_(t.car.s, blocks_[b].sEnd + params_.trainLength);
+        if (d > 0.01f) {
+            push_(t.car.v > 0.1f ? eta_(d, t.car.v) : now_ + 0.5, EventType::Release, ti, b);
+            return;
+        }
+        blocks_[b].occupant = -1;
+
+        for (std::size_t j = 0; j < trains_.size(); ++j) {
+            if (trains_[j].waitingFor != b) continue;
+            if (trains_[j].state == TrainState::Loading)
+                dispatch_(j);
+            else
+                enterNext_(j);
+            break;
+        }
+    }
+
+    void BlockDispatcher::stopped_(std::size_t ti) {
+        Train& t = trains_[ti];
+        if (t.state != TrainState::Holding && t.state != TrainState::Approach) return;
+
+        const float d = dist_(t.car.s, t.sStop);
+        const float v = std::abs(t.car.v);
+        if (v < 0.05f && std::abs(d) < 0.5f) {
+            t.car.v = 0.f;
+            t.car.s = t.sStop;
+            if (t.state == TrainState::Approach) {
+                t.state = TrainState::Loading;
+                push_(now_ + params_.dwellTime, EventType::Dispatch, ti);
+            }
+            return;
+        }
+        if (v < 0.5f && d > 0.5f) // stanął za wcześnie (np. pod górę) - dociągnij
+            t.car.kick(1.5f);
+        push_(std::max(eta_(2.f * std::max(d, 0.1f), t.car.v), now_ + 1.0 / 60.0), EventType::Stopped, ti);
+    }
+
+    void BlockDispatcher::dispatch_(std::size_t ti) {
+        Train& t = trains_[ti];
+        const std::size_t nb = next_(t.block);
+        if (blocks_[nb].occupant >= 0) {
+            t.waitingFor = nb; // release_ wywoła dispatch_ ponownie
+            return;
+        }
+        ++stats_.dispatches;
+        enterNext_(ti);
+    }
+} // namespace rc::gameplay
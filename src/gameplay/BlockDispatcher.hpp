@@ -0,0 +1,120 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_BLOCKDISPATCHER_HPP
+#define ROLLERCOASTERGL_BLOCKDISPATCHER_HPP
+
+#include <cstddef>
+#include <limits>
+#include <queue>
+#include <vector>
+
+#include "Car.hpp"
+#include "TrackComponent.hpp"
+
+namespace rc::gameplay {
+    struct DispatchParams {
+        float blockLength = 60.f;    // docelowa długość bloku poza stacją
+        float trainLength = 8.f;
+        int seatsPerTrain = 20;
+        float dwellTime = 30.f;      // postój na stacji (załadunek)
+        float launchSpeed = 12.f;    // wyjazd ze stacji / z hamulca blokowego
+        float cruiseMinSpeed = 8.f;  // asysta jak Car::minSpeed (wyciąg, booster)
+        float brakeDecel = 4.f;      // projektowe opóźnienie hamulców blokowych
+        float stopMargin = 1.f;      // zatrzymanie przed końcem bloku
+    };
+
+    struct Block {
+        float sBegin = 0.f, sEnd = 0.f; // sEnd może wyjść poza L przy bloku przez szew pętli
+        bool station = false;
+        int occupant = -1;
+    };
+
+    struct DispatchStats {
+        double simTime = 0.0;
+        std::size_t dispatches = 0;
+        std::size_t holds = 0;          // zatrzymania na hamulcach blokowych
+        std::size_t eventsProcessed = 0;
+        std::size_t ticks = 0;
+        std::size_t ticksWithEvents = 0;
+
+        [[nodiscard]] double trainsPerHour() const {
+            return simTime > 0.0 ? static_cast<double>(dispatches) * 3600.0 / simTime : 0.0;
+        }
+    };
+
+    // Dzieli zamknięty tor na bloki (stacje + odcinki ~blockLength) i prowadzi kilka pociągów tak,
+    // żeby w bloku był najwyżej jeden. Logika bloków działa tylko na zdarzeniach z kolejki
+    // (przewidywany czas dojazdu do punktu decyzji / zwolnienia bloku), fizyka wagonów idzie co krok.
+    class BlockDispatcher {
+    public:
+        static constexpr float kStep = 1.0f / 240.0f;
+
+        BlockDispatcher(const TrackComponent& track, const DispatchParams& params) : track_(track), params_(params) {}
+        BlockDispatcher(const BlockDispatcher&) = delete;
+        BlockDispatcher& operator=(const BlockDispatcher&) = delete;
+
+        // false gdy tor otwarty, bez stacji albo pociągów więcej niż bloków
+        bool init(int trainCount);
+        void step(float dt);
+        void run(double seconds);
+
+        [[nodiscard]] const std::vector<Block>& blocks() const { return blocks_; }
+        [[nodiscard]] const DispatchStats& stats() const { return stats_; }
+        [[nodiscard]] double hourlyCapacity() const {
+            return stats_.trainsPerHour() * static_cast<double>(params_.seatsPerTrain);
+        }
+        [[nodiscard]] std::size_t trainCount() const { return trains_.size(); }
+        [[nodiscard]] const Car& train(std::size_t i) const { return trains_[i].car; }
+
+    private:
+        static constexpr std::size_t kNone = std::numeric_limits<std::size_t>::max();
+
+        enum class TrainState { Running, Holding, Approach, Loading };
+        enum class EventType { CheckPoint, Release, Stopped, Dispatch };
+
+        struct Train {
+            Car car;
+            TrainState state = TrainState::Running;
+            std::size_t block = 0;
+            std::size_t waitingFor = kNone;
+            bool braking = false;
+            float sStop = 0.f;
+        };
+
+        struct Event {
+            double t;
+            EventType type;
+            std::size_t train;
+            std::size_t block;
+            bool operator>(const Event& o) const { return t > o.t; }
+        };
+
+        const TrackComponent& track_;
+        DispatchParams params_;
+        std::vector<Block> blocks_;
+        std::vector<Train> trains_;
+        std::priority_queue<Event, std::vector<Event>, std::greater<>> events_;
+        DispatchStats stats_;
+        double now_ = 0.0;
+        float L_ = 0.f;
+
+        void partition_();
+        [[nodiscard]] std::size_t next_(std::size_t b) const { return (b + 1) % blocks_.size(); }
+        [[nodiscard]] float dist_(float from, float to) const; // ze znakiem, po zawinięciu pętli
+        [[nodiscard]] double eta_(float dist, float v) const;
+        [[nodiscard]] float brakeAccel_(const Train& t, float s, float v) const;
+
+        void push_(double t, EventType type, std::size_t train, std::size_t block = kNone);
+        void process_(const Event& e);
+        void checkPoint_(std::size_t ti);
+        void release_(std::size_t ti, std::size_t b);
+        void stopped_(std::size_t ti);
+        void dispatch_(std::size_t ti);
+        void enterNext_(std::size_t ti);
+        void brakeTo_(Train& t, float sStop);
+    };
+} // namespace rc::gameplay
+
+#endif // ROLLERCOASTERGL_BLOCKDISPATCHER_HPP
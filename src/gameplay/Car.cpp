@@ -51,11 +51,14 @@ namespace rc::gameplay {
                 else a_roll = -muRoll * g * static_cast<float>((adr > 0) - (adr < 0));
             }
             float a = a_g + a_ext + a_air + a_roll;
+            if (onSubstep)
+                onSubstep({stepCount, s, v, a_g, a_ext, a_air, a_roll, P, static_cast<std::uint32_t>(cursor_.index())});
 
             v += a * dtSub;
             v = std::clamp(v, -vMax, vMax);
             if (std::abs(v) < vStopEps && std::abs(a_g + a_ext) < muRoll * g) v = 0.0f;
             s += v * dtSub;
+            ++stepCount;
 
             //wrap lub odbicie
             float L = track.totalLength();
@@ -81,7 +84,18 @@ namespace rc::gameplay {
                 else          v = std::min(v, -minSpeed);
             }
         }
+        updatePose_();
+    }
+
+    void Car::setState(float s0, float v0) {
+        s = s0;
+        v = v0;
+        updatePose_();
+    }
+
+    void Car::updatePose_() {
         //orientacja, odwrócenie T przy jeździe do tyłu
+        glm::vec3 P, T, N, B;
         glm::quat q;
         cursor_.sample(s, P, T, N, B, q);
         if (backwards_) {
@@ -4,6 +4,7 @@
 
 #ifndef ROLLERCOASTERGL_CAR_HPP
 #define ROLLERCOASTERGL_CAR_HPP
+#include <cstdint>
 #include <functional>
 #include <glm/glm.hpp>
 #include <glm/vec3.hpp>
@@ -12,6 +13,15 @@
 #include "TrackComponent.hpp"
 
 namespace rc::gameplay {
+    // stan na początku podkroku całkowania i przyspieszenia działające w tym podkroku
+    struct CarSubstep {
+        std::uint64_t step = 0;
+        float s = 0.f, v = 0.f;
+        float aG = 0.f, aExt = 0.f, aAir = 0.f, aRoll = 0.f;
+        glm::vec3 pos{0.f};
+        std::uint32_t frameIdx = 0;
+    };
+
     class Car {
         public:
         Car() = default;
@@ -28,11 +38,16 @@ namespace rc::gameplay {
         float v = 15.0f;
 
         std::function <float(float s, float v)> extraAccel;
+        // wołane w każdym podkroku (nagrywanie, telemetria); puste = brak kosztu poza testem
+        std::function <void(const CarSubstep&)> onSubstep;
+        std::uint64_t stepCount = 0; // licznik podkroków od startu
         void kick(float v0) {v = v0;}
 
         void bindTrack(const TrackComponent& track);
         void onTrackRebuilt(const TrackComponent& track);
         void update(float dt, const TrackComponent& track);
+        // ustawia stan bez całkowania (odtwarzanie nagrania)
+        void setState(float s0, float v0);
         [[nodiscard]] glm::vec3 getPos() const { return pos_; }
         [[nodiscard]] glm::mat3 getOrientation() const { return orientation_; }
         // min-speed assist
@@ -40,6 +55,8 @@ namespace rc::gameplay {
         float minSpeed = 20.0f;
 
     private:
+        void updatePose_();
+
         physics::FrameCursor cursor_;
         std::size_t frameIdxCache_ = 0;
         glm::vec3 pos_{0.f};
@@ -0,0 +1,221 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "RideAnalysis.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <glm/geometric.hpp>
+#include <glm/trigonometric.hpp>
+#include <limits>
+
+#include "common/ThreadPool.hpp"
+
+namespace rc::gameplay {
+    namespace {
+        constexpr std::size_t kMinChunk = 4096;
+        // jerk to druga pochodna po ramkach - różnicujemy na stałym odcinku łuku, nie co ramkę,
+        // inaczej szum stycznych rośnie jak 1/ds
+        constexpr float kJerkWindow = 1.0f;
+
+        struct PartialStats {
+            ChannelStats vert, lat, lon, jerk, roll;
+        };
+
+        ChannelStats emptyStats() {
+            ChannelStats cs;
+            cs.min = std::numeric_limits<float>::infinity();
+            cs.max = -std::numeric_limits<float>::infinity();
+            return cs;
+        }
+
+        void accumulate(ChannelStats& cs, float x, float s, bool over, double w) {
+            if (x < cs.min) {
+                cs.min = x;
+                cs.sAtMin = s;
+            }
+            if (x > cs.max) {
+                cs.max = x;
+                cs.sAtMax = s;
+            }
+            if (over)
+                cs.timeOver += w;
+        }
+
+        void merge(ChannelStats& into, const ChannelStats& c) {
+            if (c.min < into.min) {
+                into.min = c.min;
+                into.sAtMin = c.sAtMin;
+            }
+            if (c.max > into.max) {
+                into.max = c.max;
+                into.sAtMax = c.sAtMax;
+            }
+            into.timeOver += c.timeOver;
+        }
+    } // namespace
+
+    RideReport analyzeRide(const TrackComponent& track, const Car& model, float v0, const RideThresholds& thr) {
+        RideReport rep;
+        const auto& F = track.frames();
+        const std::size_t n = F.size();
+        if (n < 3)
+            return rep;
+
+        const bool closed = track.isClosed();
+        const float L = track.totalLength();
+        const float g = model.g;
+        auto& ch = rep.ch;
+        for (auto* c: {&ch.s, &ch.t, &ch.v, &ch.gVert, &ch.gLat, &ch.gLong, &ch.jerk, &ch.rollRate})
+            c->resize(n);
+
+        // 1) profil prędkości: d(v^2/2)/ds = -g dy/ds - mu g - kAir v^2 (półniejawnie po oporze powietrza).
+        // Rekurencja jest szeregowa, ale to jedno mnożenie na ramkę.
+        float E = 0.5f * v0 * v0;
+        double t = 0.0;
+        ch.s[0] = F[0].s;
+        ch.v[0] = v0;
+        ch.t[0] = 0.f;
+        for (std::size_t i = 1; i < n; ++i) {
+            const float ds = std::max(F[i].s - F[i - 1].s, 1e-6f);
+            const float dy = glm::dot(model.up, F[i].pos - F[i - 1].pos);
+            E = (E - g * dy - model.muRoll * g * ds) / (1.f + 2.f * model.kAir * ds);
+            float v = std::sqrt(2.f * std::max(E, 0.f));
+            if (model.minSpeedEnabled && v < model.minSpeed) {
+                v = model.minSpeed;
+                E = 0.5f * v * v;
+            } else if (E <= 0.f) {
+                if (rep.stallS < 0.f)
+                    rep.stallS = F[i].s;
+                E = 0.f;
+            }
+            v = std::min(v, model.vMax);
+            ch.s[i] = F[i].s;
+            ch.v[i] = v;
+            t += ds / std::max(0.5f * (v + ch.v[i - 1]), 0.1f);
+            ch.t[i] = static_cast<float>(t);
+        }
+        rep.lapTime = t;
+        if (closed) { // zamknięta pętla zwykle ma już ramkę końcową w s = L
+            const float ds = std::max(L - F[n - 1].s, 0.f);
+            rep.lapTime += ds / std::max(0.5f * (ch.v[n - 1] + ch.v[0]), 0.1f);
+        }
+
+        // Jedno okrążenie od v0 nie jest okresowe (v na końcu != v0), więc różnice na szwie
+        // pętli są jednostronne zamiast zawijać.
+        auto prevIdx = [&](std::size_t i) { return i > 0 ? i - 1 : 0; };
+        auto nextIdx = [&](std::size_t i) { return i + 1 < n ? i + 1 : n - 1; };
+        auto sSpan = [&](std::size_t a, std::size_t b) { return std::max(F[b].s - F[a].s, 1e-6f); };
+        auto tSpan = [&](std::size_t a, std::size_t b) {
+            return std::max(static_cast<double>(ch.t[b]) - ch.t[a], 1e-6);
+        };
+        // siła odczuwalna (a - g) w układzie świata
+        auto felt = [&](std::size_t i) {
+            const std::size_t a = prevIdx(i), b = nextIdx(i);
+            const float ds = sSpan(a, b);
+            const glm::vec3 kappa = (F[b].T - F[a].T) / ds;
+            const float aT = 0.5f * (ch.v[b] * ch.v[b] - ch.v[a] * ch.v[a]) / ds;
+            return aT * F[i].T + ch.v[i] * ch.v[i] * kappa + g * model.up;
+        };
+
+        const float avgDs = (F[n - 1].s - F[0].s) / static_cast<float>(n - 1);
+        const std::size_t jw = std::max<std::size_t>(1, static_cast<std::size_t>(std::lround(kJerkWindow / std::max(avgDs, 1e-6f))));
+
+        // 2) kanały + statystyki, kawałkami; felt liczone raz na ramkę (z marginesem jw po bokach kawałka)
+        auto& pool = common::ThreadPool::shared();
+        std::vector<PartialStats> partial(pool.chunkCount(n, kMinChunk));
+        pool.parallelFor(n, kMinChunk, [&](std::size_t begin, std::size_t end, std::size_t chunk) {
+            const std::size_t lo = begin > jw ? begin - jw : 0;
+            const std::size_t hi = std::min(end + jw, n);
+            std::vector<glm::vec3> f(hi - lo);
+            for (std::size_t i = lo; i < hi; ++i)
+                f[i - lo] = felt(i);
+
+            PartialStats ps{emptyStats(), emptyStats(), emptyStats(), emptyStats(), emptyStats()};
+            for (std::size_t i = begin; i < end; ++i) {
+                const std::size_t a = prevIdx(i), b = nextIdx(i);
+                const glm::vec3& fi = f[i - lo];
+                const double dt = tSpan(a, b);
+                const std::size_t ja = i > jw ? i - jw : 0;
+                const std::size_t jb = std::min(i + jw, n - 1);
+
+                const float gv = glm::dot(fi, F[i].N) / g;
+                const float gl = glm::dot(fi, F[i].B) / g;
+                const float go = glm::dot(fi, F[i].T) / g;
+                const float jerk =
+                        glm::length(f[jb - lo] - f[ja - lo]) / (g * static_cast<float>(tSpan(ja, jb)));
+                const float roll =
+                        glm::degrees(ch.v[i] * glm::dot((F[b].N - F[a].N) / sSpan(a, b), F[i].B));
+
+                ch.gVert[i] = gv;
+                ch.gLat[i] = gl;
+                ch.gLong[i] = go;
+                ch.jerk[i] = jerk;
+                ch.rollRate[i] = roll;
+
+                const double w = 0.5 * dt; // czas "należący" do ramki
+                const float s = F[i].s;
+                accumulate(ps.vert, gv, s, gv > thr.gVertHigh || gv < thr.gVertLow, w);
+                accumulate(ps.lat, gl, s, std::abs(gl) > thr.gLatAbs, w);
+                accumulate(ps.lon, go, s, std::abs(go) > thr.gLongAbs, w);
+                accumulate(ps.jerk, jerk, s, jerk > thr.jerkAbs, w);
+                accumulate(ps.roll, roll, s, std::abs(roll) > thr.rollRateAbs, w);
+            }
+            partial[chunk] = ps;
+        });
+
+        rep.vert = rep.lat = rep.lon = rep.jerk = rep.roll = emptyStats();
+        for (const auto& ps: partial) {
+            merge(rep.vert, ps.vert);
+            merge(rep.lat, ps.lat);
+            merge(rep.lon, ps.lon);
+            merge(rep.jerk, ps.jerk);
+            merge(rep.roll, ps.roll);
+        }
+        return rep;
+    }
+
+    bool writeRideCsv(const RideReport& report, const std::string& filename) {
+        std::ofstream file(filename);
+        if (!file)
+            return false;
+        const auto& ch = report.ch;
+        const std::vector<float>* cols[] = {&ch.s, &ch.t, &ch.v, &ch.gVert, &ch.gLat, &ch.gLong, &ch.jerk,
+                                            &ch.rollRate};
+        file << "s,t,v,g_vert,g_lat,g_long,jerk,roll_rate\n";
+        // to_chars zamiast operator<< - przy 100k wierszy formatowanie strumienia dominuje
+        std::string line;
+        char buf[32];
+        for (std::size_t i = 0; i < ch.size(); ++i) {
+            line.clear();
+            for (std::size_t c = 0; c < std::size(cols); ++c) {
+                if (c) line.push_back(',');
+                const auto res = std::to_chars(buf, buf + sizeof(buf), (*cols[c])[i]);
+                line.append(buf, res.ptr);
+            }
+            line.push_back('\n');
+            file.write(line.data(), static_cast<std::streamsize>(line.size()));
+        }
+        return static_cast<bool>(file);
+    }
+
+    bool writeRideBinary(const RideReport& report, const std::string& filename) {
+        std::ofstream file(filename, std::ios::binary);
+        if (!file)
+            return false;
+        const auto& ch = report.ch;
+        const std::vector<float>* channels[] = {&ch.s, &ch.t, &ch.v, &ch.gVert, &ch.gLat, &ch.gLong, &ch.jerk,
+                                                &ch.rollRate};
+        const std::uint32_t header[] = {1u, static_cast<std::uint32_t>(std::size(channels)),
+                                        static_cast<std::uint32_t>(ch.size())};
+        file.write("RCRD", 4);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        for (const auto* c: channels)
+            file.write(reinterpret_cast<const char*>(c->data()), static_cast<std::streamsize>(c->size() * sizeof(float)));
+        return static_cast<bool>(file);
+    }
+} // namespace rc::gameplay
@@ -0,0 +1,59 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_RIDEANALYSIS_HPP
+#define ROLLERCOASTERGL_RIDEANALYSIS_HPP
+
+#include <string>
+#include <vector>
+
+#include "Car.hpp"
+#include "TrackComponent.hpp"
+
+namespace rc::gameplay {
+    // Kanały per ramka (SoA). g w jednostkach g, jerk w g/s, rollRate w deg/s.
+    struct RideChannels {
+        std::vector<float> s, t, v;
+        std::vector<float> gVert, gLat, gLong;
+        std::vector<float> jerk, rollRate;
+
+        [[nodiscard]] std::size_t size() const {
+            return s.size();
+        }
+    };
+
+    struct RideThresholds {
+        float gVertHigh = 4.0f;  // dociskanie
+        float gVertLow = -1.0f;  // airtime
+        float gLatAbs = 1.5f;
+        float gLongAbs = 1.5f;
+        float jerkAbs = 10.0f;
+        float rollRateAbs = 120.0f;
+    };
+
+    struct ChannelStats {
+        float min = 0.f, max = 0.f;
+        float sAtMin = 0.f, sAtMax = 0.f;
+        double timeOver = 0.0; // s powyżej progu
+    };
+
+    struct RideReport {
+        RideChannels ch;
+        ChannelStats vert, lat, lon, jerk, roll;
+        double lapTime = 0.0;
+        float stallS = -1.f; // >= 0 gdy wagon nie dojeżdża (bez asysty min speed)
+    };
+
+    // Profil prędkości z bilansu energii (ten sam model oporów co Car::update), potem
+    // przeciążenia w układzie ramki (T, N, B) liczone równolegle na kawałkach toru.
+    // v0 to prędkość w s = 0; asysta min speed brana z modelu.
+    [[nodiscard]] RideReport analyzeRide(const TrackComponent& track, const Car& model, float v0,
+                                         const RideThresholds& thr = {});
+
+    bool writeRideCsv(const RideReport& report, const std::string& filename);
+    // "RCRD", u32 wersja, u32 liczba kanałów, u32 liczba próbek, potem kanały float32 po kolei
+    bool writeRideBinary(const RideReport& report, const std::string& filename);
+} // namespace rc::gameplay
+
+#endif // ROLLERCOASTERGL_RIDEANALYSIS_HPP
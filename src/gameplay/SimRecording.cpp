@@ -0,0 +1,275 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "SimRecording.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstring>
+
+namespace rc::gameplay {
+    namespace {
+        constexpr char kMagic[4] = {'R', 'C', 'R', 'P'};
+        constexpr char kFooterMagic[4] = {'R', 'C', 'R', 'I'};
+        constexpr char kChunkTag = 'K';
+        constexpr auto kFlushPeriod = std::chrono::milliseconds(10);
+
+        std::uint64_t zigzag(std::int64_t x) {
+            return (static_cast<std::uint64_t>(x) << 1) ^ static_cast<std::uint64_t>(x >> 63);
+        }
+        std::int64_t unzigzag(std::uint64_t x) {
+            return static_cast<std::int64_t>(x >> 1) ^ -static_cast<std::int64_t>(x & 1);
+        }
+
+        void putVarint(std::vector<std::uint8_t>& out, std::uint64_t x) {
+            while (x >= 0x80) {
+                out.push_back(static_cast<std::uint8_t>(x | 0x80));
+                x >>= 7;
+            }
+            out.push_back(static_cast<std::uint8_t>(x));
+        }
+        bool getVarint(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& x) {
+            x = 0;
+            for (int shift = 0; shift < 64 && p < end; shift += 7) {
+                const std::uint8_t b = *p++;
+                x |= static_cast<std::uint64_t>(b & 0x7f) << shift;
+                if (!(b & 0x80))
+                    return true;
+            }
+            return false;
+        }
+
+        template <typename T>
+        void writePod(std::ofstream& f, const T& v) {
+            f.write(reinterpret_cast<const char*>(&v), sizeof(T));
+        }
+        template <typename T>
+        bool readPod(std::ifstream& f, T& v) {
+            return static_cast<bool>(f.read(reinterpret_cast<char*>(&v), sizeof(T)));
+        }
+
+        std::array<float*, recording::kFields> fieldsOf(SimRecord& r) {
+            return {&r.s, &r.v, &r.aG, &r.aExt, &r.aAir, &r.aRoll};
+        }
+    } // namespace
+
+    SimRecorder::SimRecorder(std::size_t ringCapacity) : ring_(ringCapacity) {}
+
+    bool SimRecorder::open(const std::string& filename) {
+        if (isOpen())
+            return false;
+        file_.open(filename, std::ios::binary | std::ios::trunc);
+        if (!file_)
+            return false;
+        file_.write(kMagic, 4);
+        writePod(file_, recording::kVersion);
+
+        chunk_.clear();
+        chunk_.reserve(recording::kChunkRecords * 16);
+        chunkRecords_ = 0;
+        index_.clear();
+        lastStep_ = 0;
+        written_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+
+        running_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread(&SimRecorder::flushLoop_, this);
+        return true;
+    }
+
+    void SimRecorder::close() {
+        if (!running_.exchange(false))
+            return;
+        if (thread_.joinable())
+            thread_.join();
+        drain_();
+        if (chunkRecords_ > 0)
+            writeChunk_();
+
+        const auto indexOffset = static_cast<std::uint64_t>(file_.tellp());
+        writePod(file_, static_cast<std::uint32_t>(index_.size()));
+        for (const auto& e: index_) {
+            writePod(file_, e.firstStep);
+            writePod(file_, e.offset);
+        }
+        writePod(file_, lastStep_);
+        writePod(file_, indexOffset);
+        file_.write(kFooterMagic, 4);
+        file_.close();
+    }
+
+    void SimRecorder::flushLoop_() {
+        while (running_.load(std::memory_order_relaxed)) {
+            drain_();
+            std::this_thread::sleep_for(kFlushPeriod);
+        }
+    }
+
+    void SimRecorder::drain_() {
+        SimRecord r;
+        std::uint64_t n = 0;
+        while (ring_.pop(r)) {
+            encode_(r);
+            ++n;
+        }
+        if (n)
+            written_.fetch_add(n, std::memory_order_relaxed);
+    }
+
+    void SimRecorder::encode_(const SimRecord& r) {
+        if (chunkRecords_ == 0) { // klatka kluczowa - delty od zera
+            chunkFirstStep_ = r.step;
+            prevStep_ = 0;
+            for (auto& p: prevBits_)
+                p.fill(0);
+        }
+        if (r.carId >= prevBits_.size())
+            prevBits_.resize(r.carId + 1, {});
+
+        putVarint(chunk_, zigzag(static_cast<std::int64_t>(r.step - prevStep_)));
+        putVarint(chunk_, r.carId);
+        prevStep_ = r.step;
+
+        SimRecord copy = r;
+        auto& prev = prevBits_[r.carId];
+        const auto fields = fieldsOf(copy);
+        for (std::size_t f = 0; f < recording::kFields; ++f) {
+            // delta wzorców bitowych: wolno zmienne floaty dają małe liczby, a odczyt jest bitowo wierny
+            const auto bits = std::bit_cast<std::uint32_t>(*fields[f]);
+            putVarint(chunk_, zigzag(static_cast<std::int64_t>(bits) - static_cast<std::int64_t>(prev[f])));
+            prev[f] = bits;
+        }
+        lastStep_ = std::max(lastStep_, r.step);
+        if (++chunkRecords_ == recording::kChunkRecords)
+            writeChunk_();
+    }
+
+    void SimRecorder::writeChunk_() {
+        index_.push_back({chunkFirstStep_, static_cast<std::uint64_t>(file_.tellp())});
+        file_.put(kChunkTag);
+        writePod(file_, chunkFirstStep_);
+        writePod(file_, chunkRecords_);
+        writePod(file_, static_cast<std::uint32_t>(chunk_.size()));
+        file_.write(reinterpret_cast<const char*>(chunk_.data()), static_cast<std::streamsize>(chunk_.size()));
+        chunk_.clear();
+        chunkRecords_ = 0;
+    }
+
+    bool SimReplay::open(const std::string& filename) {
+        index_.clear();
+        decoded_.clear();
+        chunk_ = pos_ = 0;
+        file_.close();
+        file_.clear();
+        file_.open(filename, std::ios::binary);
+        if (!file_)
+            return false;
+
+        char magic[4];
+        std::uint32_t version = 0;
+        if (!file_.read(magic, 4) || std::memcmp(magic, kMagic, 4) != 0 || !readPod(file_, version) ||
+            version != recording::kVersion)
+            return false;
+
+        constexpr auto kFooterSize = static_cast<std::streamoff>(2 * sizeof(std::uint64_t) + 4);
+        file_.seekg(-kFooterSize, std::ios::end);
+        std::uint64_t indexOffset = 0;
+        if (!readPod(file_, lastStep_) || !readPod(file_, indexOffset) || !file_.read(magic, 4) ||
+            std::memcmp(magic, kFooterMagic, 4) != 0)
+            return false; // nagranie nie zostało zamknięte
+
+        file_.seekg(static_cast<std::streamoff>(indexOffset));
+        std::uint32_t count = 0;
+        if (!readPod(file_, count))
+            return false;
+        std::vector<recording::IndexEntry> index(count);
+        for (auto& e: index)
+            if (!readPod(file_, e.firstStep) || !readPod(file_, e.offset))
+                return false;
+        index_ = std::move(index);
+        return seek(firstStep());
+    }
+
+    bool SimReplay::loadChunk_(std::size_t idx) {
+        decoded_.clear();
+        pos_ = 0;
+        chunk_ = idx;
+        if (idx >= index_.size())
+            return false;
+
+        file_.clear();
+        file_.seekg(static_cast<std::streamoff>(index_[idx].offset));
+        std::uint64_t first = 0;
+        std::uint32_t count = 0, bytes = 0;
+        if (file_.get() != kChunkTag || !readPod(file_, first) || !readPod(file_, count) || !readPod(file_, bytes))
+            return false;
+        std::vector<std::uint8_t> data(bytes);
+        if (!file_.read(reinterpret_cast<char*>(data.data()), bytes))
+            return false;
+
+        const std::uint8_t* p = data.data();
+        const std::uint8_t* end = p + data.size();
+        std::uint64_t prevStep = 0;
+        std::vector<std::array<std::uint32_t, recording::kFields>> prevBits;
+        decoded_.reserve(count);
+        for (std::uint32_t i = 0; i < count; ++i) {
+            std::uint64_t dStep, car;
+            if (!getVarint(p, end, dStep) || !getVarint(p, end, car))
+                return false;
+            SimRecord r;
+            r.step = prevStep + static_cast<std::uint64_t>(unzigzag(dStep));
+            r.carId = static_cast<std::uint16_t>(car);
+            prevStep = r.step;
+            if (r.carId >= prevBits.size())
+                prevBits.resize(r.carId + 1, {});
+            auto& prev = prevBits[r.carId];
+            const auto fields = fieldsOf(r);
+            for (std::size_t f = 0; f < recording::kFields; ++f) {
+                std::uint64_t d;
+                if (!getVarint(p, end, d))
+                    return false;
+                prev[f] = static_cast<std::uint32_t>(static_cast<std::int64_t>(prev[f]) + unzigzag(d));
+                *fields[f] = std::bit_cast<float>(prev[f]);
+            }
+            decoded_.push_back(r);
+        }
+        return true;
+    }
+
+    bool SimReplay::seek(std::uint64_t step) {
+        if (index_.empty())
+            return false;
+        // ostatni blok zaczynający się przed step - rekordy z tym samym krokiem mogą przechodzić przez granicę
+        auto it = std::lower_bound(index_.begin(), index_.end(), step,
+                                   [](const recording::IndexEntry& e, std::uint64_t st) { return e.firstStep < st; });
+        const std::size_t idx = it == index_.begin() ? 0 : static_cast<std::size_t>(it - index_.begin()) - 1;
+        if (!loadChunk_(idx))
+            return false;
+        for (;;) {
+            while (pos_ < decoded_.size()) {
+                if (decoded_[pos_].step >= step)
+                    return true;
+                ++pos_;
+            }
+            if (!loadChunk_(chunk_ + 1))
+                return false;
+        }
+    }
+
+    bool SimReplay::next(SimRecord& out) {
+        while (pos_ >= decoded_.size())
+            if (!loadChunk_(chunk_ + 1))
+                return false;
+        out = decoded_[pos_++];
+        return true;
+    }
+
+    bool SimReplay::next(std::uint16_t carId, SimRecord& out) {
+        while (next(out))
+            if (out.carId == carId)
+                return true;
+        return false;
+    }
+} // namespace rc::gameplay
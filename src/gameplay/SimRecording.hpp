@@ -0,0 +1,121 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_SIMRECORDING_HPP
+#define ROLLERCOASTERGL_SIMRECORDING_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Car.hpp"
+#include "common/SpscRing.hpp"
+
+namespace rc::gameplay {
+    struct SimRecord {
+        std::uint64_t step = 0;
+        std::uint16_t carId = 0;
+        float s = 0.f, v = 0.f;
+        float aG = 0.f, aExt = 0.f, aAir = 0.f, aRoll = 0.f;
+    };
+
+    // Format pliku (little endian):
+    //   "RCRP", u32 wersja
+    //   bloki: 'K', u64 pierwszy krok, u32 liczba rekordów, u32 bajty, dane
+    //   indeks: u32 liczba bloków, {u64 pierwszy krok, u64 offset bloku}...
+    //   stopka: u64 ostatni krok, u64 offset indeksu, "RCRI"
+    // Rekord w bloku: varint(zigzag(delta kroku)), varint(carId), 6 x varint(zigzag(delta bitów float)).
+    // Delty liczone od poprzedniego rekordu tego samego wagonu w bloku, od zera na początku bloku -
+    // każdy blok jest klatką kluczową i dekoduje się samodzielnie. Kodowanie jest bezstratne.
+    namespace recording {
+        constexpr std::uint32_t kVersion = 1;
+        constexpr std::uint32_t kChunkRecords = 256;
+        constexpr std::size_t kFields = 6;
+
+        struct IndexEntry {
+            std::uint64_t firstStep = 0;
+            std::uint64_t offset = 0;
+        };
+    } // namespace recording
+
+    // Zapis z wątku symulacji: record() tylko wrzuca do pierścienia (bez alokacji i I/O),
+    // kodowanie i zapis robi wątek w tle. Przy przepełnieniu rekord jest gubiony i liczony w dropped().
+    class SimRecorder {
+    public:
+        explicit SimRecorder(std::size_t ringCapacity = 1u << 16);
+        ~SimRecorder() { close(); }
+        SimRecorder(const SimRecorder&) = delete;
+        SimRecorder& operator=(const SimRecorder&) = delete;
+
+        bool open(const std::string& filename);
+        // opróżnia pierścień, dopisuje indeks i stopkę
+        void close();
+        [[nodiscard]] bool isOpen() const { return running_.load(std::memory_order_relaxed); }
+
+        void record(const SimRecord& r) {
+            if (!ring_.push(r))
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+        void record(std::uint16_t carId, const CarSubstep& st) {
+            record({st.step, carId, st.s, st.v, st.aG, st.aExt, st.aAir, st.aRoll});
+        }
+
+        [[nodiscard]] std::uint64_t written() const { return written_.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+    private:
+        void flushLoop_();
+        void drain_();
+        void encode_(const SimRecord& r);
+        void writeChunk_();
+
+        common::SpscRing<SimRecord> ring_;
+        std::ofstream file_;
+        std::thread thread_;
+        std::atomic<bool> running_{false};
+        std::atomic<std::uint64_t> written_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+
+        // stan wątku zapisu
+        std::vector<std::uint8_t> chunk_;
+        std::uint32_t chunkRecords_ = 0;
+        std::uint64_t chunkFirstStep_ = 0;
+        std::uint64_t prevStep_ = 0;
+        std::uint64_t lastStep_ = 0;
+        std::vector<std::array<std::uint32_t, recording::kFields>> prevBits_; // per carId
+        std::vector<recording::IndexEntry> index_;
+    };
+
+    // Odczyt nagrania. seek() szuka bloku binarnie po indeksie (O(log n)) i dekoduje tylko ten blok.
+    class SimReplay {
+    public:
+        bool open(const std::string& filename);
+        [[nodiscard]] bool isOpen() const { return !index_.empty(); }
+
+        [[nodiscard]] std::uint64_t firstStep() const { return index_.empty() ? 0 : index_.front().firstStep; }
+        [[nodiscard]] std::uint64_t lastStep() const { return lastStep_; }
+
+        // ustawia odczyt na pierwszy rekord o kroku >= step
+        bool seek(std::uint64_t step);
+        bool next(SimRecord& out);
+        // następny rekord danego wagonu (pomija pozostałe)
+        bool next(std::uint16_t carId, SimRecord& out);
+
+    private:
+        bool loadChunk_(std::size_t idx);
+
+        std::ifstream file_;
+        std::vector<recording::IndexEntry> index_;
+        std::uint64_t lastStep_ = 0;
+        std::vector<SimRecord> decoded_;
+        std::size_t chunk_ = 0;
+        std::size_t pos_ = 0;
+    };
+} // namespace rc::gameplay
+
+#endif // ROLLERCOASTERGL_SIMRECORDING_HPP
@@ -0,0 +1,124 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "SimulationThread.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+namespace rc::gameplay {
+    double SimulationThread::wallNow_() {
+        using namespace std::chrono;
+        return duration<double>(steady_clock::now().time_since_epoch()).count();
+    }
+
+    CarPose SimulationThread::capture_(double simTime) const {
+        return {car_.getPos(), glm::quat_cast(car_.getOrientation()), car_.s, car_.v, simTime};
+    }
+
+    void SimulationThread::start() {
+        if (running_.exchange(true))
+            return;
+        // pierwsza poza jeszcze przed startem wątku, żeby renderer nie widział zer
+        {
+            std::lock_guard lk(mutex_);
+            if (!track_.frames().empty())
+                car_.update(0.f, track_);
+            const CarPose p = capture_(0.0);
+            const double now = wallNow_();
+            poses_.writeBuffer() = {p, p, now, now};
+            poses_.publish();
+        }
+        thread_ = std::thread(&SimulationThread::run_, this);
+    }
+
+    void SimulationThread::stop() {
+        if (!running_.exchange(false))
+            return;
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    void SimulationThread::run_() {
+        using clock = std::chrono::steady_clock;
+        const auto tick = std::chrono::duration_cast<clock::duration>(std::chrono::duration<double>(kStep));
+
+        double simTime = 0.0;
+        double budget = 0.0; // ile kroków zaległo (ułamek przechodzi na kolejny tick)
+        CarPose last;
+        double lastWall = wallNow_();
+        {
+            std::lock_guard lk(mutex_);
+            last = capture_(simTime);
+        }
+
+        auto next = clock::now();
+        while (running_.load(std::memory_order_relaxed)) {
+            next += tick;
+            std::this_thread::sleep_until(next);
+
+            budget += timeScale();
+            const int steps = std::min(static_cast<int>(budget), kMaxStepsPerTick);
+            budget = std::min(budget - steps, 1.0);
+            if (steps == 0)
+                continue;
+
+            CarPose curr;
+            {
+                std::lock_guard lk(mutex_);
+                const auto t0 = clock::now();
+                for (int i = 0; i < steps; ++i)
+                    if (!step_())
+                        break;
+                const float us = std::chrono::duration<float, std::micro>(clock::now() - t0).count() / steps;
+                const float avg = stepMicros_.load(std::memory_order_relaxed);
+                stepMicros_.store(avg == 0.f ? us : avg + 0.01f * (us - avg), std::memory_order_relaxed);
+                simTime += steps * static_cast<double>(kStep);
+                curr = capture_(simTime);
+            }
+
+            const double wall = wallNow_();
+            poses_.writeBuffer() = {last, curr, lastWall, wall};
+            poses_.publish();
+            last = curr;
+            lastWall = wall;
+
+            // po dłuższym zatrzymaniu (debugger, uśpienie) nie nadrabiamy lawinowo
+            if (clock::now() - next > std::chrono::milliseconds(250))
+                next = clock::now();
+        }
+    }
+
+    bool SimulationThread::step_() {
+        if (!replay_) {
+            car_.update(kStep, track_);
+            return true;
+        }
+        SimRecord r;
+        if (!replay_->next(replayCarId_, r))
+            return false; // koniec nagrania - wagon stoi w ostatnim stanie
+        car_.setState(r.s, r.v);
+        return true;
+    }
+
+    CarPose SimulationThread::interpolatedPose() {
+        poses_.update();
+        const Snapshot& sn = poses_.read();
+
+        const double span = sn.wallCurr - sn.wallPrev;
+        float t = 1.f;
+        if (span > 0.0)
+            t = static_cast<float>(std::clamp((wallNow_() - sn.wallCurr) / span, 0.0, 1.0));
+
+        CarPose out = sn.curr;
+        out.pos = glm::mix(sn.prev.pos, sn.curr.pos, t);
+        glm::quat qa = sn.prev.q;
+        glm::quat qb = sn.curr.q;
+        if (glm::dot(qa, qb) < 0.f)
+            qb = -qb;
+        out.q = glm::normalize(glm::slerp(qa, qb, t));
+        out.simTime = sn.prev.simTime + (sn.curr.simTime - sn.prev.simTime) * t;
+        return out;
+    }
+} // namespace rc::gameplay
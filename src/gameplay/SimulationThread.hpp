@@ -0,0 +1,88 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_SIMULATIONTHREAD_HPP
+#define ROLLERCOASTERGL_SIMULATIONTHREAD_HPP
+
+#include <atomic>
+#include <glm/gtc/quaternion.hpp>
+#include <glm/vec3.hpp>
+#include <mutex>
+#include <thread>
+
+#include "Car.hpp"
+#include "SimRecording.hpp"
+#include "TrackComponent.hpp"
+#include "common/TripleBuffer.hpp"
+
+namespace rc::gameplay {
+    struct CarPose {
+        glm::vec3 pos{0.f};
+        glm::quat q{1.f, 0.f, 0.f, 0.f};
+        float s = 0.f;
+        float v = 0.f;
+        double simTime = 0.0;
+    };
+
+    // Fizyka wagonika na osobnym wątku ze stałym krokiem.
+    // Renderer dostaje pozy przez TripleBuffer i interpoluje między dwoma ostatnimi stanami.
+    // Każda zmiana toru/wagonika z wątku renderu musi iść pod lock().
+    class SimulationThread {
+    public:
+        static constexpr float kStep = 1.0f / 240.0f;
+        static constexpr int kMaxStepsPerTick = 4096; // limit przy timeScale >> 1
+
+        SimulationThread(Car& car, const TrackComponent& track) : car_(car), track_(track) {}
+        ~SimulationThread() { stop(); }
+        SimulationThread(const SimulationThread&) = delete;
+        SimulationThread& operator=(const SimulationThread&) = delete;
+
+        void start();
+        void stop();
+
+        // wstrzymuje krok symulacji na czas edycji toru / parametrów wagonika
+        [[nodiscard]] std::unique_lock<std::mutex> lock() { return std::unique_lock(mutex_); }
+
+        void setTimeScale(float k) { timeScale_.store(k < 0.f ? 0.f : k, std::memory_order_relaxed); }
+        [[nodiscard]] float timeScale() const { return timeScale_.load(std::memory_order_relaxed); }
+
+        // tryb odtwarzania: krok bierze stan wagonu carId z nagrania zamiast całkować.
+        // nullptr wraca do fizyki od odtworzonego stanu. Wołać pod lock(), seek() też.
+        void setReplay(SimReplay* replay, std::uint16_t carId = 0) {
+            replay_ = replay;
+            replayCarId_ = carId;
+        }
+        [[nodiscard]] bool replaying() const { return replay_ != nullptr; }
+
+        // średni koszt jednego kroku (us), z hookami podkroków włącznie - do pomiaru narzutu
+        [[nodiscard]] float stepMicros() const { return stepMicros_.load(std::memory_order_relaxed); }
+
+        // poza do narysowania teraz (tylko wątek renderu)
+        [[nodiscard]] CarPose interpolatedPose();
+
+    private:
+        struct Snapshot {
+            CarPose prev, curr;
+            double wallPrev = 0.0, wallCurr = 0.0;
+        };
+
+        void run_();
+        bool step_();
+        [[nodiscard]] CarPose capture_(double simTime) const;
+        static double wallNow_();
+
+        Car& car_;
+        const TrackComponent& track_;
+        std::thread thread_;
+        std::mutex mutex_;
+        std::atomic<bool> running_{false};
+        std::atomic<float> timeScale_{1.f};
+        std::atomic<float> stepMicros_{0.f};
+        common::TripleBuffer<Snapshot> poses_;
+        SimReplay* replay_ = nullptr; // chroniony mutex_
+        std::uint16_t replayCarId_ = 0;
+    };
+} // namespace rc::gameplay
+
+#endif // ROLLERCOASTERGL_SIMULATIONTHREAD_HPP
@@ -0,0 +1,180 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "Telemetry.hpp"
+
+#include <charconv>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace rc::gameplay {
+    namespace {
+        constexpr std::uint32_t kVersion = 1;
+        constexpr std::size_t kBinSample = 52;
+        constexpr std::size_t kMaxBatch = 1024;
+        constexpr auto kWritePeriod = std::chrono::milliseconds(5);
+
+        template <typename T>
+        void appendNum(std::string& out, T x) {
+            char buf[32];
+            const auto res = std::to_chars(buf, buf + sizeof(buf), x);
+            out.append(buf, res.ptr);
+        }
+
+        template <typename T>
+        char* putRaw(char* p, T x) {
+            std::memcpy(p, &x, sizeof(T));
+            return p + sizeof(T);
+        }
+    } // namespace
+
+    const char* Telemetry::csvHeader() {
+        return "step,frame,s,v,a_g,a_ext,a_air,a_roll,x,y,z,a\n";
+    }
+
+    Telemetry::Telemetry(std::size_t ringCapacity) : ring_(ringCapacity) {
+        batch_.reserve(kMaxBatch);
+    }
+
+    bool Telemetry::start(const TelemetryConfig& cfg) {
+        if (running())
+            return false;
+        cfg_ = cfg;
+        if (cfg_.chunkSamples == 0)
+            cfg_.chunkSamples = 1;
+        if (cfg_.publish && !publisher_.listen(cfg_.port))
+            return false;
+        port_.store(publisher_.port(), std::memory_order_relaxed);
+
+        // próbki sprzed startu (wagonik mógł już pisać) nie należą do tej sesji
+        CarSubstep old;
+        while (ring_.pop(old)) {}
+        chunkIdx_ = 0;
+        chunkCount_ = 0;
+        samples_.store(0, std::memory_order_relaxed);
+        dropped_.store(0, std::memory_order_relaxed);
+
+        running_.store(true, std::memory_order_relaxed);
+        thread_ = std::thread(&Telemetry::writerLoop_, this);
+        return true;
+    }
+
+    void Telemetry::stop() {
+        if (!running_.exchange(false))
+            return;
+        if (thread_.joinable())
+            thread_.join();
+        drain_();
+        closeChunk_();
+        publisher_.close();
+        clients_.store(0, std::memory_order_relaxed);
+        port_.store(0, std::memory_order_relaxed);
+    }
+
+    void Telemetry::writerLoop_() {
+        while (running_.load(std::memory_order_relaxed)) {
+            publisher_.poll(csvHeader());
+            drain_();
+            clients_.store(publisher_.clientCount(), std::memory_order_relaxed);
+            std::this_thread::sleep_for(kWritePeriod);
+        }
+    }
+
+    void Telemetry::drain_() {
+        for (;;) {
+            batch_.clear();
+            CarSubstep st;
+            while (batch_.size() < kMaxBatch && ring_.pop(st))
+                batch_.push_back(st);
+            if (batch_.empty())
+                return;
+            writeBatch_();
+            samples_.fetch_add(batch_.size(), std::memory_order_relaxed);
+        }
+    }
+
+    void Telemetry::writeBatch_() {
+        const bool toFile = !cfg_.filePrefix.empty();
+        const bool csv = cfg_.format == TelemetryFormat::Csv;
+        const bool needText = publisher_.clientCount() > 0 || (toFile && csv);
+
+        std::size_t i = 0;
+        while (i < batch_.size()) {
+            // kawałek pliku nie przekracza chunkSamples
+            std::size_t n = batch_.size() - i;
+            if (toFile) {
+                if (!file_.is_open())
+                    openChunk_();
+                n = std::min<std::size_t>(n, cfg_.chunkSamples - chunkCount_);
+            }
+
+            text_.clear();
+            bin_.clear();
+            for (std::size_t k = i; k < i + n; ++k) {
+                const CarSubstep& st = batch_[k];
+                const float a = st.aG + st.aExt + st.aAir + st.aRoll;
+                if (needText) {
+                    appendNum(text_, st.step);
+                    text_.push_back(',');
+                    appendNum(text_, st.frameIdx);
+                    for (const float x: {st.s, st.v, st.aG, st.aExt, st.aAir, st.aRoll, st.pos.x, st.pos.y, st.pos.z, a}) {
+                        text_.push_back(',');
+                        appendNum(text_, x);
+                    }
+                    text_.push_back('\n');
+                }
+                if (toFile && !csv) {
+                    const std::size_t at = bin_.size();
+                    bin_.resize(at + kBinSample);
+                    char* p = bin_.data() + at;
+                    p = putRaw(p, st.step);
+                    p = putRaw(p, st.frameIdx);
+                    for (const float x: {st.s, st.v, st.aG, st.aExt, st.aAir, st.aRoll, st.pos.x, st.pos.y, st.pos.z, a})
+                        p = putRaw(p, x);
+                }
+            }
+
+            if (toFile) {
+                if (csv)
+                    file_.write(text_.data(), static_cast<std::streamsize>(text_.size()));
+                else
+                    file_.write(bin_.data(), static_cast<std::streamsize>(bin_.size()));
+                chunkCount_ += static_cast<std::uint32_t>(n);
+                if (chunkCount_ >= cfg_.chunkSamples)
+                    closeChunk_();
+            }
+            if (publisher_.clientCount() > 0)
+                publisher_.broadcast(text_.data(), text_.size());
+            i += n;
+        }
+    }
+
+    void Telemetry::openChunk_() {
+        const bool csv = cfg_.format == TelemetryFormat::Csv;
+        char name[32];
+        std::snprintf(name, sizeof(name), "_%05u.%s", chunkIdx_++, csv ? "csv" : "bin");
+        file_.open(cfg_.filePrefix + name, csv ? std::ios::out | std::ios::trunc
+                                               : std::ios::out | std::ios::binary | std::ios::trunc);
+        chunkCount_ = 0;
+        if (csv) {
+            file_ << csvHeader();
+        } else {
+            file_.write("RCTL", 4);
+            const std::uint32_t header[] = {kVersion, 0u}; // liczba próbek uzupełniana przy zamknięciu
+            file_.write(reinterpret_cast<const char*>(header), sizeof(header));
+        }
+    }
+
+    void Telemetry::closeChunk_() {
+        if (!file_.is_open())
+            return;
+        if (cfg_.format == TelemetryFormat::Binary) {
+            file_.seekp(8);
+            file_.write(reinterpret_cast<const char*>(&chunkCount_), sizeof(chunkCount_));
+        }
+        file_.close();
+        chunkCount_ = 0;
+    }
+} // namespace rc::gameplay
@@ -0,0 +1,86 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_TELEMETRY_HPP
+#define ROLLERCOASTERGL_TELEMETRY_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Car.hpp"
+#include "TelemetryPublisher.hpp"
+#include "common/SpscRing.hpp"
+
+namespace rc::gameplay {
+    enum class TelemetryFormat { Csv, Binary };
+
+    struct TelemetryConfig {
+        std::string filePrefix = "telemetry"; // pusty = bez plików
+        TelemetryFormat format = TelemetryFormat::Csv;
+        std::uint32_t chunkSamples = 240 * 60; // próbek na plik (minuta przy 1x)
+        bool publish = false;
+        std::uint16_t port = 7070; // 0 = dowolny wolny
+    };
+
+    // Telemetria wagonika z pętli fizyki. push() to tylko zapis do pierścienia SPSC
+    // (bez blokad, alokacji i I/O); przy pełnym pierścieniu próbka jest gubiona i liczona.
+    // Wątek w tle zapisuje pliki kawałkami (<prefix>_00000.csv/.bin) i rozsyła CSV po TCP.
+    //
+    // Plik binarny: "RCTL", u32 wersja, u32 liczba próbek, potem próbki po 52 B:
+    // u64 krok, u32 ramka, float s, v, aG, aExt, aAir, aRoll, x, y, z, aSum.
+    class Telemetry {
+    public:
+        explicit Telemetry(std::size_t ringCapacity = 1u << 14);
+        ~Telemetry() { stop(); }
+        Telemetry(const Telemetry&) = delete;
+        Telemetry& operator=(const Telemetry&) = delete;
+
+        bool start(const TelemetryConfig& cfg);
+        void stop();
+        [[nodiscard]] bool running() const { return running_.load(std::memory_order_relaxed); }
+
+        void push(const CarSubstep& st) {
+            if (!ring_.push(st))
+                dropped_.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] std::uint64_t samples() const { return samples_.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::size_t clients() const { return clients_.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::uint16_t port() const { return port_.load(std::memory_order_relaxed); }
+
+        static const char* csvHeader();
+
+    private:
+        void writerLoop_();
+        void drain_();
+        void writeBatch_();
+        void openChunk_();
+        void closeChunk_();
+
+        common::SpscRing<CarSubstep> ring_;
+        TelemetryConfig cfg_;
+        std::thread thread_;
+        std::atomic<bool> running_{false};
+        std::atomic<std::uint64_t> samples_{0};
+        std::atomic<std::uint64_t> dropped_{0};
+        std::atomic<std::size_t> clients_{0};
+        std::atomic<std::uint16_t> port_{0};
+
+        // stan wątku zapisu
+        TelemetryPublisher publisher_;
+        std::vector<CarSubstep> batch_;
+        std::string text_;
+        std::vector<char> bin_;
+        std::ofstream file_;
+        std::uint32_t chunkIdx_ = 0;
+        std::uint32_t chunkCount_ = 0;
+    };
+} // namespace rc::gameplay
+
+#endif // ROLLERCOASTERGL_TELEMETRY_HPP
@@ -0,0 +1,146 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "TelemetryPublisher.hpp"
+
+#include <algorithm>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace rc::gameplay {
+    namespace {
+#ifdef _WIN32
+        using socket_t = SOCKET;
+        constexpr int kSendFlags = 0;
+        bool invalid(socket_t s) { return s == INVALID_SOCKET; }
+        void closeSocket(socket_t s) { closesocket(s); }
+        bool setNonBlocking(socket_t s) {
+            u_long on = 1;
+            return ioctlsocket(s, FIONBIO, &on) == 0;
+        }
+        bool wouldBlock() { return WSAGetLastError() == WSAEWOULDBLOCK; }
+        bool netInit() {
+            static const bool ok = [] {
+                WSADATA wsa;
+                return WSAStartup(MAKEWORD(2, 2), &wsa) == 0;
+            }();
+            return ok;
+        }
+#else
+        using socket_t = int;
+#ifdef MSG_NOSIGNAL
+        constexpr int kSendFlags = MSG_NOSIGNAL; // rozłączony klient nie zabija procesu SIGPIPE
+#else
+        constexpr int kSendFlags = 0;
+#endif
+        bool invalid(socket_t s) { return s < 0; }
+        void closeSocket(socket_t s) { ::close(s); }
+        bool setNonBlocking(socket_t s) {
+            const int fl = fcntl(s, F_GETFL, 0);
+            if (fl < 0 || fcntl(s, F_SETFL, fl | O_NONBLOCK) < 0)
+                return false;
+#ifdef SO_NOSIGPIPE
+            int on = 1;
+            setsockopt(s, SOL_SOCKET, SO_NOSIGPIPE, &on, sizeof(on));
+#endif
+            return true;
+        }
+        bool wouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK; }
+        bool netInit() { return true; }
+#endif
+        socket_t native(std::intptr_t s) { return static_cast<socket_t>(s); }
+    } // namespace
+
+    bool TelemetryPublisher::listen(std::uint16_t port) {
+        close();
+        if (!netInit())
+            return false;
+        const socket_t s = ::socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
+        if (invalid(s))
+            return false;
+
+        int on = 1;
+        setsockopt(s, SOL_SOCKET, SO_REUSEADDR, reinterpret_cast<const char*>(&on), sizeof(on));
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK); // tylko lokalnie
+        socklen_t len = sizeof(addr);
+        if (::bind(s, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || ::listen(s, 4) != 0 ||
+            !setNonBlocking(s) || getsockname(s, reinterpret_cast<sockaddr*>(&addr), &len) != 0) {
+            closeSocket(s);
+            return false;
+        }
+        listen_ = static_cast<std::intptr_t>(s);
+        port_ = ntohs(addr.sin_port);
+        return true;
+    }
+
+    void TelemetryPublisher::close() {
+        for (auto& c: clients_)
+            closeSocket(native(c.sock));
+        clients_.clear();
+        if (listen_ != kInvalid)
+            closeSocket(native(listen_));
+        listen_ = kInvalid;
+        port_ = 0;
+    }
+
+    void TelemetryPublisher::poll(const std::string& greeting) {
+        if (listen_ == kInvalid)
+            return;
+        for (;;) {
+            const socket_t c = ::accept(native(listen_), nullptr, nullptr);
+            if (invalid(c))
+                break;
+            if (!setNonBlocking(c)) {
+                closeSocket(c);
+                continue;
+            }
+            clients_.push_back({static_cast<std::intptr_t>(c), greeting});
+            if (!flush_(clients_.back())) {
+                closeSocket(c);
+                clients_.pop_back();
+            }
+        }
+    }
+
+    bool TelemetryPublisher::flush_(Client& c) {
+        std::size_t off = 0;
+        while (off < c.pending.size()) {
+            const int chunk = static_cast<int>(std::min<std::size_t>(c.pending.size() - off, 1u << 16));
+            const auto n = ::send(native(c.sock), c.pending.data() + off, chunk, kSendFlags);
+            if (n > 0) {
+                off += static_cast<std::size_t>(n);
+                continue;
+            }
+            if (n < 0 && wouldBlock())
+                break;
+            return false; // rozłączony
+        }
+        c.pending.erase(0, off);
+        return c.pending.size() <= kMaxPending;
+    }
+
+    void TelemetryPublisher::broadcast(const char* data, std::size_t size) {
+        for (auto& c: clients_) {
+            c.pending.append(data, size);
+            if (!flush_(c)) {
+                closeSocket(native(c.sock));
+                c.sock = kInvalid;
+            }
+        }
+        std::erase_if(clients_, [](const Client& c) { return c.sock == kInvalid; });
+    }
+} // namespace rc::gameplay
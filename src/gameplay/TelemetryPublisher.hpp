@@ -0,0 +1,53 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_TELEMETRYPUBLISHER_HPP
+#define ROLLERCOASTERGL_TELEMETRYPUBLISHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rc::gameplay {
+    // Serwer TCP na 127.0.0.1 rozsyłający tekst do wszystkich podłączonych klientów
+    // (np. `nc 127.0.0.1 7070`). Gniazda nieblokujące; klient, który nie nadąża
+    // (zaległości > kMaxPending), jest rozłączany zamiast spowalniać nadawcę.
+    // Jednowątkowy - wszystko woła wątek zapisu telemetrii.
+    class TelemetryPublisher {
+    public:
+        static constexpr std::size_t kMaxPending = 1u << 20;
+
+        TelemetryPublisher() = default;
+        ~TelemetryPublisher() { close(); }
+        TelemetryPublisher(const TelemetryPublisher&) = delete;
+        TelemetryPublisher& operator=(const TelemetryPublisher&) = delete;
+
+        // port 0 = wybierz wolny (patrz port())
+        bool listen(std::uint16_t port);
+        void close();
+        [[nodiscard]] bool isListening() const { return listen_ != kInvalid; }
+        [[nodiscard]] std::uint16_t port() const { return port_; }
+
+        // przyjmuje nowych klientów; każdy dostaje na start greeting (np. nagłówek CSV)
+        void poll(const std::string& greeting);
+        void broadcast(const char* data, std::size_t size);
+        [[nodiscard]] std::size_t clientCount() const { return clients_.size(); }
+
+    private:
+        static constexpr std::intptr_t kInvalid = -1;
+
+        struct Client {
+            std::intptr_t sock = kInvalid;
+            std::string pending;
+        };
+        bool flush_(Client& c);
+
+        std::intptr_t listen_ = kInvalid;
+        std::uint16_t port_ = 0;
+        std::vector<Client> clients_;
+    };
+} // namespace rc::gameplay
+
+#endif // ROLLERCOASTERGL_TELEMETRYPUBLISHER_HPP
@@ -291,6 +291,15 @@ namespace rc::gameplay {
         dirtyFrames_ = true;
     }
 
+    bool TrackComponent::setStation(std::size_t nodeIdx, float length) {
+        if (nodeIdx >= nodeMeta_.size()) return false;
+        auto& m = nodeMeta_[nodeIdx];
+        m.stationStart = length > 0.f;
+        m.length = std::max(length, 0.f);
+        dirtyMeta_ = true;
+        return true;
+    }
+
     // -------------------- Edge helpers --------------------
     static inline bool nodeToSeg(const math::Spline& s, std::size_t nodeIdx, std::size_t& segOut) {
         const std::size_t segCount = s.segmentCount();
@@ -25,6 +25,10 @@ namespace rc::gameplay {
         [[nodiscard]] const std::vector<common::Frame>& frames() const {
             return frames_;
         }
+        // posortowane, scalone przedziały [a, b] po s (po rebuild)
+        [[nodiscard]] const std::vector<std::pair<float, float>>& stations() const {
+            return stations_;
+        }
 
         void markDirty() {
             dirtySpline_ = dirtyMeta_ = dirtyFrames_ = true;
@@ -54,6 +58,7 @@ namespace rc::gameplay {
         }
         void setClosed(bool v);
         void setNodeRoll(std::size_t i, float roll);
+        bool setStation(std::size_t nodeIdx, float length);
         [[nodiscard]] bool isClosed() const {
             return spline_.isClosed();
         }
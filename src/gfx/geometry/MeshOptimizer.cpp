@@ -0,0 +1,48 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "MeshOptimizer.hpp"
+
+#include <limits>
+
+namespace rc::gfx::geometry {
+    namespace {
+        constexpr std::uint32_t kNone = std::numeric_limits<std::uint32_t>::max();
+    } // namespace
+
+    VertexCacheStats analyzeVertexCache(std::span<const std::uint32_t> indices, std::size_t vertexCount,
+                                        std::uint32_t cacheSize) {
+        VertexCacheStats st;
+        st.triangles = indices.size() / 3;
+        // znacznik czasu wejścia do FIFO; wierzchołek jest w cache'u, gdy wszedł < cacheSize wejść temu
+        std::vector<std::size_t> stamp(vertexCount, 0);
+        std::size_t time = cacheSize + 1; // 0 = nigdy
+        std::vector<std::uint8_t> seen(vertexCount, 0);
+        for (const auto i: indices) {
+            if (!seen[i]) {
+                seen[i] = 1;
+                ++st.vertices;
+            }
+            if (stamp[i] == 0 || time - stamp[i] > cacheSize) {
+                stamp[i] = time++;
+                ++st.transformed;
+            }
+        }
+        return st;
+    }
+
+    std::vector<std::uint32_t> optimizeVertexFetchRemap(std::span<std::uint32_t> indices, std::size_t vertexCount) {
+        std::vector<std::uint32_t> remap(vertexCount, kNone);
+        std::uint32_t next = 0;
+        for (auto& i: indices) {
+            if (remap[i] == kNone)
+                remap[i] = next++;
+            i = remap[i];
+        }
+        for (auto& r: remap)
+            if (r == kNone)
+                r = next++;
+        return remap;
+    }
+} // namespace rc::gfx::geometry
@@ -0,0 +1,60 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_MESHOPTIMIZER_HPP
+#define ROLLERCOASTERGL_MESHOPTIMIZER_HPP
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "RailGeometryBuilder.hpp"
+
+namespace rc::gfx::geometry {
+    // Bez ogólnego przestawiania trójkątów: kolejność pod cache ustalają generatory (paski w RailGeometryBuilder
+    // i Terrain), szablony podpór są za małe, żeby coś zyskać. Inne siatki idą w kolejności generowania.
+
+    // Statystyki cache'u po transformacji (symulacja FIFO, bez GPU). Sumowalne między siatkami.
+    struct VertexCacheStats {
+        std::size_t triangles = 0;
+        std::size_t vertices = 0;    // unikalne wierzchołki użyte przez indeksy
+        std::size_t transformed = 0; // chybienia cache'u = wywołania vertex shadera
+
+        // average cache miss ratio - transformacje na trójkąt (siatka regularna: 0.5 idealnie, 3 najgorzej)
+        [[nodiscard]] float acmr() const { return triangles ? float(transformed) / float(triangles) : 0.f; }
+        // average transform to vertex ratio - 1.0 idealnie
+        [[nodiscard]] float atvr() const { return vertices ? float(transformed) / float(vertices) : 0.f; }
+
+        VertexCacheStats& operator+=(const VertexCacheStats& o) {
+            triangles += o.triangles;
+            vertices += o.vertices;
+            transformed += o.transformed;
+            return *this;
+        }
+    };
+
+    constexpr std::uint32_t kStatsCacheSize = 16;
+
+    [[nodiscard]] VertexCacheStats analyzeVertexCache(std::span<const std::uint32_t> indices, std::size_t vertexCount,
+                                                      std::uint32_t cacheSize = kStatsCacheSize);
+
+    // Numeracja wierzchołków wg pierwszego użycia w indeksach (lokalność pobrań). Przepisuje indeksy,
+    // zwraca remap stary -> nowy; nieużyte wierzchołki lądują na końcu.
+    [[nodiscard]] std::vector<std::uint32_t> optimizeVertexFetchRemap(std::span<std::uint32_t> indices,
+                                                                      std::size_t vertexCount);
+
+    template <class V>
+    void optimizeVertexFetch(std::vector<V>& vertices, std::span<std::uint32_t> indices) {
+        const auto remap = optimizeVertexFetchRemap(indices, vertices.size());
+        std::vector<V> out(vertices.size());
+        for (std::size_t i = 0; i < vertices.size(); ++i)
+            out[remap[i]] = vertices[i];
+        vertices.swap(out);
+    }
+
+    // indeksy mieszczą się w 16 bitach
+    [[nodiscard]] inline bool fitsIndex16(std::size_t vertexCount) { return vertexCount <= 0x10000; }
+} // namespace rc::gfx::geometry
+
+#endif // ROLLERCOASTERGL_MESHOPTIMIZER_HPP
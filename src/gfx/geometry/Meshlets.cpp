@@ -0,0 +1,129 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "Meshlets.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace rc::gfx::geometry {
+    namespace {
+        // stożek rozwarty szerzej niż ~84° od osi nie odrzuci praktycznie niczego
+        constexpr float kMinConeDot = 0.1f;
+        constexpr float kEps = 1e-12f;
+
+        void finishMeshlet(std::span<const glm::vec3> positions, std::span<const std::uint32_t> verts,
+                           std::span<const std::uint32_t> tris, Meshlet& m) {
+            glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+            for (const auto v: verts) {
+                lo = glm::min(lo, positions[v]);
+                hi = glm::max(hi, positions[v]);
+            }
+            m.center = 0.5f * (lo + hi);
+            float r2 = 0.f;
+            for (const auto v: verts) {
+                const glm::vec3 d = positions[v] - m.center;
+                r2 = std::max(r2, glm::dot(d, d));
+            }
+            m.radius = std::sqrt(r2);
+
+            // oś = średnia normalnych trójkątów, rozwarcie = najmniejszy cosinus do osi (dwa przejścia)
+            auto unitNormal = [&](std::size_t t, glm::vec3& n) {
+                n = glm::cross(positions[tris[t + 1]] - positions[tris[t]], positions[tris[t + 2]] - positions[tris[t]]);
+                const float len = glm::length(n);
+                if (len <= kEps)
+                    return false; // zdegenerowany - nie wpływa na widoczność
+                n /= len;
+                return true;
+            };
+            glm::vec3 sum(0.f), n;
+            for (std::size_t t = 0; t + 2 < tris.size(); t += 3)
+                if (unitNormal(t, n))
+                    sum += n;
+            m.coneCutoff = 1.f;
+            const float sumLen = glm::length(sum);
+            if (sumLen <= kEps)
+                return;
+            m.coneAxis = sum / sumLen;
+            float minDot = 1.f;
+            for (std::size_t t = 0; t + 2 < tris.size(); t += 3)
+                if (unitNormal(t, n))
+                    minDot = std::min(minDot, glm::dot(n, m.coneAxis));
+            if (minDot > kMinConeDot)
+                m.coneCutoff = std::sqrt(1.f - minDot * minDot);
+        }
+    } // namespace
+
+    void buildMeshlets(std::span<const glm::vec3> positions, std::span<const std::uint32_t> indices,
+                       std::uint32_t firstIndex, std::vector<Meshlet>& out, std::uint32_t maxVertices,
+                       std::uint32_t maxTriangles) {
+        // zbiór wierzchołków bieżącego meshletu: adresowanie otwarte, >= 2x maxVertices slotów
+        constexpr std::uint32_t kEmpty = std::numeric_limits<std::uint32_t>::max();
+        std::uint32_t bits = 1;
+        while ((1u << bits) < 2 * maxVertices)
+            ++bits;
+        std::vector<std::uint32_t> slots(std::size_t{1} << bits, kEmpty);
+        const std::uint32_t mask = (1u << bits) - 1;
+        auto find = [&](std::uint32_t v) -> std::uint32_t& {
+            std::uint32_t h = (v * 2654435761u) >> (32 - bits);
+            while (slots[h] != kEmpty && slots[h] != v)
+                h = (h + 1) & mask;
+            return slots[h];
+        };
+        std::vector<std::uint32_t> verts; // unikalne wierzchołki bieżącego meshletu (<= maxVertices)
+        verts.reserve(maxVertices);
+        std::size_t start = 0;
+        auto flush = [&](std::size_t end) {
+            if (end == start)
+                return;
+            Meshlet m;
+            m.firstIndex = firstIndex + static_cast<std::uint32_t>(start);
+            m.indexCount = static_cast<std::uint32_t>(end - start);
+            finishMeshlet(positions, verts, indices.subspan(start, end - start), m);
+            out.push_back(m);
+            verts.clear();
+            std::fill(slots.begin(), slots.end(), kEmpty);
+            start = end;
+        };
+        for (std::size_t i = 0; i + 2 < indices.size(); i += 3) {
+            const std::uint32_t a = indices[i], b = indices[i + 1], c = indices[i + 2];
+            const std::uint32_t fresh = (find(a) != a) + (b != a && find(b) != b) + (c != a && c != b && find(c) != c);
+            if (verts.size() + fresh > maxVertices || (i - start) / 3 + 1 > maxTriangles)
+                flush(i);
+            for (const auto v: {a, b, c}) {
+                if (auto& slot = find(v); slot != v) {
+                    slot = v;
+                    verts.push_back(v);
+                }
+            }
+        }
+        flush(indices.size() - indices.size() % 3);
+    }
+
+    void cullMeshlets(std::span<const Meshlet> meshlets, const math::Frustum& frustum, const glm::vec3& camPos,
+                      std::vector<IndexRange>& out, MeshletCullStats& stats) {
+        const std::size_t before = out.size();
+        // scalanie tylko w obrębie tego wywołania - zakresy z różnych list nie muszą być ciągłe
+        bool open = false;
+        for (const auto& m: meshlets) {
+            ++stats.meshlets;
+            if (!frustum.intersectsSphere(m.center, m.radius)) {
+                ++stats.frustumCulled;
+                continue;
+            }
+            const glm::vec3 d = m.center - camPos;
+            if (glm::dot(d, m.coneAxis) >= m.coneCutoff * glm::length(d) + m.radius) {
+                ++stats.backfaceCulled;
+                continue;
+            }
+            if (open && out.back().first + out.back().count == m.firstIndex)
+                out.back().count += m.indexCount;
+            else
+                out.push_back({m.firstIndex, m.indexCount});
+            open = true;
+        }
+        stats.ranges += out.size() - before;
+    }
+} // namespace rc::gfx::geometry
@@ -0,0 +1,79 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_MESHLETS_HPP
+#define ROLLERCOASTERGL_MESHLETS_HPP
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+#include "math/Frustum.hpp"
+
+namespace rc::gfx::geometry {
+    constexpr std::uint32_t kMeshletMaxVertices = 64;
+    constexpr std::uint32_t kMeshletMaxTriangles = 124;
+
+    // Kolejne trójkąty bufora indeksów - meshlet to zakres [firstIndex, firstIndex + indexCount),
+    // więc rysuje się go zwykłym glDrawElements / multi-draw bez przestawiania indeksów.
+    struct Meshlet {
+        std::uint32_t firstIndex = 0, indexCount = 0;
+        glm::vec3 center{0.f};
+        float radius = 0.f;
+        // stożek normalnych: wszystkie trójkąty tyłem, gdy
+        // dot(center - cam, coneAxis) >= coneCutoff * |center - cam| + radius; coneCutoff = 1 - nigdy
+        glm::vec3 coneAxis{0.f, 1.f, 0.f};
+        float coneCutoff = 1.f;
+    };
+
+    struct IndexRange {
+        std::uint32_t first = 0, count = 0;
+    };
+
+    struct MeshletCullStats {
+        std::size_t meshlets = 0;
+        std::size_t frustumCulled = 0;
+        std::size_t backfaceCulled = 0;
+        std::size_t ranges = 0; // zakresy po scaleniu sąsiednich widocznych
+
+        [[nodiscard]] std::size_t visible() const { return meshlets - frustumCulled - backfaceCulled; }
+        MeshletCullStats& operator+=(const MeshletCullStats& o) {
+            meshlets += o.meshlets;
+            frustumCulled += o.frustumCulled;
+            backfaceCulled += o.backfaceCulled;
+            ranges += o.ranges;
+            return *this;
+        }
+    };
+
+    // Zachłanny podział trójkątów w kolejności indeksów (już ułożonej pod cache, więc spójnej
+    // przestrzennie) na meshlety do maxVertices unikalnych wierzchołków i maxTriangles trójkątów.
+    // indices to fragment bufora zaczynający się od firstIndex; meshlety dopisywane do out.
+    void buildMeshlets(std::span<const glm::vec3> positions, std::span<const std::uint32_t> indices,
+                       std::uint32_t firstIndex, std::vector<Meshlet>& out,
+                       std::uint32_t maxVertices = kMeshletMaxVertices,
+                       std::uint32_t maxTriangles = kMeshletMaxTriangles);
+
+    template <class V>
+    void buildMeshlets(const std::vector<V>& vertices, std::span<const std::uint32_t> indices,
+                       std::uint32_t firstIndex, std::vector<Meshlet>& out) {
+        if constexpr (std::is_same_v<V, glm::vec3>) {
+            buildMeshlets(std::span<const glm::vec3>(vertices), indices, firstIndex, out);
+        } else {
+            std::vector<glm::vec3> positions(vertices.size());
+            for (std::size_t i = 0; i < vertices.size(); ++i)
+                positions[i] = vertices[i].pos;
+            buildMeshlets(std::span<const glm::vec3>(positions), indices, firstIndex, out);
+        }
+    }
+
+    // Test ostrosłupa (sfera) i stożka normalnych; widoczne meshlety jako zakresy indeksów dopisane
+    // do out - sąsiednie w buforze scalone w jeden zakres.
+    void cullMeshlets(std::span<const Meshlet> meshlets, const math::Frustum& frustum, const glm::vec3& camPos,
+                      std::vector<IndexRange>& out, MeshletCullStats& stats);
+} // namespace rc::gfx::geometry
+
+#endif // ROLLERCOASTERGL_MESHLETS_HPP
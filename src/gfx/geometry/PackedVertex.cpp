@@ -0,0 +1,147 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "PackedVertex.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <limits>
+
+namespace rc::gfx::geometry {
+    namespace {
+        constexpr float kUnorm16 = 65535.f;
+        constexpr float kSnorm10 = 511.f;
+
+        float signNotZero(float v) { return v >= 0.f ? 1.f : -1.f; }
+
+        std::uint32_t toSnorm10(float v) {
+            const auto q = static_cast<std::int32_t>(std::lround(std::clamp(v, -1.f, 1.f) * kSnorm10));
+            return static_cast<std::uint32_t>(q) & 0x3FFu;
+        }
+        float fromSnorm10(std::uint32_t bits) {
+            const std::int32_t q = (bits & 0x200u) ? static_cast<std::int32_t>(bits) - 0x400 : static_cast<std::int32_t>(bits);
+            return std::max(static_cast<float>(q) / kSnorm10, -1.f); // reguła GL: -512 -> -1
+        }
+        glm::vec3 octDecode(float x, float y) {
+            glm::vec3 n(x, y, 1.f - std::abs(x) - std::abs(y));
+            if (n.z < 0.f) {
+                const float ox = n.x;
+                n.x = (1.f - std::abs(n.y)) * signNotZero(ox);
+                n.y = (1.f - std::abs(ox)) * signNotZero(n.y);
+            }
+            return glm::normalize(n);
+        }
+    } // namespace
+
+    std::uint16_t floatToHalf(float f) {
+        const auto x = std::bit_cast<std::uint32_t>(f);
+        const std::uint32_t sign = (x >> 16) & 0x8000u;
+        const std::uint32_t absx = x & 0x7FFFFFFFu;
+        if (absx >= 0x7F800000u) // inf/NaN
+            return static_cast<std::uint16_t>(sign | 0x7C00u | (absx > 0x7F800000u ? 0x200u : 0u));
+        if (absx >= 0x477FF000u) // poza zakresem po zaokrągleniu -> inf
+            return static_cast<std::uint16_t>(sign | 0x7C00u);
+        if (absx < 0x38800000u) { // subnormalne half
+            const float sub = std::bit_cast<float>(absx) * 16777216.f; // * 2^24
+            return static_cast<std::uint16_t>(sign | static_cast<std::uint32_t>(std::nearbyint(sub)));
+        }
+        // normalne: zaokrąglenie do najbliższej, remis do parzystej
+        const std::uint32_t mant = absx & 0x1FFFu;
+        std::uint32_t h = (absx - 0x38000000u) >> 13;
+        if (mant > 0x1000u || (mant == 0x1000u && (h & 1u)))
+            ++h;
+        return static_cast<std::uint16_t>(sign | h);
+    }
+
+    float halfToFloat(std::uint16_t h) {
+        const std::uint32_t sign = static_cast<std::uint32_t>(h & 0x8000u) << 16;
+        const std::uint32_t exp = (h >> 10) & 0x1Fu;
+        const std::uint32_t mant = h & 0x3FFu;
+        if (exp == 0) {
+            const float v = static_cast<float>(mant) / 16777216.f;
+            return sign ? -v : v;
+        }
+        if (exp == 31)
+            return std::bit_cast<float>(sign | 0x7F800000u | (mant << 13));
+        return std::bit_cast<float>(sign | ((exp + 112u) << 23) | (mant << 13));
+    }
+
+    std::uint32_t packOctNormal(const glm::vec3& n) {
+        const float l1 = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+        float x = l1 > 0.f ? n.x / l1 : 0.f;
+        float y = l1 > 0.f ? n.y / l1 : 0.f;
+        if (n.z < 0.f) {
+            const float ox = x;
+            x = (1.f - std::abs(y)) * signNotZero(ox);
+            y = (1.f - std::abs(ox)) * signNotZero(y);
+        }
+        // z czterech zaokrągleń siatki snorm10 bierzemy najbliższe oryginałowi
+        const float fx = std::floor(x * kSnorm10), fy = std::floor(y * kSnorm10);
+        std::uint32_t best = 0;
+        float bestDot = -2.f;
+        for (int k = 0; k < 4; ++k) {
+            const float qx = std::clamp((fx + float(k & 1)) / kSnorm10, -1.f, 1.f);
+            const float qy = std::clamp((fy + float(k >> 1)) / kSnorm10, -1.f, 1.f);
+            const float d = glm::dot(octDecode(qx, qy), n);
+            if (d > bestDot) {
+                bestDot = d;
+                best = toSnorm10(qx) | (toSnorm10(qy) << 10);
+            }
+        }
+        return best;
+    }
+
+    glm::vec3 unpackOctNormal(std::uint32_t packed) {
+        return octDecode(fromSnorm10(packed & 0x3FFu), fromSnorm10((packed >> 10) & 0x3FFu));
+    }
+
+    QuantBox fitQuantBox(const glm::vec3& lo, const glm::vec3& hi, const glm::vec2& uvLo) {
+        QuantBox b;
+        b.origin = lo;
+        b.extent = glm::max(hi - lo, glm::vec3(1e-6f));
+        b.uvOrigin = glm::floor(uvLo);
+        return b;
+    }
+
+    QuantBox fitQuantBox(std::span<const Vertex> vertices) {
+        if (vertices.empty())
+            return {};
+        glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+        glm::vec2 uvLo(std::numeric_limits<float>::max());
+        for (const auto& v: vertices) {
+            lo = glm::min(lo, v.pos);
+            hi = glm::max(hi, v.pos);
+            uvLo = glm::min(uvLo, v.uv);
+        }
+        return fitQuantBox(lo, hi, uvLo);
+    }
+
+    PackedVertex packVertex(const glm::vec3& pos, const glm::vec3& normal, const glm::vec2& uv, const QuantBox& box) {
+        PackedVertex out{};
+        const glm::vec3 t = glm::clamp((pos - box.origin) / box.extent, glm::vec3(0.f), glm::vec3(1.f));
+        for (int k = 0; k < 3; ++k)
+            out.pos[k] = static_cast<std::uint16_t>(std::lround(t[k] * kUnorm16));
+        out.normal = packOctNormal(normal);
+        out.uv[0] = floatToHalf(uv.x - box.uvOrigin.x);
+        out.uv[1] = floatToHalf(uv.y - box.uvOrigin.y);
+        return out;
+    }
+
+    Vertex unpackVertex(const PackedVertex& v, const QuantBox& box) {
+        const glm::vec3 t(v.pos[0] / kUnorm16, v.pos[1] / kUnorm16, v.pos[2] / kUnorm16);
+        return {box.origin + t * box.extent, unpackOctNormal(v.normal),
+                box.uvOrigin + glm::vec2(halfToFloat(v.uv[0]), halfToFloat(v.uv[1]))};
+    }
+
+    void packVertices(std::span<const Vertex> in, const QuantBox& box, std::vector<PackedVertex>& out) {
+        out.resize(in.size());
+        packVertices(in, box, out.data());
+    }
+
+    void packVertices(std::span<const Vertex> in, const QuantBox& box, PackedVertex* out) {
+        for (std::size_t i = 0; i < in.size(); ++i)
+            out[i] = packVertex(in[i].pos, in[i].normal, in[i].uv, box);
+    }
+} // namespace rc::gfx::geometry
@@ -0,0 +1,59 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_PACKEDVERTEX_HPP
+#define ROLLERCOASTERGL_PACKEDVERTEX_HPP
+
+#include <array>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "RailGeometryBuilder.hpp"
+
+namespace rc::gfx::geometry {
+    enum class VertexFormat : std::uint8_t { Float, Packed };
+
+    // Ramka kwantyzacji: pos = origin + q / 65535 * extent, uv = uvOrigin + half(uv).
+    // uvOrigin jest całkowite (tekstury REPEAT), żeby half trzymał tylko część blisko zera.
+    struct QuantBox {
+        glm::vec3 origin{0.f}, extent{1.f};
+        glm::vec2 uvOrigin{0.f};
+    };
+
+    // 16 B zamiast 32: pozycja unorm16 w ramce, normalna oktaedryczna snorm 10:10 (GL_INT_2_10_10_10_REV,
+    // z i w = 0), UV half. W shaderze: atrybuty 0..2 jak w Vertex, ramka z atrybutów 3..4 (packedQuantRows).
+    struct PackedVertex {
+        std::uint16_t pos[3];
+        std::uint16_t pad;
+        std::uint32_t normal;
+        std::uint16_t uv[2];
+    };
+    static_assert(sizeof(PackedVertex) == 16);
+
+    [[nodiscard]] std::uint16_t floatToHalf(float f);
+    [[nodiscard]] float halfToFloat(std::uint16_t h);
+    [[nodiscard]] std::uint32_t packOctNormal(const glm::vec3& n);
+    [[nodiscard]] glm::vec3 unpackOctNormal(std::uint32_t packed);
+
+    // ramka obejmująca [lo, hi]; uvLo - najmniejsze UV (do całkowitego przesunięcia)
+    [[nodiscard]] QuantBox fitQuantBox(const glm::vec3& lo, const glm::vec3& hi, const glm::vec2& uvLo);
+    [[nodiscard]] QuantBox fitQuantBox(std::span<const Vertex> vertices);
+
+    [[nodiscard]] PackedVertex packVertex(const glm::vec3& pos, const glm::vec3& normal, const glm::vec2& uv,
+                                          const QuantBox& box);
+    [[nodiscard]] Vertex unpackVertex(const PackedVertex& v, const QuantBox& box);
+
+    // ramka jako dwa vec4 dla atrybutów 3 i 4: (origin, uvOrigin.x), (extent, uvOrigin.y)
+    [[nodiscard]] inline std::array<glm::vec4, 2> packedQuantRows(const QuantBox& b) {
+        return {glm::vec4(b.origin, b.uvOrigin.x), glm::vec4(b.extent, b.uvOrigin.y)};
+    }
+
+    void packVertices(std::span<const Vertex> in, const QuantBox& box, std::vector<PackedVertex>& out);
+    // wprost do pamięci docelowej (np. zmapowany bufor GL) - out ma miejsce na in.size() wierzchołków
+    void packVertices(std::span<const Vertex> in, const QuantBox& box, PackedVertex* out);
+} // namespace rc::gfx::geometry
+
+#endif // ROLLERCOASTERGL_PACKEDVERTEX_HPP
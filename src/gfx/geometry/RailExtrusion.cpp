@@ -0,0 +1,81 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "RailExtrusion.hpp"
+
+#include <cmath>
+
+namespace rc::gfx::geometry {
+    namespace {
+        // narożniki quada w kolejności indeksów RailGeometryBuilder: (a, b, c), (b, c, d)
+        constexpr std::uint32_t kCornerRing[6] = {0, 0, 1, 0, 1, 1};
+        constexpr std::uint32_t kCornerSide[6] = {0, 1, 0, 1, 0, 1};
+
+        // p + 2 q.xyz x (q.xyz x p + w p) - jak quatRotate w shaderze
+        glm::vec3 quatRotate(const glm::vec4& q, const glm::vec3& p) {
+            const glm::vec3 u(q);
+            return p + 2.f * glm::cross(u, glm::cross(u, p) + q.w * p);
+        }
+
+        RailStreamFrame toStream(const common::Frame& f, const glm::quat& q) {
+            return {{f.pos, f.s}, {q.x, q.y, q.z, q.w}};
+        }
+    } // namespace
+
+    glm::vec4 railStreamHeader(const RailParams& p) {
+        return {0.5f * p.gauge, p.railRadius, static_cast<float>(p.ringSides), p.texScaleV};
+    }
+
+    bool buildRailStream(std::span<const common::Frame> frames, const RailParams& p,
+                         std::vector<RailStreamFrame>& out) {
+        out.clear();
+        if (frames.size() < 2 || p.ringSides < 3 || p.gauge <= kEps || p.railRadius <= kEps)
+            return false;
+
+        // jak w RailGeometryBuilder::build: przy zamkniętej pętli duplikat pierwszej ramki wypada,
+        // a ostatni ring przed nim bierze N/B z pierwszej ramki
+        const glm::vec3 dp = frames.back().pos - frames.front().pos;
+        const bool closedEff = p.closedLoop && glm::dot(dp, dp) < closeEps2;
+        std::vector<uint32_t> keep = RailGeometryBuilder::selectRings(frames, p, p.lodTolerance);
+        if (closedEff)
+            keep.pop_back();
+        if (keep.size() < 2)
+            return false;
+
+        const auto lastFrame = static_cast<uint32_t>(frames.size()) - 2u;
+        out.reserve(keep.size() + (closedEff ? 1 : 0));
+        for (const auto k: keep) {
+            const auto& f = frames[k];
+            out.push_back(toStream(f, (closedEff && k == lastFrame) ? frames.front().q : f.q));
+        }
+        if (closedEff)
+            out.push_back(out.front());
+        return true;
+    }
+
+    std::uint32_t railStreamVertexCount(std::size_t frameCount, unsigned ringSides) {
+        return frameCount < 2 ? 0u : static_cast<std::uint32_t>((frameCount - 1) * ringSides * 6u);
+    }
+
+    Vertex extrudeRailVertex(std::span<const RailStreamFrame> frames, const glm::vec4& header,
+                             std::uint32_t vertexId, std::uint32_t rail) {
+        const auto sides = static_cast<std::uint32_t>(header.z);
+        const std::uint32_t perSeg = sides * 6u;
+        const std::uint32_t seg = vertexId / perSeg;
+        const std::uint32_t k = vertexId - seg * perSeg;
+        const std::uint32_t quad = k / 6u;
+        const std::uint32_t corner = k - quad * 6u;
+        const RailStreamFrame& f = frames[seg + kCornerRing[corner]];
+        const std::uint32_t side = quad + kCornerSide[corner];
+
+        const glm::vec3 N = quatRotate(f.q, {0, 1, 0});
+        const glm::vec3 B = quatRotate(f.q, {0, 0, 1});
+        const float u = (side == sides) ? 1.f : static_cast<float>(side) / static_cast<float>(sides);
+        const float a = twoPi * u;
+        const glm::vec3 circDir = std::cos(a) * B + std::sin(a) * N;
+        const float railSign = rail == 0 ? 1.f : -1.f;
+        const glm::vec3 pos = glm::vec3(f.posS) + B * (header.x * railSign) + circDir * header.y;
+        return {pos, circDir, {f.posS.w * header.w, u}};
+    }
+} // namespace rc::gfx::geometry
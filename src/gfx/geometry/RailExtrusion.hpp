@@ -0,0 +1,42 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_RAILEXTRUSION_HPP
+#define ROLLERCOASTERGL_RAILEXTRUSION_HPP
+
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "RailGeometryBuilder.hpp"
+
+namespace rc::gfx::geometry {
+    // Ramka strumienia szyn dla track_extrude.vert - dwa teksele RGBA32F (32 B zamiast
+    // 2 * (ringSides + 1) wierzchołków po 32 B na ring).
+    struct RailStreamFrame {
+        glm::vec4 posS; // pozycja, s
+        glm::vec4 q;    // orientacja (x, y, z, w): oś x -> T, y -> N, z -> B
+    };
+    static_assert(sizeof(RailStreamFrame) == 32);
+
+    // Teksel nagłówka strumienia: (gauge/2, promień szyny, liczba boków, texScaleV)
+    [[nodiscard]] glm::vec4 railStreamHeader(const RailParams& p);
+
+    // Ramki ringów wybrane jak w RailGeometryBuilder::build (selectRings z p.lodTolerance).
+    // Zamknięta pętla kończy się kopią pierwszego ringu, więc segment k zawsze łączy ramki k i k+1.
+    // false, gdy z parametrów nie wyjdzie rura (out puste).
+    bool buildRailStream(std::span<const common::Frame> frames, const RailParams& p,
+                         std::vector<RailStreamFrame>& out);
+
+    // Liczba wierzchołków jednej szyny: 6 na quad, bez indeksów
+    [[nodiscard]] std::uint32_t railStreamVertexCount(std::size_t frameCount, unsigned ringSides);
+
+    // Referencja CPU dla shadera: wierzchołek vertexId szyny rail (0 - lewa, +B; 1 - prawa).
+    // Te same działania co track_extrude.vert - do porównania z wyjściem GL (np. llvmpipe).
+    [[nodiscard]] Vertex extrudeRailVertex(std::span<const RailStreamFrame> frames, const glm::vec4& header,
+                                           std::uint32_t vertexId, std::uint32_t rail);
+} // namespace rc::gfx::geometry
+
+#endif // ROLLERCOASTERGL_RAILEXTRUSION_HPP
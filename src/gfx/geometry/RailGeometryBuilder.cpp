@@ -3,11 +3,79 @@
 //
 #include "RailGeometryBuilder.hpp"
 
+#include <algorithm>
 #include <cassert>
 #include <glm/geometric.hpp>
 #include <glm/trigonometric.hpp>
 
+#include "common/ThreadPool.hpp"
+
 namespace rc::gfx::geometry {
+    namespace {
+        constexpr std::size_t kMinRingsPerChunk = 2048;
+        constexpr uint32_t kMaxRingGap = 1024; // limit ramek między ringami (długie proste)
+        constexpr uint32_t kQuadsPerStripe = 7;    // 2 * (7 + 1) wierzchołków mieści się w 16-wpisowym FIFO
+    } // namespace
+
+    std::vector<uint32_t> RailGeometryBuilder::selectRings(std::span<const common::Frame> frames,
+                                                           const RailParams& p, float tol) {
+        const auto n = static_cast<uint32_t>(frames.size());
+        std::vector<uint32_t> keep;
+        if (n == 0)
+            return keep;
+        keep.push_back(0);
+        const uint32_t last = n - 1u;
+        if (tol <= 0.f) {
+            for (uint32_t i = 1; i < n; ++i)
+                keep.push_back(i);
+            return keep;
+        }
+
+        const float wB = 0.5f * p.gauge + p.railRadius;
+        const float wN = p.railRadius;
+        // czy ringi a..c można zastąpić interpolacją między a i c
+        auto fits = [&](uint32_t a, uint32_t c) {
+            const auto& A = frames[a];
+            const auto& C = frames[c];
+            const float span = std::max(C.s - A.s, kEps);
+            for (uint32_t k = a + 1; k < c; ++k) {
+                const auto& K = frames[k];
+                const float t = (K.s - A.s) / span;
+                const float e = glm::length(glm::mix(A.pos, C.pos, t) - K.pos) +
+                                wB * glm::length(glm::mix(A.B, C.B, t) - K.B) +
+                                wN * glm::length(glm::mix(A.N, C.N, t) - K.N);
+                if (e > tol)
+                    return false;
+            }
+            return true;
+        };
+
+        uint32_t a = 0;
+        while (a < last) {
+            const uint32_t cap = std::min(last, a + kMaxRingGap);
+            // rośnij wykładniczo póki pasuje, potem bisekcja między ostatnim pasującym a pierwszym złym
+            uint32_t good = a + 1u, bad = cap + 1u;
+            for (uint32_t step = 2; good < cap; step *= 2) {
+                const uint32_t c = std::min(cap, a + step);
+                if (!fits(a, c)) {
+                    bad = c;
+                    break;
+                }
+                good = c;
+            }
+            while (bad - good > 1u) {
+                const uint32_t mid = good + (bad - good) / 2u;
+                if (fits(a, mid))
+                    good = mid;
+                else
+                    bad = mid;
+            }
+            keep.push_back(good);
+            a = good;
+        }
+        return keep;
+    }
+
     bool RailGeometryBuilder::build(const RailParams& p) {
         mesh_.vertices.clear();
         mesh_.indices.clear();
@@ -21,14 +89,21 @@ namespace rc::gfx::geometry {
         const bool hasDuplicateEnd = (glm::dot(dp, dp) < closeEps2);
         const bool closedEff = closed && hasDuplicateEnd;
 
+        // Ramki z ringami; przy zamkniętej pętli ostatnia (duplikat pierwszej) wypada, a segment zawija do 0
+        std::vector<uint32_t> keep = selectRings(frames_, p, p.lodTolerance);
+        if (closedEff)
+            keep.pop_back();
+
         // Ile ringów  i ile segmentów
-        uint32_t ringsTotal =
-                closedEff ? static_cast<uint32_t>(frames_.size()) - 1u : static_cast<uint32_t>(frames_.size());
+        const auto ringsTotal = static_cast<uint32_t>(keep.size());
+        if (ringsTotal < 2)
+            return false;
         uint32_t segs = closedEff ? ringsTotal : (ringsTotal - 1u);
 
-        auto nextFrame = [ringsTotal, closedEff](uint32_t i) {
+        auto nextRing = [ringsTotal, closedEff](uint32_t i) {
             return (closedEff && (i + 1u == ringsTotal)) ? 0u : (i + 1u);
         };
+        const auto lastFrame = static_cast<uint32_t>(frames_.size()) - 2u; // ostatnia przed duplikatem
 
         const uint32_t ring = p.ringSides + 1u; // +1 bo duplikuje pierwszy profil, by zamknąć okrąg
         constexpr uint32_t rails = 2u;
@@ -40,74 +115,91 @@ namespace rc::gfx::geometry {
         mesh_.vertices.resize(vertsTotal);
         mesh_.indices.resize(trisTotal * 3u);
 
-        for (uint32_t i = 0; i < ringsTotal; ++i) {
-            rings_(i, frames_[i].pos, frames_[i].N, frames_[i].B, p, ringsTotal, closedEff);
+        // profil okręgu raz na build zamiast cos/sin dla każdego wierzchołka
+        profile_.resize(ring);
+        for (uint32_t i = 0; i < ring; ++i) {
+            const float u = (i == ring - 1) ? 1.0f : static_cast<float>(i) / static_cast<float>(ring - 1);
+            profile_[i] = {glm::cos(twoPi * u), glm::sin(twoPi * u)};
         }
 
-        auto vidx = [ring](uint32_t frameIdx, uint32_t rail, uint32_t r) {
-            return frameIdx * (ring * 2u) + (rail ? ring + r : r);
+        // ringi i paski quadów są niezależne - kawałki na puli wątków, każdy pisze swój zakres
+        auto& pool = common::ThreadPool::shared();
+        pool.parallelFor(ringsTotal, kMinRingsPerChunk, [&](size_t begin, size_t end, size_t) {
+            for (auto i = static_cast<uint32_t>(begin); i < end; ++i)
+                rings_(i, keep[i], p, closedEff && keep[i] == lastFrame);
+        });
+
+        auto vidx = [ring](uint32_t ringIdx, uint32_t rail, uint32_t r) {
+            return ringIdx * (ring * 2u) + (rail ? ring + r : r);
         };
 
-        size_t w = 0;
-        for (uint32_t i = 0; i < segs; ++i) {
-            const uint32_t j = nextFrame(i);
-            for (uint32_t r = 0; r < ring - 1u; ++r) {
-                const uint32_t rNext = r + 1u;
-
-                // lewa
-                uint32_t a = vidx(i, 0, r);
-                uint32_t b = vidx(i, 0, rNext);
-                uint32_t c = vidx(j, 0, r);
-                uint32_t d = vidx(j, 0, rNext);
-                mesh_.indices[w++] = a;
-                mesh_.indices[w++] = b;
-                mesh_.indices[w++] = c;
-                mesh_.indices[w++] = b;
-                mesh_.indices[w++] = c;
-                mesh_.indices[w++] = d;
-
-                // prawa
-                a = vidx(i, 1, r);
-                b = vidx(i, 1, rNext);
-                c = vidx(j, 1, r);
-                d = vidx(j, 1, rNext);
-                mesh_.indices[w++] = a;
-                mesh_.indices[w++] = b;
-                mesh_.indices[w++] = c;
-                mesh_.indices[w++] = b;
-                mesh_.indices[w++] = c;
-                mesh_.indices[w++] = d;
+        // Paski quadów po kilka boków wzdłuż całego kawałka segmentów: z poprzedniego ringu paska
+        // zostaje w cache'u po transformacji (~16 wpisów) tyle, że każdy wierzchołek liczy się raz.
+        // Kolejność rzędami (cały obwód obu szyn na segment) nie mieści się w cache'u - ACMR ~1.06 vs ~0.6.
+        const uint32_t stripes = (quadsPerRailPerSeg + kQuadsPerStripe - 1u) / kQuadsPerStripe;
+        const size_t indicesPerSeg = quadsPerRailPerSeg * rails * 6u;
+        pool.parallelFor(segs, kMinRingsPerChunk, [&](size_t begin, size_t end, size_t) {
+            size_t w = begin * indicesPerSeg;
+            for (uint32_t rail = 0; rail < rails; ++rail) {
+                for (uint32_t st = 0; st < stripes; ++st) {
+                    const uint32_t r0 = quadsPerRailPerSeg * st / stripes;
+                    const uint32_t r1 = quadsPerRailPerSeg * (st + 1u) / stripes;
+                    for (auto i = static_cast<uint32_t>(begin); i < end; ++i) {
+                        const uint32_t j = nextRing(i);
+                        for (uint32_t r = r0; r < r1; ++r) {
+                            const uint32_t a = vidx(i, rail, r);
+                            const uint32_t b = vidx(i, rail, r + 1u);
+                            const uint32_t c = vidx(j, rail, r);
+                            const uint32_t d = vidx(j, rail, r + 1u);
+                            mesh_.indices[w++] = a;
+                            mesh_.indices[w++] = b;
+                            mesh_.indices[w++] = c;
+                            mesh_.indices[w++] = b;
+                            mesh_.indices[w++] = c;
+                            mesh_.indices[w++] = d;
+                        }
+                    }
+                }
             }
-        }
-        assert(w == mesh_.indices.size());
+            assert(w == end * indicesPerSeg);
+        });
         return true;
     }
 
 
-    void RailGeometryBuilder::rings_(uint32_t frameIdx, const glm::vec3& centerPos, const glm::vec3& N,
-                                     const glm::vec3& B, const RailParams& params, const uint32_t ringsTotal,
-                                     const bool closedEff) {
+    void RailGeometryBuilder::rings_(uint32_t ringIdx, uint32_t frameIdx, const RailParams& params,
+                                     const bool useStartNB) {
 
         const auto ring = params.ringSides + 1;
         const auto gauge = params.gauge;
         const auto radius = params.railRadius;
-        const bool useStartNB = params.closedLoop && (frameIdx + 1 == ringsTotal) && closedEff;
+        const auto& f = frames_[frameIdx];
 
-        const glm::vec3 centerL = centerPos + B * gauge * 0.5f;
-        const glm::vec3 centerR = centerPos - B * gauge * 0.5f;
+        const glm::vec3 centerL = f.pos + f.B * gauge * 0.5f;
+        const glm::vec3 centerR = f.pos - f.B * gauge * 0.5f;
 
-        size_t base = frameIdx * ring * 2;
-        const glm::vec3& n = useStartNB ? frames_.front().N : N;
-        const glm::vec3& b = useStartNB ? frames_.front().B : B;
+        size_t base = ringIdx * ring * 2;
+        const glm::vec3& n = useStartNB ? frames_.front().N : f.N;
+        const glm::vec3& b = useStartNB ? frames_.front().B : f.B;
+        const float v = f.s * params.texScaleV;
         for (size_t i = 0; i < ring; ++i) {
             float u = (i == ring - 1) ? 1.0f : static_cast<float>(i) / static_cast<float>(ring - 1);
-            float angle = twoPi * u;
-            glm::vec3 circDir = glm::cos(angle) * b + glm::sin(angle) * n;
+            glm::vec3 circDir = profile_[i].x * b + profile_[i].y * n;
             glm::vec3 offset = circDir * radius;
-            const float v = frames_[frameIdx].s * params.texScaleV;
 
             mesh_.vertices[i + base] = {centerL + offset, circDir, {v, u}};
             mesh_.vertices[i + base + ring] = {centerR + offset, circDir, {v, u}};
         }
     }
+
+    std::vector<MeshOut> buildRailLods(std::span<const common::Frame> frames, const RailParams& p,
+                                       std::span<const float> tolerances) {
+        std::vector<MeshOut> lods(tolerances.size());
+        RailParams lp = p;
+        for (size_t l = 0; l < tolerances.size(); ++l) {
+            lp.lodTolerance = tolerances[l];
+            RailGeometryBuilder(frames, lods[l]).build(lp);
+        }
+        return lods;
+    }
 } // namespace rc::gfx::geometry
@@ -22,6 +22,8 @@ namespace rc::gfx::geometry {
         unsigned ringSides = 10;
         bool closedLoop = false;
         float texScaleV = 1.0f;
+        // maks. odchyłka powierzchni rury [m] przy pomijaniu ringów; 0 = ring na każdą ramkę
+        float lodTolerance = 0.01f;
     };
 
     struct Vertex {
@@ -40,6 +42,12 @@ namespace rc::gfx::geometry {
 
         bool build(const RailParams& p);
 
+        // Indeksy ramek, na których zostają ringi (pierwsza i ostatnia zawsze). Ring jest pomijany,
+        // gdy liniowa interpolacja sąsiednich zostawionych ringów odbiega od niego o mniej niż tol:
+        // |dP| + (gauge/2 + r)|dB| + r|dN| - na prostych zostają pojedyncze ringi, w łukach gęsto.
+        [[nodiscard]] static std::vector<uint32_t> selectRings(std::span<const common::Frame> frames,
+                                                               const RailParams& p, float tol);
+
         [[nodiscard]] std::span<const Vertex> vertices() const {
             return mesh_.vertices;
         }
@@ -50,9 +58,15 @@ namespace rc::gfx::geometry {
     private:
         std::span<const common::Frame> frames_;
         MeshOut& mesh_;
-        void rings_(uint32_t frameIdx, const glm::vec3& centerPos, const glm::vec3& N, const glm::vec3& B,
-                    const RailParams& params, uint32_t ringsTotal, bool closedEff);
+        std::vector<glm::vec2> profile_; // (cos, sin) na okręgu jednostkowym, ringSides + 1 punktów
+        void rings_(uint32_t ringIdx, uint32_t frameIdx, const RailParams& params, bool useStartNB);
     };
+
+    // Dyskretne poziomy LOD szyn dla zakresu ramek (np. kawałka toru), tolerancje rosnąco.
+    // Poziom 0 używa tolerances[0]; pierwsza i ostatnia ramka zakresu zostają w każdym poziomie,
+    // więc sąsiednie kawałki na różnych poziomach stykają się bez szczelin.
+    [[nodiscard]] std::vector<MeshOut> buildRailLods(std::span<const common::Frame> frames, const RailParams& p,
+                                                     std::span<const float> tolerances);
 } // namespace rc::gfx::geometry
 
 
@@ -0,0 +1,74 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "SupportInstances.hpp"
+
+#include "SupportGeometryBuilder.hpp"
+
+namespace rc::gfx::geometry {
+    namespace {
+        // baza poprzeczna do osi T - ta sama co w SupportGeometryBuilder
+        void crossBasis(const glm::vec3& T, glm::vec3& X, glm::vec3& Y) {
+            const glm::vec3 up(0, 1, 0);
+            X = glm::normalize((std::abs(glm::dot(T, up)) < 0.99f) ? glm::cross(up, T)
+                                                                   : glm::cross(glm::vec3(1, 0, 0), T));
+            Y = glm::normalize(glm::cross(T, X));
+        }
+
+        // kolumny macierzy (cx, cy, cz) i przesunięcie t -> wiersze
+        InstanceXform fromColumns(const glm::vec3& cx, const glm::vec3& cy, const glm::vec3& cz, const glm::vec3& t) {
+            return {{cx.x, cy.x, cz.x, t.x}, {cx.y, cy.y, cz.y, t.y}, {cx.z, cy.z, cz.z, t.z}};
+        }
+    } // namespace
+
+    void SupportInstanceBuilder::addBeamBox(const glm::vec3& A, const glm::vec3& B, float thick, float height) {
+        const glm::vec3 dir = B - A;
+        const float L = glm::length(dir);
+        if (L < 1e-6f) return;
+        const glm::vec3 T = dir / L;
+        glm::vec3 X, Y;
+        crossBasis(T, X, Y);
+        out_.ties.push_back(fromColumns(X * thick, Y * height, T * L, 0.5f * (A + B)));
+    }
+
+    void SupportInstanceBuilder::addSupportCylinder(const glm::vec3& top, const glm::vec3& bottom, float radius) {
+        const glm::vec3 axis = bottom - top;
+        const float L = glm::length(axis);
+        if (L < 1e-5f) return;
+        const glm::vec3 T = axis / L;
+        glm::vec3 X, Y;
+        crossBasis(T, X, Y);
+        out_.columns.push_back(fromColumns(X * radius, Y * radius, T * L, top));
+    }
+
+    void SupportInstanceBuilder::addFootDisk(const glm::vec3& center, float r) {
+        out_.feet.push_back(fromColumns({r, 0, 0}, {0, 1, 0}, {0, 0, r}, center));
+    }
+
+    MeshOut SupportInstanceBuilder::tieTemplate() {
+        MeshOut m;
+        SupportGeometryBuilder(m).addBeamBox({0, 0, -0.5f}, {0, 0, 0.5f}, 1.f, 1.f);
+        return m;
+    }
+
+    MeshOut SupportInstanceBuilder::columnTemplate(int sides) {
+        MeshOut m;
+        SupportGeometryBuilder(m).addSupportCylinder({0, 0, 0}, {0, 0, 1}, 1.f, sides);
+        return m;
+    }
+
+    MeshOut SupportInstanceBuilder::footTemplate(int sides) {
+        MeshOut m;
+        SupportGeometryBuilder(m).addFootDisk({0, 0, 0}, 1.f, sides);
+        return m;
+    }
+
+    Vertex SupportInstanceBuilder::apply(const InstanceXform& x, const Vertex& v) {
+        const glm::vec4 p(v.pos, 1.f);
+        const glm::vec3 n = {glm::dot(glm::vec3(x.r0), v.normal), glm::dot(glm::vec3(x.r1), v.normal),
+                             glm::dot(glm::vec3(x.r2), v.normal)};
+        // szablony mają normalne osiowe albo promieniowe przy równej skali promienia - wystarczy normalize
+        return {{glm::dot(x.r0, p), glm::dot(x.r1, p), glm::dot(x.r2, p)}, glm::normalize(n), v.uv};
+    }
+} // namespace rc::gfx::geometry
@@ -0,0 +1,59 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_SUPPORTINSTANCES_HPP
+#define ROLLERCOASTERGL_SUPPORTINSTANCES_HPP
+
+#include <glm/glm.hpp>
+#include <vector>
+
+#include "RailGeometryBuilder.hpp"
+
+namespace rc::gfx::geometry {
+    // Przekształcenie afiniczne instancji w wierszach: world = (dot(r0, p), dot(r1, p), dot(r2, p)), p = (x, y, z, 1)
+    struct InstanceXform {
+        glm::vec4 r0, r1, r2;
+    };
+
+    struct SupportInstances {
+        std::vector<InstanceXform> ties, columns, feet;
+
+        void clear() {
+            ties.clear();
+            columns.clear();
+            feet.clear();
+        }
+        void append(const SupportInstances& o) {
+            ties.insert(ties.end(), o.ties.begin(), o.ties.end());
+            columns.insert(columns.end(), o.columns.begin(), o.columns.end());
+            feet.insert(feet.end(), o.feet.begin(), o.feet.end());
+        }
+    };
+
+    // Poprzeczki, słupy i stopki jako instancje wspólnych szablonów zamiast pełnej geometrii.
+    // Szablony to te same bryły, które buduje SupportGeometryBuilder, w układzie jednostkowym -
+    // instancja daje identyczne wierzchołki jak wersja wypalona w siatkę.
+    class SupportInstanceBuilder {
+    public:
+        explicit SupportInstanceBuilder(SupportInstances& out) : out_(out) {}
+
+        // jak SupportGeometryBuilder::addBeamBox / addSupportCylinder / addFootDisk
+        void addBeamBox(const glm::vec3& A, const glm::vec3& B, float thick, float height);
+        void addSupportCylinder(const glm::vec3& top, const glm::vec3& bottom, float radius);
+        void addFootDisk(const glm::vec3& center, float r);
+
+        // szablony: sześcian jednostkowy wzdłuż z, cylinder r=1 od z=0 do z=1, dysk R=1 w XZ
+        [[nodiscard]] static MeshOut tieTemplate();
+        [[nodiscard]] static MeshOut columnTemplate(int sides);
+        [[nodiscard]] static MeshOut footTemplate(int sides);
+
+        // zastosowanie instancji do szablonu (referencja CPU, testy)
+        [[nodiscard]] static Vertex apply(const InstanceXform& x, const Vertex& v);
+
+    private:
+        SupportInstances& out_;
+    };
+} // namespace rc::gfx::geometry
+
+#endif // ROLLERCOASTERGL_SUPPORTINSTANCES_HPP
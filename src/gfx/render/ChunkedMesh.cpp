@@ -0,0 +1,300 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "ChunkedMesh.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+
+#include "VertexLayout.hpp"
+#include "gfx/geometry/MeshOptimizer.hpp"
+
+namespace rc::gfx::render {
+    namespace {
+        // zapas na wzrost kawałka po edycji bez przebudowy całego bufora
+        std::uint32_t withSlack(std::size_t n) {
+            return static_cast<std::uint32_t>(n + n / 4 + 64);
+        }
+        std::uint32_t indexSizeFor(const geometry::MeshOut& m) {
+            return geometry::fitsIndex16(m.vertices.size()) ? 2u : 4u;
+        }
+        std::size_t indexBytes(const geometry::MeshOut& m) {
+            return m.indices.size() * indexSizeFor(m);
+        }
+        constexpr std::size_t kQuantRowsBytes = sizeof(std::array<glm::vec4, 2>);
+        constexpr GLbitfield kMapFlags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+        constexpr GLuint64 kFenceTimeoutNs = 100'000'000;
+
+        // trwałe mapowanie wymaga glBufferStorage (GL 4.4)
+        bool persistentMapping() {
+            return GLAD_GL_VERSION_4_4 != 0;
+        }
+    } // namespace
+
+    void ChunkedMesh::setFormat(geometry::VertexFormat format) {
+        if (format == format_)
+            return;
+        release();
+        format_ = format;
+    }
+
+    std::size_t ChunkedMesh::vertexSize_() const {
+        return format_ == geometry::VertexFormat::Packed ? sizeof(geometry::PackedVertex) : sizeof(geometry::Vertex);
+    }
+
+    ChunkedMesh::SyncStats ChunkedMesh::sync(std::span<const geometry::MeshOut* const> chunks,
+                                             std::span<const std::uint8_t> dirty) {
+        if (!vao_ || chunks.size() != ranges_.size())
+            return fullUpload_(chunks, dirty);
+        for (std::size_t c = 0; c < chunks.size(); ++c)
+            if (dirty[c] && (chunks[c]->vertices.size() > ranges_[c].vCap || indexBytes(*chunks[c]) > ranges_[c].iByteCap))
+                return fullUpload_(chunks, dirty);
+
+        SyncStats st;
+        if (buf_.vMap)
+            waitForGpu_();
+        glBindVertexArray(vao_); // EBO wiąże się ze stanem VAO
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf_.ebo);
+        for (std::size_t c = 0; c < chunks.size(); ++c) {
+            if (!dirty[c])
+                continue;
+            const auto& m = *chunks[c];
+            const auto vBytes = uploadVertices_(m, c);
+            const auto iBytes = uploadIndices_(m, ranges_[c]);
+            ++st.chunksUploaded;
+            st.bytesUploaded += vBytes + iBytes;
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        return st;
+    }
+
+    ChunkedMesh::SyncStats ChunkedMesh::fullUpload_(std::span<const geometry::MeshOut* const> chunks,
+                                                    std::span<const std::uint8_t> dirty) {
+        // stare bufory zostają do skopiowania niezmienionych kawałków
+        const std::vector<Range> old = std::move(ranges_);
+        Buffers oldBuf = buf_;
+        buf_ = {};
+        if (vao_) glDeleteVertexArrays(1, &vao_);
+        vao_ = 0;
+
+        const bool packed = format_ == geometry::VertexFormat::Packed;
+        const std::size_t vSize = vertexSize_();
+        ranges_.assign(chunks.size(), {});
+        std::vector<std::uint8_t> carried(chunks.size(), 0);
+        std::uint32_t vTotal = 0, iTotal = 0;
+        for (std::size_t c = 0; c < chunks.size(); ++c) {
+            carried[c] = oldBuf.vbo && c < old.size() && !dirty[c];
+            const std::size_t vCount = carried[c] ? old[c].vCount : chunks[c]->vertices.size();
+            const std::size_t iBytes = carried[c] ? old[c].iBytes : indexBytes(*chunks[c]);
+            auto& r = ranges_[c];
+            r.vOff = vTotal;
+            r.vCap = withSlack(vCount);
+            // zakresy indeksów wyrównane do 4 B, żeby kawałek mógł zmienić szerokość bez przesuwania
+            r.iByteOff = iTotal;
+            r.iByteCap = (withSlack(iBytes) + 3u) & ~3u;
+            vTotal += r.vCap;
+            iTotal += r.iByteCap;
+        }
+        const std::size_t qTotal = packed ? chunks.size() * kQuantRowsBytes : 0;
+        buf_ = createBuffers_(vTotal * vSize, iTotal, qTotal);
+        gpuBytes_ = vTotal * vSize + iTotal + qTotal;
+
+        glGenVertexArrays(1, &vao_);
+        if (!cmdBuf_)
+            glGenBuffers(1, &cmdBuf_);
+        glBindVertexArray(vao_);
+        if (packed) {
+            glBindBuffer(GL_ARRAY_BUFFER, buf_.quantVbo);
+            setupQuantAttribs(); // ramka kawałka - instancja = kawałek przez base instance
+        }
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, buf_.ebo);
+
+        SyncStats st;
+        st.fullUpload = true;
+        auto copyRange = [](GLuint from, GLuint to, std::size_t src, std::size_t dst, std::size_t bytes) {
+            if (!bytes)
+                return;
+            glBindBuffer(GL_COPY_READ_BUFFER, from);
+            glBindBuffer(GL_COPY_WRITE_BUFFER, to);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(src),
+                                static_cast<GLintptr>(dst), static_cast<GLsizeiptr>(bytes));
+        };
+        for (std::size_t c = 0; c < chunks.size(); ++c) {
+            auto& r = ranges_[c];
+            if (carried[c]) {
+                // niezmieniony kawałek - kopia GPU -> GPU, bez danych z CPU
+                const Range& o = old[c];
+                copyRange(oldBuf.vbo, buf_.vbo, o.vOff * vSize, r.vOff * vSize, o.vCount * vSize);
+                copyRange(oldBuf.ebo, buf_.ebo, o.iByteOff, r.iByteOff, o.iBytes);
+                if (packed)
+                    copyRange(oldBuf.quantVbo, buf_.quantVbo, c * kQuantRowsBytes, c * kQuantRowsBytes,
+                              kQuantRowsBytes);
+                r.vCount = o.vCount;
+                r.iBytes = o.iBytes;
+                r.indexSize = o.indexSize;
+                continue;
+            }
+            const auto& m = *chunks[c];
+            const auto vBytes = uploadVertices_(m, c);
+            const auto iBytes = uploadIndices_(m, r);
+            ++st.chunksUploaded;
+            st.bytesUploaded += vBytes + iBytes;
+        }
+        deleteBuffers_(oldBuf); // GL usunie je po wykonaniu kopii
+
+        glBindBuffer(GL_ARRAY_BUFFER, buf_.vbo);
+        setupVertexAttribs(format_);
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        glBindBuffer(GL_COPY_READ_BUFFER, 0);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return st;
+    }
+
+    ChunkedMesh::Buffers ChunkedMesh::createBuffers_(std::size_t vBytes, std::size_t iBytes, std::size_t qBytes) {
+        Buffers b;
+        auto create = [](GLuint& id, std::size_t bytes, unsigned char*& map) {
+            glGenBuffers(1, &id);
+            // przez COPY_WRITE - nie rusza EBO związanego z VAO
+            glBindBuffer(GL_COPY_WRITE_BUFFER, id);
+            const auto size = static_cast<GLsizeiptr>(std::max<std::size_t>(bytes, 4));
+            if (persistentMapping()) {
+                glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, kMapFlags);
+                map = static_cast<unsigned char*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, kMapFlags));
+            } else {
+                glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+            }
+        };
+        create(b.vbo, vBytes, b.vMap);
+        create(b.ebo, iBytes, b.iMap);
+        if (qBytes)
+            create(b.quantVbo, qBytes, b.qMap);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+        return b;
+    }
+
+    void ChunkedMesh::deleteBuffers_(Buffers& b) {
+        // usunięcie bufora zdejmuje też jego mapowanie
+        if (b.quantVbo) glDeleteBuffers(1, &b.quantVbo);
+        if (b.ebo) glDeleteBuffers(1, &b.ebo);
+        if (b.vbo) glDeleteBuffers(1, &b.vbo);
+        b = {};
+    }
+
+    void ChunkedMesh::waitForGpu_() {
+        if (!fence_)
+            return;
+        while (glClientWaitSync(fence_, GL_SYNC_FLUSH_COMMANDS_BIT, kFenceTimeoutNs) == GL_TIMEOUT_EXPIRED) {}
+        glDeleteSync(fence_);
+        fence_ = nullptr;
+    }
+
+    std::size_t ChunkedMesh::uploadVertices_(const geometry::MeshOut& m, std::size_t c) {
+        ranges_[c].vCount = static_cast<std::uint32_t>(m.vertices.size());
+        const auto off = ranges_[c].vOff * vertexSize_();
+        if (format_ == geometry::VertexFormat::Float) {
+            const auto bytes = m.vertices.size() * sizeof(geometry::Vertex);
+            if (buf_.vMap) {
+                std::memcpy(buf_.vMap + off, m.vertices.data(), bytes);
+            } else {
+                glBindBuffer(GL_ARRAY_BUFFER, buf_.vbo);
+                glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(off), static_cast<GLsizeiptr>(bytes),
+                                m.vertices.data());
+            }
+            return bytes;
+        }
+        const auto box = geometry::fitQuantBox(m.vertices);
+        const auto rows = geometry::packedQuantRows(box);
+        const auto bytes = m.vertices.size() * sizeof(geometry::PackedVertex);
+        if (buf_.vMap) {
+            // pakowanie wprost do bufora
+            geometry::packVertices(m.vertices, box, reinterpret_cast<geometry::PackedVertex*>(buf_.vMap + off));
+            std::memcpy(buf_.qMap + c * kQuantRowsBytes, rows.data(), kQuantRowsBytes);
+        } else {
+            geometry::packVertices(m.vertices, box, packed_);
+            glBindBuffer(GL_ARRAY_BUFFER, buf_.quantVbo);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(c * kQuantRowsBytes), kQuantRowsBytes,
+                            rows.data());
+            glBindBuffer(GL_ARRAY_BUFFER, buf_.vbo);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(off), static_cast<GLsizeiptr>(bytes),
+                            packed_.data());
+        }
+        return bytes + kQuantRowsBytes;
+    }
+
+    std::size_t ChunkedMesh::uploadIndices_(const geometry::MeshOut& m, Range& r) {
+        r.indexSize = indexSizeFor(m);
+        const auto bytes = m.indices.size() * r.indexSize;
+        r.iBytes = static_cast<std::uint32_t>(bytes);
+        if (buf_.iMap) {
+            unsigned char* dst = buf_.iMap + r.iByteOff;
+            if (r.indexSize == 2)
+                std::transform(m.indices.begin(), m.indices.end(), reinterpret_cast<std::uint16_t*>(dst),
+                               [](std::uint32_t i) { return static_cast<std::uint16_t>(i); });
+            else
+                std::memcpy(dst, m.indices.data(), bytes);
+            return bytes;
+        }
+        const void* data = m.indices.data();
+        if (r.indexSize == 2) {
+            narrow_.assign(m.indices.begin(), m.indices.end());
+            data = narrow_.data();
+        }
+        glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLintptr>(r.iByteOff), static_cast<GLsizeiptr>(bytes),
+                        data);
+        return bytes;
+    }
+
+    void ChunkedMesh::draw(std::span<const DrawCmd> cmds) const {
+        if (!vao_ || cmds.empty())
+            return;
+        // komendy pośrednie: osobny multi-draw dla indeksów 16- i 32-bitowych, base instance = kawałek
+        cmds_.clear();
+        std::size_t narrowCount = 0;
+        for (const std::uint32_t size: {2u, 4u}) {
+            for (const auto& c: cmds) {
+                if (c.indexCount == 0 || c.chunk >= ranges_.size() || ranges_[c.chunk].indexSize != size)
+                    continue;
+                const auto& r = ranges_[c.chunk];
+                cmds_.push_back({c.indexCount, 1, r.iByteOff / size + c.firstIndex, static_cast<GLint>(r.vOff),
+                                 c.chunk});
+            }
+            if (size == 2)
+                narrowCount = cmds_.size();
+        }
+        if (cmds_.empty())
+            return;
+        glBindVertexArray(vao_);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, cmdBuf_);
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(cmds_.size() * sizeof(IndirectCmd)), cmds_.data(),
+                     GL_STREAM_DRAW);
+        if (narrowCount)
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, static_cast<GLsizei>(narrowCount), 0);
+        if (cmds_.size() > narrowCount)
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT,
+                                        reinterpret_cast<const void*>(narrowCount * sizeof(IndirectCmd)),
+                                        static_cast<GLsizei>(cmds_.size() - narrowCount), 0);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+        glBindVertexArray(0);
+        if (buf_.vMap) {
+            if (fence_)
+                glDeleteSync(fence_);
+            fence_ = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        }
+    }
+
+    void ChunkedMesh::release() {
+        if (fence_) glDeleteSync(fence_);
+        fence_ = nullptr;
+        if (cmdBuf_) glDeleteBuffers(1, &cmdBuf_);
+        deleteBuffers_(buf_);
+        if (vao_) glDeleteVertexArrays(1, &vao_);
+        vao_ = cmdBuf_ = 0;
+        ranges_.clear();
+        gpuBytes_ = 0;
+    }
+} // namespace rc::gfx::render
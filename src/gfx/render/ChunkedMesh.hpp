@@ -0,0 +1,102 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_CHUNKEDMESH_HPP
+#define ROLLERCOASTERGL_CHUNKEDMESH_HPP
+
+#include <cstdint>
+#include <glad.h>
+#include <span>
+#include <vector>
+
+#include "gfx/geometry/PackedVertex.hpp"
+#include "gfx/geometry/RailGeometryBuilder.hpp" // dla geometry::MeshOut
+
+namespace rc::gfx::render {
+    // Jeden VAO/VBO/EBO podzielony na zakresy kawałków (z zapasem pojemności).
+    // Indeksy są lokalne dla kawałka - rysowanie z base vertex. Zmieniony kawałek, który mieści się
+    // w swoim zakresie, idzie glBufferSubData; inaczej cały bufor jest układany od nowa.
+    // Kawałek do 65536 wierzchołków trzyma indeksy 16-bitowe - rysowanie to jeden multi-draw na typ indeksu.
+    // W formacie Packed wierzchołki mają 16 B i ramkę kwantyzacji kawałka; ramka idzie atrybutami 3..4
+    // z divisor 1, a base instance komendy pośredniej to numer kawałka.
+    // Z GL 4.4 bufory są trwale zmapowane (glBufferStorage) - kawałek jest pakowany/zwężany wprost do
+    // pamięci bufora, bez kopii roboczych. Przy układaniu bufora od nowa niezmienione kawałki są
+    // kopiowane po stronie GPU, więc wołający nie musi trzymać ich siatek na CPU.
+    class ChunkedMesh {
+    public:
+        struct SyncStats {
+            std::size_t chunksUploaded = 0;
+            std::size_t bytesUploaded = 0;
+            bool fullUpload = false;
+        };
+        // fragment indeksów kawałka do narysowania
+        struct DrawCmd {
+            std::uint32_t chunk = 0;
+            std::uint32_t firstIndex = 0;
+            std::uint32_t indexCount = 0;
+        };
+
+        ChunkedMesh() = default;
+        ~ChunkedMesh() { release(); }
+        ChunkedMesh(const ChunkedMesh&) = delete;
+        ChunkedMesh& operator=(const ChunkedMesh&) = delete;
+
+        // zmiana formatu zwalnia bufory - następny sync wysyła wszystko
+        void setFormat(geometry::VertexFormat format);
+        [[nodiscard]] geometry::VertexFormat format() const { return format_; }
+
+        // chunks[i] - aktualna zawartość kawałka i, dirty[i] != 0 gdy zmieniony od poprzedniego sync.
+        // Niezmieniony kawałek, który jest już na GPU (hasChunk), może mieć pustą siatkę.
+        SyncStats sync(std::span<const geometry::MeshOut* const> chunks, std::span<const std::uint8_t> dirty);
+        [[nodiscard]] bool hasChunk(std::size_t c) const { return vao_ && c < ranges_.size(); }
+        void draw(std::span<const DrawCmd> cmds) const;
+        void release();
+
+        // bajty na GPU (wierzchołki + indeksy + ramki, z zapasem)
+        [[nodiscard]] std::size_t gpuBytes() const { return gpuBytes_; }
+
+    private:
+        struct Range {
+            std::uint32_t vOff = 0, vCap = 0, vCount = 0;
+            std::uint32_t iByteOff = 0, iByteCap = 0, iBytes = 0; // indeksy w bajtach - szerokość zależy od kawałka
+            std::uint32_t indexSize = 4;
+        };
+        struct Buffers {
+            GLuint vbo = 0, ebo = 0, quantVbo = 0;
+            // trwałe mapowania (nullptr bez GL 4.4)
+            unsigned char* vMap = nullptr;
+            unsigned char* iMap = nullptr;
+            unsigned char* qMap = nullptr;
+        };
+        // układ DrawElementsIndirectCommand z GL
+        struct IndirectCmd {
+            GLuint count, instanceCount, firstIndex;
+            GLint baseVertex;
+            GLuint baseInstance;
+        };
+        SyncStats fullUpload_(std::span<const geometry::MeshOut* const> chunks, std::span<const std::uint8_t> dirty);
+        [[nodiscard]] std::size_t vertexSize_() const;
+        static Buffers createBuffers_(std::size_t vBytes, std::size_t iBytes, std::size_t qBytes);
+        static void deleteBuffers_(Buffers& b);
+        // przed zapisem do zmapowanego zakresu - GPU mógł jeszcze czytać go w poprzedniej klatce
+        void waitForGpu_();
+        // wysyła wierzchołki kawałka c (w Packed także jego ramkę); zwraca bajty
+        std::size_t uploadVertices_(const geometry::MeshOut& m, std::size_t c);
+        // wysyła indeksy kawałka (zwęża do 16 bitów, jeśli się da); zwraca bajty
+        std::size_t uploadIndices_(const geometry::MeshOut& m, Range& r);
+
+        geometry::VertexFormat format_ = geometry::VertexFormat::Float;
+        GLuint vao_ = 0, cmdBuf_ = 0;
+        Buffers buf_;
+        std::vector<Range> ranges_;
+        std::size_t gpuBytes_ = 0;
+        mutable GLsync fence_ = nullptr; // po ostatnim draw
+        // bufory robocze; narrow_/packed_ tylko bez trwałego mapowania
+        mutable std::vector<IndirectCmd> cmds_;
+        std::vector<std::uint16_t> narrow_;
+        std::vector<geometry::PackedVertex> packed_;
+    };
+} // namespace rc::gfx::render
+
+#endif // ROLLERCOASTERGL_CHUNKEDMESH_HPP
@@ -0,0 +1,78 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "InstancedMesh.hpp"
+
+#include <cstddef>
+
+#include "VertexLayout.hpp"
+
+namespace rc::gfx::render {
+    void InstancedMesh::setTemplate(const geometry::MeshOut& mesh) {
+        release();
+        glGenVertexArrays(1, &vao_);
+        glGenBuffers(1, &vbo_);
+        glGenBuffers(1, &ebo_);
+        glGenBuffers(1, &ibo_);
+        glBindVertexArray(vao_);
+
+        glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.vertices.size() * sizeof(geometry::Vertex)),
+                     mesh.vertices.data(), GL_STATIC_DRAW);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo_);
+        glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(mesh.indices.size() * sizeof(std::uint32_t)),
+                     mesh.indices.data(), GL_STATIC_DRAW);
+        indexCount_ = static_cast<GLsizei>(mesh.indices.size());
+
+        // pozycja(0), normalna(1), UV(2) - jak w Mesh
+        setupVertexAttribs(geometry::VertexFormat::Float);
+
+        // wiersze przekształcenia instancji (3..5)
+        glBindBuffer(GL_ARRAY_BUFFER, ibo_);
+        for (GLuint r = 0; r < 3; ++r) {
+            glEnableVertexAttribArray(3 + r);
+            glVertexAttribPointer(3 + r, 4, GL_FLOAT, GL_FALSE, sizeof(geometry::InstanceXform),
+                                  reinterpret_cast<void*>(r * sizeof(glm::vec4)));
+            glVertexAttribDivisor(3 + r, 1);
+        }
+        glBindVertexArray(0);
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    std::size_t InstancedMesh::setInstances(std::span<const geometry::InstanceXform> instances) {
+        if (!vao_)
+            return 0;
+        const auto bytes = instances.size() * sizeof(geometry::InstanceXform);
+        glBindBuffer(GL_ARRAY_BUFFER, ibo_);
+        if (instances.size() > instanceCap_) {
+            instanceCap_ = instances.size() + instances.size() / 4;
+            glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instanceCap_ * sizeof(geometry::InstanceXform)),
+                         nullptr, GL_DYNAMIC_DRAW);
+        }
+        if (bytes)
+            glBufferSubData(GL_ARRAY_BUFFER, 0, static_cast<GLsizeiptr>(bytes), instances.data());
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+        instanceCount_ = instances.size();
+        return bytes;
+    }
+
+    void InstancedMesh::draw() const {
+        if (!vao_ || instanceCount_ == 0)
+            return;
+        glBindVertexArray(vao_);
+        glDrawElementsInstanced(GL_TRIANGLES, indexCount_, GL_UNSIGNED_INT, nullptr,
+                                static_cast<GLsizei>(instanceCount_));
+        glBindVertexArray(0);
+    }
+
+    void InstancedMesh::release() {
+        if (ibo_) glDeleteBuffers(1, &ibo_);
+        if (ebo_) glDeleteBuffers(1, &ebo_);
+        if (vbo_) glDeleteBuffers(1, &vbo_);
+        if (vao_) glDeleteVertexArrays(1, &vao_);
+        vao_ = vbo_ = ebo_ = ibo_ = 0;
+        indexCount_ = 0;
+        instanceCount_ = instanceCap_ = 0;
+    }
+} // namespace rc::gfx::render
@@ -0,0 +1,41 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_INSTANCEDMESH_HPP
+#define ROLLERCOASTERGL_INSTANCEDMESH_HPP
+
+#include <cstdint>
+#include <glad.h>
+#include <span>
+
+#include "gfx/geometry/RailGeometryBuilder.hpp"
+#include "gfx/geometry/SupportInstances.hpp"
+
+namespace rc::gfx::render {
+    // Szablon (VBO/EBO, atrybuty 0..2 jak w Mesh) + bufor instancji (atrybuty 3..5 - wiersze
+    // przekształcenia, divisor 1). Jeden glDrawElementsInstanced na szablon.
+    class InstancedMesh {
+    public:
+        InstancedMesh() = default;
+        ~InstancedMesh() { release(); }
+        InstancedMesh(const InstancedMesh&) = delete;
+        InstancedMesh& operator=(const InstancedMesh&) = delete;
+
+        void setTemplate(const geometry::MeshOut& mesh);
+        // zwraca liczbę wysłanych bajtów
+        std::size_t setInstances(std::span<const geometry::InstanceXform> instances);
+        void draw() const;
+        void release();
+
+        [[nodiscard]] bool hasTemplate() const { return vao_ != 0; }
+        [[nodiscard]] std::size_t instanceCount() const { return instanceCount_; }
+
+    private:
+        GLuint vao_ = 0, vbo_ = 0, ebo_ = 0, ibo_ = 0; // ibo_ - bufor instancji
+        GLsizei indexCount_ = 0;
+        std::size_t instanceCount_ = 0, instanceCap_ = 0;
+    };
+} // namespace rc::gfx::render
+
+#endif // ROLLERCOASTERGL_INSTANCEDMESH_HPP
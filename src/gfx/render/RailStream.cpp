@@ -0,0 +1,76 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "RailStream.hpp"
+
+#include <cstring>
+
+namespace rc::gfx::render {
+    std::size_t RailStream::update(std::span<const common::Frame> frames, const geometry::RailParams& params) {
+        if (!geometry::buildRailStream(frames, params, frames_)) {
+            release();
+            return 0;
+        }
+        vertexCount_ = static_cast<GLsizei>(geometry::railStreamVertexCount(frames_.size(), params.ringSides));
+
+        next_.resize(1 + 2 * frames_.size());
+        next_[0] = geometry::railStreamHeader(params);
+        for (std::size_t i = 0; i < frames_.size(); ++i) {
+            next_[1 + 2 * i] = frames_[i].posS;
+            next_[2 + 2 * i] = frames_[i].q;
+        }
+
+        if (!vao_) {
+            glGenVertexArrays(1, &vao_); // core profile nie rysuje bez VAO, atrybutów nie ma
+            glGenBuffers(1, &buf_);
+            glGenTextures(1, &tex_);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, buf_);
+        std::size_t bytes = 0;
+        if (next_.size() != texels_.size()) {
+            bytes = next_.size() * sizeof(glm::vec4);
+            glBufferData(GL_TEXTURE_BUFFER, static_cast<GLsizeiptr>(bytes), next_.data(), GL_DYNAMIC_DRAW);
+            // nowy magazyn - tekstura musi wskazać go od nowa
+            glBindTexture(GL_TEXTURE_BUFFER, tex_);
+            glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buf_);
+            glBindTexture(GL_TEXTURE_BUFFER, 0);
+        } else {
+            // ten sam rozmiar - tylko zakres od pierwszego do ostatniego zmienionego teksela
+            std::size_t first = 0, last = next_.size();
+            while (first < last && std::memcmp(&next_[first], &texels_[first], sizeof(glm::vec4)) == 0)
+                ++first;
+            while (last > first && std::memcmp(&next_[last - 1], &texels_[last - 1], sizeof(glm::vec4)) == 0)
+                --last;
+            bytes = (last - first) * sizeof(glm::vec4);
+            if (bytes)
+                glBufferSubData(GL_TEXTURE_BUFFER, static_cast<GLintptr>(first * sizeof(glm::vec4)),
+                                static_cast<GLsizeiptr>(bytes), next_.data() + first);
+        }
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+        texels_.swap(next_);
+        return bytes;
+    }
+
+    void RailStream::draw() const {
+        if (!vao_ || vertexCount_ == 0)
+            return;
+        glActiveTexture(GL_TEXTURE0 + kTextureUnit);
+        glBindTexture(GL_TEXTURE_BUFFER, tex_);
+        glBindVertexArray(vao_);
+        glDrawArraysInstanced(GL_TRIANGLES, 0, vertexCount_, 2);
+        glBindVertexArray(0);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glActiveTexture(GL_TEXTURE0);
+    }
+
+    void RailStream::release() {
+        if (tex_) glDeleteTextures(1, &tex_);
+        if (buf_) glDeleteBuffers(1, &buf_);
+        if (vao_) glDeleteVertexArrays(1, &vao_);
+        vao_ = buf_ = tex_ = 0;
+        vertexCount_ = 0;
+        frames_.clear();
+        texels_.clear();
+    }
+} // namespace rc::gfx::render
@@ -0,0 +1,46 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_RAILSTREAM_HPP
+#define ROLLERCOASTERGL_RAILSTREAM_HPP
+
+#include <glad.h>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "gfx/geometry/RailExtrusion.hpp"
+
+namespace rc::gfx::render {
+    // Szyny rysowane z samych ramek (track_extrude.vert): bufor tekstury z nagłówkiem i ramkami,
+    // pusty VAO i glDrawArraysInstanced - instancja to szyna. update() wysyła tylko zakres
+    // tekseli, który różni się od poprzedniego strumienia (edycja przechyłki = mały podbufor).
+    class RailStream {
+    public:
+        // jednostka tekstury dla uRailFrames
+        static constexpr GLint kTextureUnit = 3;
+
+        RailStream() = default;
+        ~RailStream() { release(); }
+        RailStream(const RailStream&) = delete;
+        RailStream& operator=(const RailStream&) = delete;
+
+        // zwraca liczbę wysłanych bajtów
+        std::size_t update(std::span<const common::Frame> frames, const geometry::RailParams& params);
+        void draw() const;
+        void release();
+
+        [[nodiscard]] std::size_t frameCount() const { return frames_.size(); }
+        [[nodiscard]] std::size_t gpuBytes() const { return texels_.size() * sizeof(glm::vec4); }
+
+    private:
+        GLuint vao_ = 0, buf_ = 0, tex_ = 0;
+        GLsizei vertexCount_ = 0; // na szynę
+        std::vector<geometry::RailStreamFrame> frames_;
+        std::vector<glm::vec4> texels_; // kopia zawartości bufora - do wyznaczenia zmienionego zakresu
+        std::vector<glm::vec4> next_;
+    };
+} // namespace rc::gfx::render
+
+#endif // ROLLERCOASTERGL_RAILSTREAM_HPP
@@ -6,69 +6,364 @@
 
 #include "physics/FrameCursor.hpp"
 
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <glad.h>
 #include <glm/glm.hpp>
+#include <limits>
 #include <span>
 
-#include "Track.hpp"
+#include "common/AllocStats.hpp"
+#include "common/Hash.hpp"
+#include "common/ThreadPool.hpp"
 #include <glm/gtx/norm.hpp>
 #include <glm/gtx/compatibility.hpp>
 
 namespace rc::gfx::render {
     using geometry::MeshOut;
     using geometry::RailGeometryBuilder;
-    using geometry::SupportGeometryBuilder;
+    using geometry::SupportInstanceBuilder;
+
+    namespace {
+        // LOD k wchodzi, gdy jego tolerancja widziana z odległości d jest poniżej ~1.5 mrad (ok. piksela)
+        constexpr float kLodAngle = 1.5e-3f;
+
+        struct Support {
+            glm::vec3 top, bottom;
+        };
+
+        struct ChunkPlan {
+            std::size_t fa = 0, fb = 0; // zakres ramek szyn [fa, fb]
+            std::vector<Support> supports;
+            std::uint64_t hash = 0;
+        };
+
+        void hashParams(common::Hasher& h, const geometry::RailParams& rp, const InfraParams& ip) {
+            h.pod(rp.gauge);
+            h.pod(rp.railRadius);
+            h.pod(rp.ringSides);
+            h.pod(rp.texScaleV);
+            h.pod(rp.lodTolerance);
+            h.pod(ip.beamDs);
+            h.pod(ip.beamThick);
+            h.pod(ip.beamHeight);
+            h.pod(ip.supportHoriz);
+            h.pod(ip.supportRadius);
+            h.pod(ip.supportSides);
+            h.pod(ip.minClearance);
+        }
+    } // namespace
 
     void Track::build(const std::vector<common::Frame>& frames,
                       const geometry::RailParams& railParams,
                       const Terrain& terrain,
                       const InfraParams& infra) {
-        MeshOut out;
+        const auto t0 = std::chrono::steady_clock::now();
+        const common::AllocScope allocScope;
+        const float sMax = totalLength(frames);
+        const std::size_t count =
+                frames.size() < 2 ? 0 : std::max<std::size_t>(1, static_cast<std::size_t>(std::ceil(sMax / kChunkLength)));
 
-        // Szyny
-        RailGeometryBuilder rgb(frames, out);
-        rgb.build(railParams);
+        const float tol0 = railParams.lodTolerance;
+        lodTolerance_ = {tol0, std::max(tol0, 0.01f) * 5.f, std::max(tol0, 0.01f) * 25.f};
 
-        //sampler ramek
-        physics::FrameCursor cursor(&frames, railParams.closedLoop, totalLength(frames));
+        // 1) plan kawałków: zakres ramek, słupy (zależą od terenu) i skrót - tanie, dla wszystkich
+        std::vector<ChunkPlan> plans(count);
+        auto& pool = common::ThreadPool::shared();
+        pool.parallelFor(count, 1, [&](std::size_t begin, std::size_t end, std::size_t) {
+            //sampler ramek
+            physics::FrameCursor cursor(&frames, railParams.closedLoop, sMax);
+            std::vector<glm::vec3> candidates;
+            std::vector<float> candX, candZ, groundY;
+            for (std::size_t c = begin; c < end; ++c) {
+                const float s0 = static_cast<float>(c) * kChunkLength;
+                const float s1 = (c + 1 == count) ? sMax : std::min(sMax, s0 + kChunkLength);
+                ChunkPlan& pl = plans[c];
+                auto less = [](const common::Frame& f, float s) { return f.s < s; };
+                const auto itA = std::lower_bound(frames.begin(), frames.end(), s0, less);
+                const auto itB = std::lower_bound(frames.begin(), frames.end(), s1, less);
+                // szyny kawałka od pierwszej ramki >= s0 do pierwszej >= s1 - sąsiedzi dzielą ring brzegowy
+                pl.fa = std::min(static_cast<std::size_t>(itA - frames.begin()), frames.size() - 1);
+                pl.fb = std::min(static_cast<std::size_t>(itB - frames.begin()), frames.size() - 1);
 
-        //Poprzeczki co beamDs po łuku
-        SupportGeometryBuilder sgb(out);
-        const float gauge = railParams.gauge;
+                // Słupy co supportHoriz po ziemi! Nie po łuku. Marsz od początku kawałka,
+                // żeby słupy kawałka nie zależały od reszty toru. Wysokości terenu pod kandydatami
+                // jednym zapytaniem wsadowym.
+                const glm::vec3 UP(0,1,0);
+                candidates.clear();
+                candX.clear();
+                candZ.clear();
+                for (float s = s0; s < s1 && s < sMax - 1e-4f; ) {
+                    glm::vec3 P, T, N, B; glm::quat q;
+                    cursor.sample(s, P, T, N, B, q);
+                    float Ty = glm::dot(T, UP);
+                    float cosPhi = std::sqrt(glm::max(0.0f, 1.0f - Ty*Ty));
+                    float ds = infra.supportHoriz / glm::max(cosPhi, 0.05f); // clamp przy prawie pionie
 
-        const float sMax = totalLength(frames);
-        for (float s = 0.0f; s < sMax - 1e-4f; s += infra.beamDs) {
-            glm::vec3 P, T, N, B; glm::quat q;
-            cursor.sample(s, P, T, N, B, q);
-            glm::vec3 L = P + B * (gauge*0.5f);
-            glm::vec3 R = P - B * (gauge*0.5f);
-            sgb.addBeamBox(L, R, infra.beamThick, infra.beamHeight);
+                    candidates.push_back(P);
+                    candX.push_back(P.x);
+                    candZ.push_back(P.z);
+                    s += ds;
+                }
+                groundY.resize(candidates.size());
+                terrain.sampleHeights(candX, candZ, groundY);
+                for (std::size_t k = 0; k < candidates.size(); ++k) {
+                    const glm::vec3& P = candidates[k];
+                    if (P.y - groundY[k] > infra.minClearance)
+                        pl.supports.push_back({P, glm::vec3(P.x, groundY[k], P.z)});
+                }
+
+                common::Hasher h;
+                h.pod(s0);
+                h.pod(s1);
+                // belki z [s0, frames[fa].s) interpolują ramkę fa-1 - ona też wchodzi do skrótu
+                const std::size_t hashFrom = pl.fa ? pl.fa - 1 : 0;
+                h.span(std::span<const common::Frame>(frames).subspan(hashFrom, pl.fb - hashFrom + 1));
+                h.span(std::span<const Support>(pl.supports));
+                hashParams(h, railParams, infra);
+                pl.hash = h.value();
+            }
+        });
+
+        // 2) przebudowa tylko zmienionych kawałków; bez kopii CPU także tych, których nie ma na GPU
+        std::vector<std::uint8_t> dirty(count, 0);
+        chunks_.resize(count);
+        for (std::size_t c = 0; c < count; ++c)
+            dirty[c] = !chunks_[c].built || chunks_[c].hash != plans[c].hash ||
+                       (!extrude_ && !keepCpuMesh_ && !steel_.hasChunk(c));
+
+        pool.parallelFor(count, 1, [&](std::size_t begin, std::size_t end, std::size_t) {
+            physics::FrameCursor cursor(&frames, railParams.closedLoop, sMax);
+            for (std::size_t c = begin; c < end; ++c) {
+                if (!dirty[c])
+                    continue;
+                const ChunkPlan& pl = plans[c];
+                Chunk& ch = chunks_[c];
+                ch.s0 = static_cast<float>(c) * kChunkLength;
+                ch.s1 = (c + 1 == count) ? sMax : std::min(sMax, ch.s0 + kChunkLength);
+                ch.hash = pl.hash;
+                ch.built = true;
+                MeshOut& out = ch.mesh;
+                ch.supports.clear();
+                ch.meshlets.clear();
+                ch.lodMeshlets = {};
+
+                if (!extrude_) {
+                    // Szyny - każdy LOD jako otwarty odcinek; końce kawałka zostają w każdym poziomie.
+                    // LOD 0 przejmuje się w całości, kolejne dopisuje z przesunięciem indeksów.
+                    geometry::RailParams rp = railParams;
+                    rp.closedLoop = false;
+                    const auto sub = std::span<const common::Frame>(frames).subspan(pl.fa, pl.fb - pl.fa + 1);
+                    auto lods = geometry::buildRailLods(sub, rp, lodTolerance_);
+                    std::size_t nv = 0, ni = 0;
+                    for (const auto& lod: lods) {
+                        nv += lod.vertices.size();
+                        ni += lod.indices.size();
+                    }
+                    out = std::move(lods[0]);
+                    out.vertices.reserve(nv);
+                    out.indices.reserve(ni);
+                    ch.lods[0] = {0, static_cast<std::uint32_t>(out.indices.size())};
+                    for (std::size_t l = 1; l < kRailLods; ++l) {
+                        const auto base = static_cast<std::uint32_t>(out.vertices.size());
+                        out.vertices.insert(out.vertices.end(), lods[l].vertices.begin(), lods[l].vertices.end());
+                        ch.lods[l].first = static_cast<std::uint32_t>(out.indices.size());
+                        for (const auto i: lods[l].indices)
+                            out.indices.push_back(base + i);
+                        ch.lods[l].count = static_cast<std::uint32_t>(out.indices.size()) - ch.lods[l].first;
+                        lods[l] = {};
+                    }
+                }
+
+                //Poprzeczki co beamDs po łuku (siatka globalna - ta sama niezależnie od podziału)
+                SupportInstanceBuilder sib(ch.supports);
+                const float gauge = railParams.gauge;
+                for (auto k = static_cast<std::int64_t>(std::ceil(ch.s0 / infra.beamDs));; ++k) {
+                    const float s = static_cast<float>(k) * infra.beamDs;
+                    if (s >= ch.s1 || s >= sMax - 1e-4f)
+                        break;
+                    glm::vec3 P, T, N, B; glm::quat q;
+                    cursor.sample(s, P, T, N, B, q);
+                    glm::vec3 L = P + B * (gauge*0.5f);
+                    glm::vec3 R = P - B * (gauge*0.5f);
+                    sib.addBeamBox(L, R, infra.beamThick, infra.beamHeight);
+                }
+                for (const auto& sp: pl.supports) {
+                    sib.addSupportCylinder(sp.top, sp.bottom, infra.supportRadius);
+                    // stopka
+                    sib.addFootDisk(sp.bottom, infra.supportRadius*2.2f);
+                }
+
+                if (!extrude_) {
+                    // trójkąty są już w paskach pod cache (RailGeometryBuilder); wierzchołki wg pierwszego użycia
+                    std::span<std::uint32_t> allIdx(out.indices);
+                    geometry::optimizeVertexFetch(out.vertices, allIdx);
+                    ch.cache = geometry::analyzeVertexCache(allIdx.subspan(ch.lods[0].first, ch.lods[0].count),
+                                                            out.vertices.size());
+                    // meshlety po optymalizacji - ta sama kolejność indeksów, co w buforze GPU
+                    std::vector<glm::vec3> positions(out.vertices.size());
+                    for (std::size_t i = 0; i < positions.size(); ++i)
+                        positions[i] = out.vertices[i].pos;
+                    for (std::size_t l = 0; l < kRailLods; ++l) {
+                        ch.lodMeshlets[l].first = static_cast<std::uint32_t>(ch.meshlets.size());
+                        geometry::buildMeshlets(positions, allIdx.subspan(ch.lods[l].first, ch.lods[l].count),
+                                                ch.lods[l].first, ch.meshlets);
+                        ch.lodMeshlets[l].count =
+                                static_cast<std::uint32_t>(ch.meshlets.size()) - ch.lodMeshlets[l].first;
+                    }
+                }
+
+                glm::vec3 lo(std::numeric_limits<float>::max()), hi(-std::numeric_limits<float>::max());
+                for (const auto& v: out.vertices) {
+                    lo = glm::min(lo, v.pos);
+                    hi = glm::max(hi, v.pos);
+                }
+                // słupy sięgają do ziemi - wejdą do sfery przez górę i dół
+                for (const auto& sp: pl.supports) {
+                    lo = glm::min(lo, glm::min(sp.top, sp.bottom));
+                    hi = glm::max(hi, glm::max(sp.top, sp.bottom));
+                }
+                ch.center = 0.5f * (lo + hi);
+                ch.radius = out.vertices.empty() ? 0.f : glm::length(hi - ch.center);
+            }
+        });
+
+        // 3) Upload do GPU - podbufory dla zmienionych kawałków
+        std::vector<const MeshOut*> meshes(count);
+        for (std::size_t c = 0; c < count; ++c)
+            meshes[c] = &chunks_[c].mesh;
+        ChunkedMesh::SyncStats sync;
+        if (extrude_)
+            sync.bytesUploaded = railStream_.update(frames, railParams);
+        else
+            sync = steel_.sync(meshes, dirty);
+        if (!keepCpuMesh_)
+            for (std::size_t c = 0; c < count; ++c)
+                if (dirty[c])
+                    chunks_[c].mesh = {}; // siatka jest już w buforze GPU
+
+        // Instancje są małe (48 B) - przy zmianie któregokolwiek kawałka cały bufor od nowa
+        bool supportsDirty = std::find(dirty.begin(), dirty.end(), std::uint8_t{1}) != dirty.end();
+        if (!ties_.hasTemplate()) {
+            ties_.setTemplate(SupportInstanceBuilder::tieTemplate());
+            feet_.setTemplate(SupportInstanceBuilder::footTemplate(12)); // stopka ma stałą liczbę boków
+            supportsDirty = true;
+        }
+        if (columnSides_ != infra.supportSides) {
+            columns_.setTemplate(SupportInstanceBuilder::columnTemplate(infra.supportSides));
+            columnSides_ = infra.supportSides;
+            supportsDirty = true;
         }
+        std::size_t instBytes = 0;
+        if (supportsDirty) {
+            allSupports_.clear();
+            for (const auto& ch: chunks_)
+                allSupports_.append(ch.supports);
+            instBytes += ties_.setInstances(allSupports_.ties);
+            instBytes += columns_.setInstances(allSupports_.columns);
+            instBytes += feet_.setInstances(allSupports_.feet);
+        }
+
+        stats_.chunks = count;
+        stats_.cache = {};
+        for (const auto& ch: chunks_)
+            stats_.cache += ch.cache;
+        stats_.rebuilt = static_cast<std::size_t>(std::count(dirty.begin(), dirty.end(), std::uint8_t{1}));
+        stats_.bytesUploaded = sync.bytesUploaded + instBytes;
+        stats_.instances = ties_.instanceCount() + columns_.instanceCount() + feet_.instanceCount();
+        stats_.fullUpload = sync.fullUpload;
+        stats_.gpuBytes = steel_.gpuBytes() + railStream_.gpuBytes();
+        stats_.cpuBytes = 0;
+        for (const auto& ch: chunks_)
+            stats_.cpuBytes += ch.mesh.vertices.capacity() * sizeof(geometry::Vertex) +
+                               ch.mesh.indices.capacity() * sizeof(std::uint32_t);
+        stats_.allocations = allocScope.allocations();
+        stats_.peakAllocBytes = allocScope.peakBytes();
+        stats_.ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    }
+
+    void Track::setRailExtrusion(bool extrude) {
+        if (extrude == extrude_)
+            return;
+        extrude_ = extrude;
+        // kawałki z innego trybu nie pasują - następny build() przebuduje wszystkie
+        steel_.release();
+        railStream_.release();
+        chunks_.clear();
+    }
 
-        // Słupy co supportHoriz po ziemi! Nie po łuku
-        const glm::vec3 UP(0,1,0);
-        for (float s = 0.0f; s < sMax - 1e-4f; ) {
-            glm::vec3 P, T, N, B; glm::quat q;
-            cursor.sample(s, P, T, N, B, q);
-            float Ty = glm::dot(T, UP);
-            float cosPhi = std::sqrt(glm::max(0.0f, 1.0f - Ty*Ty));
-            float ds = infra.supportHoriz / glm::max(cosPhi, 0.05f); // clamp przy prawie pionie
-
-            float groundY = terrain.sampleHeightBilinear(P.x, P.z);
-            if (P.y - groundY > infra.minClearance) {
-                glm::vec3 bottom(P.x, groundY, P.z);
-                sgb.addSupportCylinder(P, bottom, infra.supportRadius, infra.supportSides);
-                // stopka
-                sgb.addFootDisk(bottom, infra.supportRadius*2.2f, 12);
+    void Track::draw() const {
+        if (extrude_) {
+            railStream_.draw();
+            return;
+        }
+        drawCmds_.clear();
+        for (std::size_t c = 0; c < chunks_.size(); ++c)
+            drawCmds_.push_back({static_cast<std::uint32_t>(c), chunks_[c].lods[0].first, chunks_[c].lods[0].count});
+        steel_.draw(drawCmds_);
+    }
+
+    void Track::draw(const glm::vec3& camPos) const {
+        if (extrude_) {
+            railStream_.draw();
+            return;
+        }
+        drawCmds_.clear();
+        for (std::size_t c = 0; c < chunks_.size(); ++c) {
+            const Chunk& ch = chunks_[c];
+            const std::size_t l = lodFor(ch, camPos);
+            drawCmds_.push_back({static_cast<std::uint32_t>(c), ch.lods[l].first, ch.lods[l].count});
+        }
+        steel_.draw(drawCmds_);
+    }
+
+    void Track::draw(const glm::vec3& camPos, const math::Frustum& frustum) const {
+        if (extrude_) {
+            railStream_.draw();
+            return;
+        }
+        cull_ = {};
+        drawCmds_.clear();
+        for (std::size_t c = 0; c < chunks_.size(); ++c) {
+            const Chunk& ch = chunks_[c];
+            const std::size_t l = lodFor(ch, camPos);
+            const auto meshlets = std::span<const geometry::Meshlet>(ch.meshlets)
+                                          .subspan(ch.lodMeshlets[l].first, ch.lodMeshlets[l].count);
+            if (!frustum.intersectsSphere(ch.center, ch.radius)) {
+                cull_.meshlets += meshlets.size();
+                cull_.frustumCulled += meshlets.size();
+                continue;
             }
-            s += ds;
+            visible_.clear();
+            geometry::cullMeshlets(meshlets, frustum, camPos, visible_, cull_);
+            for (const auto& r: visible_)
+                drawCmds_.push_back({static_cast<std::uint32_t>(c), r.first, r.count});
         }
+        steel_.draw(drawCmds_);
+    }
+
+    std::size_t Track::lodFor(const Chunk& ch, const glm::vec3& camPos) const {
+        const float d = std::max(glm::length(camPos - ch.center) - ch.radius, 0.f);
+        std::size_t l = 0;
+        while (l + 1 < kRailLods && lodTolerance_[l + 1] <= kLodAngle * d)
+            ++l;
+        return l;
+    }
+
+    void Track::drawSupports() const {
+        ties_.draw();
+        columns_.draw();
+        feet_.draw();
+    }
 
-        // Upload do GPU
-        Mesh steel;
-        steel.setData(out.vertices, out.indices);
+    void Track::releaseGL() {
         steel_.release();
-        steel_ = std::move(steel);
-        steel_.uploadToGPU();
+        railStream_.release();
+        ties_.release();
+        columns_.release();
+        feet_.release();
+        columnSides_ = 0;
+        chunks_.clear();
     }
 } // namespace rc::gfx::render
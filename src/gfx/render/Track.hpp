@@ -5,12 +5,19 @@
 #ifndef TRACK_HPP
 #define TRACK_HPP
 
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <glm/glm.hpp>
-#include "gfx/render/Mesh.hpp"
+#include "gfx/render/ChunkedMesh.hpp"
+#include "gfx/render/InstancedMesh.hpp"
+#include "gfx/render/RailStream.hpp"
+#include "gfx/geometry/MeshOptimizer.hpp"
+#include "gfx/geometry/Meshlets.hpp"
 #include "gfx/geometry/RailGeometryBuilder.hpp"
-#include "gfx/geometry/SupportGeometryBuilder.hpp"
+#include "gfx/geometry/SupportInstances.hpp"
 #include "common/TrackTypes.hpp"
+#include "math/Frustum.hpp"
 #include "terrain/Terrain.hpp"
 
 namespace rc::gfx::render {
@@ -25,24 +32,100 @@ namespace rc::gfx::render {
         float minClearance = 0.25f; // minimalna wysokość słupa
     };
 
+    // Stalowa siatka toru podzielona na kawałki stałej długości łuku. Każdy kawałek ma skrót zawartości
+    // (ramki, parametry, punkty słupów z wysokością terenu); build() generuje od nowa tylko kawałki
+    // o zmienionym skrócie i wysyła je podbuforami. Szyny kawałka mają kRailLods poziomów LOD.
+    // Poprzeczki, słupy i stopki to instancje trzech szablonów - rysuje je drawSupports()
+    // programem z track_inst.vert.
+    // Po wysłaniu siatki kawałków są domyślnie zwalniane z CPU (setKeepCpuMesh) - przy przebudowie
+    // bufora niezmienione kawałki kopiuje GPU.
+    // Każdy LOD szyn kawałka jest podzielony na meshlety (Meshlets.hpp); draw(camPos, frustum) odrzuca
+    // kawałki i meshlety poza ostrosłupem albo zwrócone tyłem i rysuje tylko widoczne zakresy indeksów.
+    // W trybie wyciągania (setRailExtrusion) szyny nie mają siatki - build() wysyła tylko strumień ramek
+    // (RailStream), a rysuje je track_extrude.vert; kawałki niosą wtedy same podpory.
     class Track {
     public:
+        static constexpr float kChunkLength = 50.f;
+        static constexpr std::size_t kRailLods = 3;
+
+        struct BuildStats {
+            std::size_t chunks = 0;
+            std::size_t rebuilt = 0;
+            std::size_t bytesUploaded = 0;
+            std::size_t instances = 0; // poprzeczki + słupy + stopki
+            geometry::VertexCacheStats cache; // szyny LOD 0 wszystkich kawałków
+            std::size_t gpuBytes = 0;         // bufor szyn na GPU
+            std::size_t cpuBytes = 0;         // siatki kawałków trzymane na CPU po build()
+            std::size_t allocations = 0;      // w trakcie build() - tylko z RC_TRACK_ALLOCS
+            std::size_t peakAllocBytes = 0;
+            bool fullUpload = false;
+            double ms = 0.0;
+        };
+
         void build(const std::vector<common::Frame>& frames,
                    const geometry::RailParams& railParams,
                    const Terrain& terrain,
                    const InfraParams& infra);
 
-        void uploadToGPU()   { steel_.uploadToGPU(); }
-        void draw() const    { steel_.draw(); }
-        void releaseGL()     { steel_.release(); }
+        void draw() const; // wszystko w LOD 0
+        // LOD szyn per kawałek wg odległości od kamery
+        void draw(const glm::vec3& camPos) const;
+        // jak wyżej + odrzucanie meshletów; statystyki w lastCull()
+        void draw(const glm::vec3& camPos, const math::Frustum& frustum) const;
+        void drawSupports() const; // instancje - shader z atrybutami 3..5
+        void releaseGL();
+
+        // Packed: 16 B wierzchołki szyn (shader track_packed.vert); działa od następnego build()
+        void setVertexFormat(geometry::VertexFormat format) { steel_.setFormat(format); }
+        [[nodiscard]] geometry::VertexFormat vertexFormat() const { return steel_.format(); }
+
+        // true: szyny z ramek w shaderze (track_extrude.vert), bez LOD; działa od następnego build()
+        void setRailExtrusion(bool extrude);
+        [[nodiscard]] bool railExtrusion() const { return extrude_; }
+
+        // true - siatki kawałków zostają na CPU po wysłaniu (np. do eksportu)
+        void setKeepCpuMesh(bool keep) { keepCpuMesh_ = keep; }
+        [[nodiscard]] bool keepCpuMesh() const { return keepCpuMesh_; }
+
+        [[nodiscard]] const BuildStats& lastBuild() const { return stats_; }
+        [[nodiscard]] const geometry::MeshletCullStats& lastCull() const { return cull_; }
 
     private:
+        using IndexRange = geometry::IndexRange;
+        struct Chunk {
+            float s0 = 0.f, s1 = 0.f;
+            std::uint64_t hash = 0;
+            bool built = false;
+            geometry::MeshOut mesh; // szyny LOD 0..n-1; puste po wysłaniu, gdy !keepCpuMesh_
+            geometry::SupportInstances supports;
+            std::array<IndexRange, kRailLods> lods{};
+            std::vector<geometry::Meshlet> meshlets; // wszystkie LOD; zostają na CPU do odrzucania
+            std::array<IndexRange, kRailLods> lodMeshlets{}; // zakres w meshlets
+            geometry::VertexCacheStats cache; // LOD 0
+            glm::vec3 center{0.f};
+            float radius = 0.f;
+        };
+
         static float totalLength(const std::vector<common::Frame>& fr) {
             if (fr.empty()) return 0.f;
             return fr.back().s; // s - długość łuku
         }
 
-        Mesh steel_; // szyny + poprzeczki + słupy -- jeden drawcall
+        [[nodiscard]] std::size_t lodFor(const Chunk& ch, const glm::vec3& camPos) const;
+
+        std::vector<Chunk> chunks_;
+        std::array<float, kRailLods> lodTolerance_{};
+        ChunkedMesh steel_; // szyny -- jeden multi-draw
+        RailStream railStream_; // szyny w trybie wyciągania
+        bool extrude_ = false;
+        InstancedMesh ties_, columns_, feet_;
+        int columnSides_ = 0; // dla jakiej liczby boków jest szablon słupa
+        geometry::SupportInstances allSupports_; // bufor roboczy uploadu
+        bool keepCpuMesh_ = false;
+        BuildStats stats_;
+        mutable std::vector<ChunkedMesh::DrawCmd> drawCmds_;
+        mutable std::vector<IndexRange> visible_;
+        mutable geometry::MeshletCullStats cull_;
     };
 
 } // namespace rc::gfx::render
@@ -0,0 +1,51 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_VERTEXLAYOUT_HPP
+#define ROLLERCOASTERGL_VERTEXLAYOUT_HPP
+
+#include <cstddef>
+#include <glad.h>
+
+#include "gfx/geometry/PackedVertex.hpp"
+
+namespace rc::gfx::render {
+    // Atrybuty 0..2 (pozycja, normalna, UV) dla bufora związanego z GL_ARRAY_BUFFER.
+    // Float - geometry::Vertex (i TVertex o tym samym układzie), Packed - geometry::PackedVertex.
+    inline void setupVertexAttribs(geometry::VertexFormat format) {
+        using geometry::PackedVertex;
+        using geometry::Vertex;
+        glEnableVertexAttribArray(0);
+        glEnableVertexAttribArray(1);
+        glEnableVertexAttribArray(2);
+        if (format == geometry::VertexFormat::Packed) {
+            glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex),
+                                  reinterpret_cast<void*>(offsetof(PackedVertex, pos)));
+            glVertexAttribPointer(1, 4, GL_INT_2_10_10_10_REV, GL_TRUE, sizeof(PackedVertex),
+                                  reinterpret_cast<void*>(offsetof(PackedVertex, normal)));
+            glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex),
+                                  reinterpret_cast<void*>(offsetof(PackedVertex, uv)));
+        } else {
+            glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                  reinterpret_cast<void*>(offsetof(Vertex, pos)));
+            glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                  reinterpret_cast<void*>(offsetof(Vertex, normal)));
+            glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex),
+                                  reinterpret_cast<void*>(offsetof(Vertex, uv)));
+        }
+    }
+
+    // Ramka kwantyzacji (atrybuty 3, 4; divisor 1) z bufora związanego z GL_ARRAY_BUFFER -
+    // po jednej parze vec4 na instancję (zwykłe rysowanie czyta element 0, pośrednie - base instance).
+    inline void setupQuantAttribs() {
+        constexpr auto stride = static_cast<GLsizei>(2 * sizeof(glm::vec4));
+        for (GLuint k = 0; k < 2; ++k) {
+            glEnableVertexAttribArray(3 + k);
+            glVertexAttribPointer(3 + k, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void*>(k * sizeof(glm::vec4)));
+            glVertexAttribDivisor(3 + k, 1);
+        }
+    }
+} // namespace rc::gfx::render
+
+#endif // ROLLERCOASTERGL_VERTEXLAYOUT_HPP
@@ -5,23 +5,45 @@
 #ifndef ARRAY_2D_HPP
 #define ARRAY_2D_HPP
 #include <algorithm>
+#include <cstddef>
 #include <iostream>
+#include <memory>
 #include <ostream>
+#include <stdexcept>
+#include <utility>
 #include <vector>
 
 template <typename Type>
 class Array_2D {
 public:
     Array_2D(int width, int height, Type initVal = Type()) :
-        width_(width), height_(height), data_(width * height, initVal){};
+        width_(width), height_(height), data_(width * height, initVal), ptr_(data_.data()){};
+    // Widok na cudzą pamięć (np. zmapowany plik) bez kopiowania; keep trzyma ją przy życiu.
+    // Kopia widoku ma już własne dane.
+    Array_2D(int width, int height, Type* external, std::shared_ptr<void> keep) :
+        width_(width), height_(height), ptr_(external), keep_(std::move(keep)) {}
+    Array_2D(const Array_2D& other) :
+        width_(other.width_), height_(other.height_), data_(other.begin(), other.end()), ptr_(data_.data()) {}
+    Array_2D(Array_2D&& other) noexcept :
+        width_(std::exchange(other.width_, 0)), height_(std::exchange(other.height_, 0)),
+        data_(std::move(other.data_)), ptr_(std::exchange(other.ptr_, nullptr)), keep_(std::move(other.keep_)) {}
+    Array_2D& operator=(Array_2D other) noexcept {
+        std::swap(width_, other.width_);
+        std::swap(height_, other.height_);
+        data_.swap(other.data_);
+        std::swap(ptr_, other.ptr_);
+        keep_.swap(other.keep_);
+        return *this;
+    }
+
     Type& operator()(int x, int y) {
-        return data_[index(x, y)];
+        return ptr_[index(x, y)];
     }
 
     const Type& operator()(int x, int y) const {
         if (x < 0 || x >= width_ || y < 0 || y >= height_)
             throw std::out_of_range("Array_2D::operator()");
-        return data_[index(x, y)];
+        return ptr_[index(x, y)];
     }
 
     [[nodiscard]] int width() const {
@@ -31,35 +53,39 @@ public:
         return height_;
     }
     Type* data() {
-        return data_.data();
+        return ptr_;
     }
     const Type* data() const {
-        return data_.data();
+        return ptr_;
+    }
+    // dane należą do kogoś innego (konstruktor widoku)
+    [[nodiscard]] bool isView() const {
+        return keep_ != nullptr;
     }
 
     Type* beginRow(int y) {
         if (y >= 0 && y < height_) {
-            return data_.data() + y * width_;
+            return ptr_ + y * width_;
         }
         throw std::out_of_range("Array_2D::beginRow");
     }
 
     Type* endRow(int y) {
         if (y >= 0 && y < height_) {
-            return data_.data() + (y + 1) * width_; // zgodnie z STL zwraca indeks ZA ostatnim elem wiersza
+            return ptr_ + (y + 1) * width_; // zgodnie z STL zwraca indeks ZA ostatnim elem wiersza
         }
         throw std::out_of_range("Array_2D::endRow");
     }
 
     const Type* beginRow(int y) const {
         if (y >= 0 && y < height_) {
-            return data_.data() + y * width_;
+            return ptr_ + y * width_;
         }
         throw std::out_of_range("Array_2D::beginRow");
     }
     const Type* endRow(int y) const {
         if (y >= 0 && y < height_) {
-            return data_.data() + (y + 1) * width_;
+            return ptr_ + (y + 1) * width_;
         }
         throw std::out_of_range("Array_2D::endRow");
     }
@@ -81,27 +107,27 @@ public:
         std::vector<Type> col(height_);
         for (size_t i = 0; i < height_; i++) {
             size_t colIndex = i * width_ + x;
-            col[i] = data_[colIndex];
+            col[i] = ptr_[colIndex];
         }
 
         return col;
     }
 
     Type* begin() {
-        return data_.data();
+        return ptr_;
     }
     Type* end() {
-        return data_.data() + width_ * height_;
+        return ptr_ + static_cast<size_t>(width_) * height_;
     }
     const Type* begin() const {
-        return data_.data();
+        return ptr_;
     }
     const Type* end() const {
-        return data_.data() + width_ * height_;
+        return ptr_ + static_cast<size_t>(width_) * height_;
     }
 
     void fill(Type val) {
-        std::fill(data_.begin(), data_.end(), val);
+        std::fill(begin(), end(), val);
     }
 
     void reset() {
@@ -109,19 +135,19 @@ public:
     }
 
     void assign(int x, int y, const Type& val) {
-        data_[index(x, y)] = val;
+        ptr_[index(x, y)] = val;
     }
 
     auto minVal() const {
-        return std::min_element(data_.begin(), data_.end());
+        return std::min_element(begin(), end());
     }
 
     auto maxVal() const {
-        return std::max_element(data_.begin(), data_.end());
+        return std::max_element(begin(), end());
     }
 
     size_t size() {
-        return data_.size();
+        return static_cast<size_t>(width_) * height_;
     }
 
     void normalize() {
@@ -130,18 +156,20 @@ public:
 
         if (max - min != Type()) {
             std::cout << "Normalizing..." << std::endl;
-            for (Type& val: data_) {
+            for (Type& val: *this) {
                 val = (val - min) / (max - min);
             }
         } else {
-            std::fill(data_.begin(), data_.end(), Type());
+            fill(Type());
             std::cerr << "maxVal, minVal equal. Normalize to zero." << std::endl;
         }
     }
 
 private:
     int width_, height_;
-    std::vector<Type> data_;
+    std::vector<Type> data_;   // puste dla widoku
+    Type* ptr_ = nullptr;      // data_.data() albo pamięć widoku
+    std::shared_ptr<void> keep_;
     [[nodiscard]] int index(int x, int y) const {
         return x + y * width_;
     };
@@ -0,0 +1,48 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_FRUSTUM_HPP
+#define ROLLERCOASTERGL_FRUSTUM_HPP
+
+#include <array>
+#include <glm/glm.hpp>
+
+namespace rc::math {
+    // Płaszczyzny ostrosłupa widzenia z macierzy projection * view (* model) - Gribb/Hartmann, clip GL (-w..w).
+    // dot(plane.xyz, p) + plane.w >= 0 po stronie widocznej; normalne jednostkowe.
+    struct Frustum {
+        std::array<glm::vec4, 6> planes{}; // lewa, prawa, dół, góra, bliska, daleka
+
+        static Frustum fromMatrix(const glm::mat4& m) {
+            const glm::vec4 r0(m[0][0], m[1][0], m[2][0], m[3][0]);
+            const glm::vec4 r1(m[0][1], m[1][1], m[2][1], m[3][1]);
+            const glm::vec4 r2(m[0][2], m[1][2], m[2][2], m[3][2]);
+            const glm::vec4 r3(m[0][3], m[1][3], m[2][3], m[3][3]);
+            Frustum f;
+            f.planes = {r3 + r0, r3 - r0, r3 + r1, r3 - r1, r3 + r2, r3 - r2};
+            for (auto& p: f.planes)
+                p /= glm::length(glm::vec3(p));
+            return f;
+        }
+
+        [[nodiscard]] bool intersectsSphere(const glm::vec3& c, float r) const {
+            for (const auto& p: planes)
+                if (glm::dot(glm::vec3(p), c) + p.w < -r)
+                    return false;
+            return true;
+        }
+
+        // AABB [lo, hi]: poza, gdy wierzchołek najdalej w stronę normalnej jest za którąkolwiek płaszczyzną
+        [[nodiscard]] bool intersectsBox(const glm::vec3& lo, const glm::vec3& hi) const {
+            for (const auto& p: planes) {
+                const glm::vec3 v(p.x >= 0.f ? hi.x : lo.x, p.y >= 0.f ? hi.y : lo.y, p.z >= 0.f ? hi.z : lo.z);
+                if (glm::dot(glm::vec3(p), v) + p.w < 0.f)
+                    return false;
+            }
+            return true;
+        }
+    };
+} // namespace rc::math
+
+#endif // ROLLERCOASTERGL_FRUSTUM_HPP
@@ -28,6 +28,8 @@ namespace rc::physics {
         }
 
         void sample(float sQuery, glm::vec3& pos, glm::vec3& T, glm::vec3& N, glm::vec3& B, glm::quat& q);
+        // indeks ramki początkowej ostatniego sample()
+        [[nodiscard]] std::size_t index() const { return i_; }
 
     private:
         const std::vector<common::Frame>* F_ = nullptr;
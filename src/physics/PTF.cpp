@@ -39,7 +39,8 @@ namespace rc::physics {
         glm::vec3 N0 = glm::normalize(N0_raw);
         glm::vec3 B0 = glm::normalize(glm::cross(T0, N0));
         N0 = glm::normalize(glm::cross(B0, T0));
-        frames.emplace_back(common::Frame{P0, T0, N0, B0, 0.f});
+        // q także na pierwszej ramce - szyny wyciągane w shaderze biorą orientację tylko z niego
+        frames.emplace_back(common::Frame{P0, T0, N0, B0, 0.f, glm::quat_cast(glm::mat3(T0, N0, B0))});
 
         // rotacja wektora styczna względem wektora stycznego w punkcie poprzednim i wyliczenie norm,binorm
         const bool closed = sampler.isClosed();
@@ -0,0 +1,270 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "HeightPyramid.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "common/ThreadPool.hpp"
+
+void HeightPyramid::build(int width, int height, std::span<const float> heights) {
+    width_ = width;
+    height_ = height;
+    nodesX_.clear();
+    nodesZ_.clear();
+    tilesX_.clear();
+    levels_.clear();
+    if (width < 2 || height < 2 || heights.size() < static_cast<std::size_t>(width) * height)
+        return;
+
+    // korzeń (co najmniej poziom 1) to najmniejszy poziom, którego jeden węzeł przykrywa całą mapę
+    const int cellsX = width - 1, cellsZ = height - 1;
+    int top = 1;
+    while ((1 << top) < std::max(cellsX, cellsZ))
+        top++;
+    for (int l = 0; l <= top; l++) {
+        nodesX_.push_back((cellsX + (1 << l) - 1) >> l);
+        nodesZ_.push_back((cellsZ + (1 << l) - 1) >> l);
+        tilesX_.push_back(static_cast<std::size_t>(nodesX_[l] + 3) / 4);
+    }
+    levels_.resize(top);
+
+    auto& pool = rc::common::ThreadPool::shared();
+    std::vector<float> bandMin(pool.chunkCount(height, 64), std::numeric_limits<float>::max());
+    std::vector<float> bandMax(bandMin.size(), std::numeric_limits<float>::lowest());
+    pool.parallelFor(height, 64, [&](std::size_t z0, std::size_t z1, std::size_t band) {
+        const auto [lo, hi] = std::minmax_element(heights.begin() + static_cast<std::ptrdiff_t>(z0 * width),
+                                                  heights.begin() + static_cast<std::ptrdiff_t>(z1 * width));
+        bandMin[band] = *lo;
+        bandMax[band] = *hi;
+    });
+    // krok tak, by q + 1 (zapas na zaokrąglenia) mieściło się w 16 bitach
+    base_ = *std::min_element(bandMin.begin(), bandMin.end());
+    const float range = *std::max_element(bandMax.begin(), bandMax.end()) - base_;
+    step_ = range > 0.0f ? range / 65533.0f : 1.0f;
+    const auto quantLo = [&](float h) {
+        return static_cast<std::uint16_t>(std::clamp(std::floor((h - base_) / step_) - 1.0f, 0.0f, 65535.0f));
+    };
+    const auto quantHi = [&](float h) {
+        return static_cast<std::uint16_t>(std::clamp(std::ceil((h - base_) / step_) + 1.0f, 0.0f, 65535.0f));
+    };
+
+    // poziom 1 z wysokości (3 x 3 wierzchołki, brzeg wspólny z sąsiadem), wyższe z czterech dzieci
+    for (int l = 1; l <= top; l++) {
+        const int nx = nodesX_[l], nz = nodesZ_[l], cnx = nodesX_[l - 1], cnz = nodesZ_[l - 1];
+        const std::size_t tz = (static_cast<std::size_t>(nz) + 3) / 4;
+        auto& dst = levels_[l - 1];
+        Tile empty;
+        empty.lo.fill(0xFFFF);
+        empty.hi.fill(0);
+        dst.assign(tz * tilesX_[l], empty);
+        pool.parallelFor(tz, 16, [&](std::size_t tz0, std::size_t tz1, std::size_t) {
+            for (auto j = static_cast<int>(tz0 * 4); j < std::min(static_cast<int>(tz1 * 4), nz); j++)
+                for (int i = 0; i < nx; i++) {
+                    std::uint16_t qLo, qHi;
+                    if (l == 1) {
+                        float hLo = std::numeric_limits<float>::max(), hHi = std::numeric_limits<float>::lowest();
+                        for (int gz = 2 * j; gz <= std::min(2 * j + 2, cellsZ); gz++) {
+                            const float* row = heights.data() + static_cast<std::size_t>(gz) * width_;
+                            for (int gx = 2 * i; gx <= std::min(2 * i + 2, cellsX); gx++) {
+                                hLo = std::min(hLo, row[gx]);
+                                hHi = std::max(hHi, row[gx]);
+                            }
+                        }
+                        qLo = quantLo(hLo);
+                        qHi = quantHi(hHi);
+                    } else {
+                        qLo = 0xFFFF;
+                        qHi = 0;
+                        for (int cj = 2 * j; cj < std::min(2 * j + 2, cnz); cj++)
+                            for (int ci = 2 * i; ci < std::min(2 * i + 2, cnx); ci++) {
+                                const Tile& c = levels_[l - 2][tileIndex_(l - 1, ci, cj)];
+                                qLo = std::min(qLo, c.lo[(cj & 3) * 4 + (ci & 3)]);
+                                qHi = std::max(qHi, c.hi[(cj & 3) * 4 + (ci & 3)]);
+                            }
+                    }
+                    Tile& t = dst[tileIndex_(l, i, j)];
+                    t.lo[(j & 3) * 4 + (i & 3)] = qLo;
+                    t.hi[(j & 3) * 4 + (i & 3)] = qHi;
+                }
+        });
+    }
+}
+
+std::size_t HeightPyramid::bytes() const {
+    std::size_t n = 0;
+    for (const auto& l: levels_)
+        n += l.capacity() * sizeof(Tile);
+    return n;
+}
+
+bool HeightPyramid::cellHit_(const float* heights, int cx, int cz, const glm::vec3& o, const glm::vec3& d, float t0,
+                             float t1, float& tHit) const {
+    // h(u, v) = h00 + b u + c v + e u v w lokalnych (u, v) oczka. Wzdłuż promienia, z s = t - t0:
+    // f(s) = y - h = A s^2 + B s + C, C = f(t0). Szukamy pierwszego s w [0, t1 - t0] z f(s) <= 0.
+    const float* r0 = heights + static_cast<std::size_t>(cz) * width_;
+    const float* r1 = r0 + width_;
+    const float h00 = r0[cx], h10 = r0[cx + 1], h01 = r1[cx], h11 = r1[cx + 1];
+    const float b = h10 - h00, c = h01 - h00, e = h00 - h10 - h01 + h11;
+    const float u0 = o.x + d.x * t0 - static_cast<float>(cx);
+    const float v0 = o.z + d.z * t0 - static_cast<float>(cz);
+
+    const float C = o.y + d.y * t0 - (h00 + b * u0 + c * v0 + e * u0 * v0);
+    if (C <= 0.0f) {
+        tHit = t0;
+        return true;
+    }
+    const float B = d.y - (b * d.x + c * d.z + e * (u0 * d.z + v0 * d.x));
+    const float A = -e * d.x * d.z;
+    float s;
+    if (A == 0.0f) {
+        if (B >= 0.0f)
+            return false;
+        s = -C / B;
+    } else {
+        const float disc = B * B - 4.0f * A * C;
+        if (disc < 0.0f)
+            return false;
+        // postać stabilna numerycznie; C > 0, więc q != 0
+        const float q = -0.5f * (B + std::copysign(std::sqrt(disc), B));
+        const float ra = std::min(q / A, C / q), rb = std::max(q / A, C / q);
+        if (rb < 0.0f)
+            return false;
+        s = ra >= 0.0f ? ra : rb;
+    }
+    if (s > t1 - t0)
+        return false;
+    tHit = t0 + s;
+    return true;
+}
+
+bool HeightPyramid::raycast(std::span<const float> heights, const glm::vec3& origin, const glm::vec3& dir, float tMax,
+                            float& tHit) const {
+    return trace_(heights.data(), origin, dir, tMax, false, tHit);
+}
+
+bool HeightPyramid::segmentHits(std::span<const float> heights, const glm::vec3& a, const glm::vec3& b) const {
+    float t;
+    return trace_(heights.data(), a, b - a, 1.0f, true, t);
+}
+
+bool HeightPyramid::trace_(const float* heights, const glm::vec3& o, const glm::vec3& d, float tMax, bool anyHit,
+                           float& tHit) const {
+    if (empty())
+        return false;
+    const int top = static_cast<int>(levels_.size());
+    const int cellsX = width_ - 1, cellsZ = height_ - 1;
+    constexpr float kInf = std::numeric_limits<float>::infinity();
+
+    // przycięcie do prostopadłościanu mapy w (x, z) i do wysokości poniżej max korzenia
+    float t0 = 0.0f, t1 = tMax;
+    auto clip = [&](float p, float v, float lo, float hi) {
+        if (v == 0.0f)
+            return p >= lo && p <= hi;
+        float a = (lo - p) / v, b = (hi - p) / v;
+        if (a > b)
+            std::swap(a, b);
+        t0 = std::max(t0, a);
+        t1 = std::min(t1, b);
+        return t0 <= t1;
+    };
+    if (!clip(o.x, d.x, 0.0f, static_cast<float>(cellsX)) || !clip(o.z, d.z, 0.0f, static_cast<float>(cellsZ)) ||
+        !clip(o.y, d.y, -kInf, base_ + static_cast<float>(levels_.back()[0].hi[0]) * step_))
+        return false;
+    // poniżej najniższego punktu mapy promień jest już pod terenem - trafienie najpóźniej tam
+    const float tGround = d.y < 0.0f ? (base_ - o.y) / d.y : kInf;
+    if (tGround <= t0) {
+        tHit = t0;
+        return true;
+    }
+    const bool toGround = tGround < t1;
+    t1 = std::min(t1, tGround);
+
+    // start w najmniejszym węźle, który mieści cały przycięty odcinek
+    const auto cellAt = [&](float t, int& x, int& z) {
+        x = std::clamp(static_cast<int>(o.x + d.x * t), 0, cellsX - 1);
+        z = std::clamp(static_cast<int>(o.z + d.z * t), 0, cellsZ - 1);
+    };
+    int ax, az, bx, bz;
+    cellAt(t0, ax, az);
+    cellAt(t1, bx, bz);
+    int level = 0;
+    while (level < top && ((ax >> level) != (bx >> level) || (az >> level) != (bz >> level)))
+        level++;
+    int cx = ax >> level, cz = az >> level;
+
+    const int sx = d.x >= 0.0f ? 1 : -1, sz = d.z >= 0.0f ? 1 : -1;
+    const float invX = d.x != 0.0f ? 1.0f / d.x : kInf;
+    const float invZ = d.z != 0.0f ? 1.0f / d.z : kInf;
+    const float invY = d.y != 0.0f ? 1.0f / d.y : kInf;
+    float t = t0;
+    for (;;) {
+        // wyjście promienia z węzła (x, z); brzegowe węzły są przycięte do mapy
+        const int size = 1 << level;
+        const auto x0 = static_cast<float>(cx * size), x1 = static_cast<float>(std::min((cx + 1) * size, cellsX));
+        const auto z0 = static_cast<float>(cz * size), z1 = static_cast<float>(std::min((cz + 1) * size, cellsZ));
+        const float tx = d.x > 0.0f ? (x1 - o.x) * invX : d.x < 0.0f ? (x0 - o.x) * invX : kInf;
+        const float tz = d.z > 0.0f ? (z1 - o.z) * invZ : d.z < 0.0f ? (z0 - o.z) * invZ : kInf;
+        const float tOut = std::max(t, std::min(std::min(tx, tz), t1));
+
+        if (level == 0) {
+            if (cellHit_(heights, cx, cz, o, d, t, tOut, tHit))
+                return true;
+        } else {
+            // najniższy i najwyższy punkt promienia nad węzłem są na końcach odcinka
+            const Tile& tile = levels_[level - 1][tileIndex_(level, cx, cz)];
+            const int slot = (cz & 3) * 4 + (cx & 3);
+            const float yIn = o.y + d.y * t, yOut = o.y + d.y * tOut;
+            if (anyHit && std::max(yIn, yOut) < base_ + static_cast<float>(tile.lo[slot]) * step_) {
+                tHit = t;
+                return true;
+            }
+            const float hiH = base_ + static_cast<float>(tile.hi[slot]) * step_;
+            if (std::min(yIn, yOut) <= hiH) {
+                // w dół do dziecka, w którym promień schodzi poniżej max węzła - wcześniej nie może trafić
+                if (d.y < 0.0f)
+                    t = std::clamp((hiH - o.y) * invY, t, tOut);
+                level--;
+                const float halfX = static_cast<float>(cx * size + size / 2);
+                const float halfZ = static_cast<float>(cz * size + size / 2);
+                const float px = o.x + d.x * t, pz = o.z + d.z * t;
+                cx = std::min(2 * cx + (px > halfX || (px == halfX && sx > 0) ? 1 : 0), nodesX_[level] - 1);
+                cz = std::min(2 * cz + (pz > halfZ || (pz == halfZ && sz > 0) ? 1 : 0), nodesZ_[level] - 1);
+                continue;
+            }
+        }
+
+        // węzeł przeskoczony - do sąsiada przez ścianę wyjścia
+        if (tOut >= t1)
+            break;
+        t = tOut;
+        const bool stepX = tx <= tz;
+        cx += stepX ? sx : 0;
+        cz += stepX ? 0 : sz;
+        if (static_cast<unsigned>(cx) >= static_cast<unsigned>(nodesX_[level]) ||
+            static_cast<unsigned>(cz) >= static_cast<unsigned>(nodesZ_[level]))
+            break;
+        // Jeśli weszliśmy do nowego rodzica (pierwsze dziecko w kierunku ruchu), wracamy na jego poziom - wyżej,
+        // bo stary rodzic był już sprawdzony. Kolejne poziomy to kolejne zera (ruch w +) albo jedynki (w -)
+        // od dołu współrzędnej, po której był krok - bez gałęzi na poziom.
+        const auto c = static_cast<unsigned>(stepX ? cx : cz);
+        const bool forward = stepX ? sx > 0 : sz > 0;
+        const int up = std::min(std::countr_zero(forward ? c : ~c), top - level);
+        cx >>= up;
+        cz >>= up;
+        level += up;
+    }
+    if (!toGround)
+        return false;
+    tHit = t1;
+    return true;
+}
@@ -0,0 +1,61 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_HEIGHTPYRAMID_HPP
+#define ROLLERCOASTERGL_HEIGHTPYRAMID_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+// Piramida min/max wysokości do przecięć promień-teren (bez GL). Poziom l to węzły 2^l x 2^l oczek mapy
+// z (min, max) wysokości ich wierzchołków; poziom 0 (pojedyncze oczka) nie jest trzymany - ramkę i dokładne
+// przecięcie daje bezpośrednio czwórka wysokości. Promień zaczyna w najmniejszym węźle, który mieści jego
+// odcinek nad mapą, i schodzi w dół tylko tam, gdzie spada poniżej max węzła - puste przestrzenie nad terenem
+// są przeskakiwane całymi węzłami.
+// Zapytania na dużej mapie czekają głównie na pamięć, więc węzły są małe i blisko siebie: min/max jako 16-bit
+// (zaokrąglone na zewnątrz, z zapasem kroku), w kafelkach 4 x 4 węzły na linię cache - sąsiedzi na drodze
+// promienia i czwórka dzieci węzła leżą zwykle w jednej linii. Koszt: ~1.3 B na wierzchołek mapy.
+class HeightPyramid {
+public:
+    // wymiary siatki wierzchołków i wysokości w świecie (width * height, rzędami)
+    void build(int width, int height, std::span<const float> heights);
+    [[nodiscard]] bool empty() const { return levels_.empty(); }
+    [[nodiscard]] int levels() const { return static_cast<int>(levels_.size()) + 1; }
+    [[nodiscard]] std::size_t bytes() const;
+
+    // Najmniejsze t w [0, tMax], dla którego origin + t * dir leży na powierzchni dwuliniowej
+    // (jak Terrain::sampleHeightBilinear) albo pod nią. heights - te same co w build; poza mapą (x, z)
+    // terenu nie ma. dir nie musi być jednostkowy - t jest w jego długościach.
+    [[nodiscard]] bool raycast(std::span<const float> heights, const glm::vec3& origin, const glm::vec3& dir,
+                               float tMax, float& tHit) const;
+    // czy odcinek a-b dotyka powierzchni; bez szukania pierwszego punktu - kończy się też na węźle,
+    // nad którym odcinek jest cały poniżej min
+    [[nodiscard]] bool segmentHits(std::span<const float> heights, const glm::vec3& a, const glm::vec3& b) const;
+
+private:
+    struct alignas(64) Tile {
+        std::array<std::uint16_t, 16> lo, hi; // węzeł (x & 3, z & 3) pod indeksem (z & 3) * 4 + (x & 3)
+    };
+
+    [[nodiscard]] bool trace_(const float* heights, const glm::vec3& o, const glm::vec3& d, float tMax, bool anyHit,
+                              float& tHit) const;
+    // przecięcie z oczkiem (cx, cz) na odcinku promienia [t0, t1]
+    [[nodiscard]] bool cellHit_(const float* heights, int cx, int cz, const glm::vec3& o, const glm::vec3& d,
+                                float t0, float t1, float& tHit) const;
+    [[nodiscard]] std::size_t tileIndex_(int level, int x, int z) const {
+        return static_cast<std::size_t>(z >> 2) * tilesX_[level] + static_cast<std::size_t>(x >> 2);
+    }
+
+    int width_ = 0, height_ = 0;
+    float base_ = 0.0f, step_ = 1.0f;   // wysokość = base_ + q * step_
+    std::vector<int> nodesX_, nodesZ_;  // [poziom], od 0
+    std::vector<std::size_t> tilesX_;   // [poziom]
+    std::vector<std::vector<Tile>> levels_; // [poziom - 1]
+};
+
+#endif // ROLLERCOASTERGL_HEIGHTPYRAMID_HPP
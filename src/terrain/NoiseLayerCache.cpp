@@ -0,0 +1,124 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "NoiseLayerCache.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+#include "common/ThreadPool.hpp"
+
+std::shared_ptr<const NoiseLayerCache::Layer> NoiseLayerCache::layer(const SimplexNoise& noise, const Key& key,
+                                                                     bool withGrad, rc::common::Progress* progress) {
+    const auto H = static_cast<std::size_t>(key.height);
+    auto find = [&] {
+        return std::find_if(entries_.begin(), entries_.end(), [&](const Entry& e) { return e.key == key; });
+    };
+    auto usable = [&](auto it) { return it != entries_.end() && (!withGrad || !it->layer->dx.empty()); };
+    {
+        std::lock_guard lk(mutex_);
+        clock_++;
+        if (const auto it = find(); usable(it)) {
+            it->lastUse = clock_;
+            stats_.hits++;
+            if (progress)
+                progress->advance(H);
+            return it->layer;
+        }
+    }
+
+    // współrzędne jak w Terrain::generate, mnożenie przez częstotliwość jak w fbmRow
+    const auto W = static_cast<std::size_t>(key.width);
+    auto out = std::make_shared<Layer>();
+    out->value.resize(W * H);
+    if (withGrad) {
+        out->dx.resize(W * H);
+        out->dy.resize(W * H);
+    }
+    std::vector<float> xs(W);
+    for (std::size_t x = 0; x < W; x++)
+        xs[x] = (static_cast<float>(x) * key.scale + key.origin) * key.frequency;
+    rc::common::ThreadPool::shared().parallelFor(H, 8, [&](std::size_t y0, std::size_t y1, std::size_t) {
+        for (std::size_t y = y0; y < y1; y++) {
+            if (progress && progress->cancelled())
+                return;
+            const float fy = (static_cast<float>(y) * key.scale + key.origin) * key.frequency;
+            const std::span<float> row(out->value.data() + y * W, W);
+            if (withGrad)
+                noise.noiseRow(xs, fy, row, std::span<float>(out->dx.data() + y * W, W),
+                               std::span<float>(out->dy.data() + y * W, W));
+            else
+                noise.noiseRow(xs, fy, row);
+            if (progress)
+                progress->advance(1);
+        }
+    });
+    if (progress && progress->cancelled())
+        return nullptr;
+
+    std::lock_guard lk(mutex_);
+    stats_.misses++;
+    const std::size_t bytes = layerBytes(key.width, key.height, withGrad);
+    // w międzyczasie mógł ją policzyć inny wątek - wpis bez potrzebnego gradientu zastępuje ta
+    if (const auto it = find(); it != entries_.end()) {
+        if (!usable(it)) {
+            bytes_ += bytes - it->bytes;
+            it->layer = out;
+            it->bytes = bytes;
+        }
+        it->lastUse = clock_;
+    } else {
+        entries_.push_back({key, out, bytes, clock_});
+        bytes_ += bytes;
+    }
+    trim_();
+    return out;
+}
+
+void NoiseLayerCache::setBudget(std::size_t bytes) {
+    std::lock_guard lk(mutex_);
+    budget_ = bytes;
+    trim_();
+}
+
+std::size_t NoiseLayerCache::budget() const {
+    std::lock_guard lk(mutex_);
+    return budget_;
+}
+
+std::size_t NoiseLayerCache::bytes() const {
+    std::lock_guard lk(mutex_);
+    return bytes_;
+}
+
+std::size_t NoiseLayerCache::size() const {
+    std::lock_guard lk(mutex_);
+    return entries_.size();
+}
+
+NoiseLayerCache::Stats NoiseLayerCache::stats() const {
+    std::lock_guard lk(mutex_);
+    return stats_;
+}
+
+void NoiseLayerCache::clear() {
+    std::lock_guard lk(mutex_);
+    entries_.clear();
+    bytes_ = 0;
+}
+
+void NoiseLayerCache::trim_() {
+    // najświeższy wpis zostaje nawet ponad budżetem - to ten, o który właśnie proszono
+    while (bytes_ > budget_ && entries_.size() > 1) {
+        auto oldest = std::min_element(entries_.begin(), entries_.end(),
+                                       [](const Entry& a, const Entry& b) { return a.lastUse < b.lastUse; });
+        bytes_ -= oldest->bytes;
+        entries_.erase(oldest);
+        stats_.evicted++;
+    }
+}
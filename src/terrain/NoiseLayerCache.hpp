@@ -0,0 +1,77 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_NOISELAYERCACHE_HPP
+#define ROLLERCOASTERGL_NOISELAYERCACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "SimplexNoise.hpp"
+#include "common/Progress.hpp"
+
+// Warstwy oktaw fBm dla całej mapy: surowy szum jednej oktawy (i jego gradient) w punktach siatki.
+// Warstwa zależy tylko od ziarna, wymiarów, skali, początku układu i częstotliwości oktawy - wysokość,
+// wykładnik, persystencja i liczba oktaw składają mapę z tych samych warstw, a kolejna oktawa liczy tylko
+// siebie. Najdawniej używane warstwy wypadają po przekroczeniu budżetu.
+// Bezpieczna między wątkami (generate w tle, statystyki w UI); warstwa liczona jest poza blokadą.
+class NoiseLayerCache {
+public:
+    struct Key {
+        int seed = 0;
+        int width = 0, height = 0;
+        float scale = 0.0f;
+        float origin = 0.0f;    // punkt siatki (x, y) leży w (x, y) * scale + origin
+        float frequency = 0.0f; // frequency * lacunarity^o tej oktawy, liczone jak w fbmRow
+        bool operator==(const Key&) const = default;
+    };
+    struct Layer {
+        std::vector<float> value;  // noise(x * f, y * f), rzędami
+        std::vector<float> dx, dy; // surowy gradient albo puste
+    };
+    struct Stats {
+        std::size_t hits = 0;
+        std::size_t misses = 0;
+        std::size_t evicted = 0;
+    };
+
+    explicit NoiseLayerCache(std::size_t budgetBytes = std::size_t{512} << 20) : budget_(budgetBytes) {}
+
+    // Warstwa dla klucza; brakująca albo bez potrzebnego gradientu liczona teraz (wiersze w puli wątków).
+    // progress dostaje height wierszy warstwy (od razu, gdy jest w pamięci); po cancel - nullptr.
+    [[nodiscard]] std::shared_ptr<const Layer> layer(const SimplexNoise& noise, const Key& key, bool withGrad,
+                                                     rc::common::Progress* progress = nullptr);
+    // bajty warstwy o tych wymiarach - do decyzji, czy zestaw oktaw zmieści się w budżecie
+    [[nodiscard]] static std::size_t layerBytes(int width, int height, bool withGrad) {
+        return static_cast<std::size_t>(width) * height * sizeof(float) * (withGrad ? 3 : 1);
+    }
+
+    void setBudget(std::size_t bytes);
+    [[nodiscard]] std::size_t budget() const;
+    [[nodiscard]] std::size_t bytes() const;
+    [[nodiscard]] std::size_t size() const;
+    [[nodiscard]] Stats stats() const;
+    void clear();
+
+private:
+    struct Entry {
+        Key key;
+        std::shared_ptr<const Layer> layer;
+        std::size_t bytes = 0;
+        std::uint64_t lastUse = 0;
+    };
+    void trim_();
+
+    mutable std::mutex mutex_;
+    std::size_t budget_;
+    std::size_t bytes_ = 0;
+    std::uint64_t clock_ = 0;
+    std::vector<Entry> entries_; // kilkanaście wpisów - wyszukiwanie liniowe
+    Stats stats_;
+};
+
+#endif // ROLLERCOASTERGL_NOISELAYERCACHE_HPP
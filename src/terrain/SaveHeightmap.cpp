@@ -3,20 +3,457 @@
 //
 #include "SaveHeightmap.hpp"
 
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <fstream>
+#include <iomanip>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "common/ThreadPool.hpp"
 #include "math/Array_2D.hpp"
 
+static_assert(std::endian::native == std::endian::little, "formaty raw16/PFM/.rchm zapisywane wprost z pamięci");
+
+namespace {
+    constexpr int kBandRows = 64;          // wiersze na porcję konwersji i zapisu
+    constexpr std::size_t kPageBytes = 4096; // wyrównanie danych .rchm
+
+    [[noreturn]] void fail(const std::string& what, const std::string& filename) {
+        throw std::runtime_error(what + ": " + filename);
+    }
+
+    // Plik zmapowany prywatnie (kopia przy zapisie): zapisy do widoku nie trafiają do pliku.
+    // keep zwalnia mapowanie, gdy zniknie ostatni widok.
+    struct Mapping {
+        std::byte* data = nullptr;
+        std::size_t size = 0;
+        std::shared_ptr<void> keep;
+    };
+
+    Mapping mapFile(const std::string& filename) {
+        Mapping m;
+#ifdef _WIN32
+        // bez mmap - plik czytany w całości
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+            fail("cannot open heightmap", filename);
+        auto bytes = std::make_shared<std::vector<std::byte>>();
+        file.seekg(0, std::ios::end);
+        bytes->resize(static_cast<std::size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(bytes->data()), static_cast<std::streamsize>(bytes->size()));
+        if (!file)
+            fail("cannot read heightmap", filename);
+        m.data = bytes->data();
+        m.size = bytes->size();
+        m.keep = std::move(bytes);
+#else
+        const int fd = ::open(filename.c_str(), O_RDONLY);
+        if (fd < 0)
+            fail("cannot open heightmap", filename);
+        struct stat st{};
+        if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+            ::close(fd);
+            fail("empty heightmap", filename);
+        }
+        m.size = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(nullptr, m.size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED)
+            fail("cannot map heightmap", filename);
+        m.data = static_cast<std::byte*>(p);
+        m.keep = std::shared_ptr<void>(p, [size = m.size](void* q) { ::munmap(q, size); });
+#endif
+        return m;
+    }
+
+    // Zapis do filename.tmp i rename na koniec: stary plik (nowy inode) nie jest obcinany, więc widoki
+    // z loadTiled na nim zostają ważne, a przerwany zapis nie niszczy poprzedniej mapy.
+    std::string tmpName(const std::string& filename) { return filename + ".tmp"; }
+
+    std::ofstream openOut(const std::string& filename) {
+        std::ofstream file(tmpName(filename), std::ios::binary | std::ios::trunc);
+        if (!file)
+            fail("cannot create heightmap", filename);
+        return file;
+    }
+
+    void discardOut(std::ofstream& file, const std::string& filename) {
+        file.close();
+        std::error_code ec;
+        std::filesystem::remove(tmpName(filename), ec);
+    }
+
+    void closeOut(std::ofstream& file, const std::string& filename) {
+        file.close();
+        if (!file) {
+            discardOut(file, filename);
+            fail("cannot write heightmap", filename);
+        }
+        // filesystem::rename podmienia istniejący plik także na Windows
+        std::error_code ec;
+        std::filesystem::rename(tmpName(filename), filename, ec);
+        if (ec) {
+            discardOut(file, filename);
+            fail("cannot replace heightmap", filename);
+        }
+    }
+
+    std::uint16_t swap16(std::uint16_t v) { return static_cast<std::uint16_t>((v << 8) | (v >> 8)); }
+    float swapFloat(float f) {
+        const auto v = std::bit_cast<std::uint32_t>(f);
+        return std::bit_cast<float>((v << 24) | ((v << 8) & 0x00ff0000u) | ((v >> 8) & 0x0000ff00u) | (v >> 24));
+    }
+
+    std::uint16_t quantize(float h, HeightRange r) {
+        const float n = (h - r.min) / (r.max - r.min);
+        return static_cast<std::uint16_t>(std::lround(std::clamp(n, 0.0f, 1.0f) * 65535.0f));
+    }
+
+    // cała tablica jako uint16 (bigEndian - PGM), porcjami po kBandRows wierszy
+    void writeQuantized(std::ofstream& file, const Array_2D<float>& arr, HeightRange r, bool bigEndian) {
+        const auto W = static_cast<std::size_t>(arr.width());
+        std::vector<std::uint16_t> band(W * kBandRows);
+        for (int y0 = 0; y0 < arr.height(); y0 += kBandRows) {
+            const int rows = std::min(kBandRows, arr.height() - y0);
+            const float* src = arr.beginRow(y0);
+            for (std::size_t i = 0; i < W * rows; i++) {
+                const std::uint16_t q = quantize(src[i], r);
+                band[i] = bigEndian ? swap16(q) : q;
+            }
+            file.write(reinterpret_cast<const char*>(band.data()), static_cast<std::streamsize>(W * rows * 2));
+        }
+    }
+
+    // Nagłówek PNM/PFM: tokeny rozdzielone białymi znakami, komentarze od '#' do końca linii.
+    // Po ostatnim tokenie dokładnie jeden biały znak, potem dane.
+    struct PnmHeader {
+        PnmHeader(const Mapping& mapping, const std::string& name) : m(mapping), filename(name) {}
+
+        const Mapping& m;
+        const std::string& filename;
+        std::size_t pos = 0;
+        bool hasRange = false;
+        HeightRange range;
+
+        std::string token() {
+            for (;;) {
+                while (pos < m.size && std::isspace(static_cast<unsigned char>(m.data[pos])))
+                    pos++;
+                if (pos < m.size && static_cast<char>(m.data[pos]) == '#') {
+                    const std::size_t start = pos;
+                    while (pos < m.size && static_cast<char>(m.data[pos]) != '\n')
+                        pos++;
+                    comment(std::string(reinterpret_cast<const char*>(m.data) + start, pos - start));
+                    continue;
+                }
+                break;
+            }
+            const std::size_t start = pos;
+            while (pos < m.size && !std::isspace(static_cast<unsigned char>(m.data[pos])))
+                pos++;
+            if (start == pos)
+                fail("truncated heightmap header", filename);
+            return {reinterpret_cast<const char*>(m.data) + start, pos - start};
+        }
+        int integer() {
+            const std::string t = token();
+            try {
+                return std::stoi(t);
+            } catch (const std::exception&) {
+                fail("bad heightmap header value '" + t + "'", filename);
+            }
+        }
+        // przesunięcie danych po ostatnim tokenie
+        std::size_t dataStart() const { return pos + 1; }
+
+        void comment(const std::string& c) {
+            float lo = 0.0f, hi = 0.0f;
+            if (std::sscanf(c.c_str(), "# height_range %f %f", &lo, &hi) == 2) {
+                hasRange = true;
+                range = {lo, hi};
+            }
+        }
+    };
+
+    void checkSize(int width, int height, const std::string& filename) {
+        if (width <= 0 || height <= 0 || width > (1 << 20) || height > (1 << 20))
+            fail("bad heightmap size", filename);
+    }
+} // namespace
+
+HeightRange heightRangeOf(const Array_2D<float>& arr) {
+    const auto [lo, hi] = std::minmax_element(arr.begin(), arr.end());
+    if (lo == arr.end())
+        return {};
+    return {*lo, *hi > *lo ? *hi : *lo + 1.0f};
+}
 
 void savePGM(const Array_2D<float>& arr, const std::string& filename) {
-    std::ofstream file(filename);
-    file << "P2\n" << arr.width() << " " << arr.height() << "\n255\n";
-    for (int y = 0; y < arr.height(); y++) {
-        for (int x = 0; x < arr.width(); x++) {
-            int value = static_cast<int>(arr(x, y) * 255.0f);
-            file << value << " ";
+    const HeightRange r = heightRangeOf(arr);
+    auto file = openOut(filename);
+    file << "P5\n# height_range " << std::setprecision(std::numeric_limits<float>::max_digits10) << r.min << " "
+         << r.max << "\n" << arr.width() << " " << arr.height() << "\n65535\n";
+    writeQuantized(file, arr, r, true);
+    closeOut(file, filename);
+}
+
+void saveRaw16(const Array_2D<float>& arr, const std::string& filename, HeightRange range) {
+    auto file = openOut(filename);
+    writeQuantized(file, arr, range, false);
+    closeOut(file, filename);
+}
+
+void savePFM(const Array_2D<float>& arr, const std::string& filename) {
+    auto file = openOut(filename);
+    file << "Pf\n" << arr.width() << " " << arr.height() << "\n-1.0\n";
+    const auto rowBytes = static_cast<std::streamsize>(arr.width() * sizeof(float));
+    for (int y = arr.height() - 1; y >= 0; y--)
+        file.write(reinterpret_cast<const char*>(arr.beginRow(y)), rowBytes);
+    closeOut(file, filename);
+}
+
+void saveTiled(const Array_2D<float>& arr, const std::string& filename, int tileSize) {
+    TiledHeightmapWriter writer(filename, arr.width(), arr.height(), tileSize);
+    for (int y0 = 0; y0 < arr.height(); y0 += kBandRows)
+        writer.writeRows(arr.beginRow(y0), std::min(kBandRows, arr.height() - y0));
+    writer.finish();
+}
+
+Array_2D<float> loadPGM(const std::string& filename, HeightRange fallback) {
+    const Mapping m = mapFile(filename);
+    PnmHeader hdr(m, filename);
+    if (hdr.token() != "P5")
+        fail("not a binary PGM (P5)", filename);
+    const int W = hdr.integer(), H = hdr.integer(), maxVal = hdr.integer();
+    checkSize(W, H, filename);
+    if (maxVal <= 0 || maxVal > 65535)
+        fail("bad PGM maxval", filename);
+    const std::size_t bpp = maxVal > 255 ? 2 : 1;
+    const std::size_t offset = hdr.dataStart();
+    if (offset + static_cast<std::size_t>(W) * H * bpp > m.size)
+        fail("truncated PGM", filename);
+
+    const HeightRange r = hdr.hasRange ? hdr.range : fallback;
+    const float step = (r.max - r.min) / static_cast<float>(maxVal);
+    Array_2D<float> out(W, H);
+    rc::common::ThreadPool::shared().parallelFor(H, kBandRows, [&](std::size_t y0, std::size_t y1, std::size_t) {
+        for (std::size_t y = y0; y < y1; y++) {
+            const std::byte* src = m.data + offset + y * W * bpp;
+            float* dst = out.beginRow(static_cast<int>(y));
+            for (int x = 0; x < W; x++) {
+                // 16-bit w PGM zawsze big-endian
+                const unsigned v = bpp == 2 ? (std::to_integer<unsigned>(src[2 * x]) << 8) |
+                                                      std::to_integer<unsigned>(src[2 * x + 1])
+                                            : std::to_integer<unsigned>(src[x]);
+                dst[x] = r.min + static_cast<float>(v) * step;
+            }
         }
-        file << "\n";
+    });
+    return out;
+}
+
+Array_2D<float> loadRaw16(const std::string& filename, HeightRange range, int width, int height) {
+    const Mapping m = mapFile(filename);
+    const std::size_t count = m.size / 2;
+    if (width == 0 && height == 0) {
+        width = height = static_cast<int>(std::lround(std::sqrt(static_cast<double>(count))));
+        if (static_cast<std::size_t>(width) * height != count)
+            fail("raw16 heightmap is not square", filename);
+    }
+    checkSize(width, height, filename);
+    if (static_cast<std::size_t>(width) * height * 2 != m.size)
+        fail("raw16 size does not match dimensions", filename);
+
+    const float step = (range.max - range.min) / 65535.0f;
+    const auto* src = reinterpret_cast<const std::uint16_t*>(m.data);
+    Array_2D<float> out(width, height);
+    rc::common::ThreadPool::shared().parallelFor(height, kBandRows, [&](std::size_t y0, std::size_t y1, std::size_t) {
+        const std::size_t W = width;
+        for (std::size_t i = y0 * W; i < y1 * W; i++)
+            out.data()[i] = range.min + static_cast<float>(src[i]) * step;
+    });
+    return out;
+}
+
+Array_2D<float> loadPFM(const std::string& filename) {
+    const Mapping m = mapFile(filename);
+    PnmHeader hdr(m, filename);
+    const std::string magic = hdr.token();
+    if (magic != "Pf")
+        fail(magic == "PF" ? "color PFM not supported" : "not a grayscale PFM (Pf)", filename);
+    const int W = hdr.integer(), H = hdr.integer();
+    checkSize(W, H, filename);
+    const std::string scaleTok = hdr.token();
+    const bool bigEndian = std::strtof(scaleTok.c_str(), nullptr) > 0.0f;
+    const std::size_t offset = hdr.dataStart();
+    if (offset + static_cast<std::size_t>(W) * H * sizeof(float) > m.size)
+        fail("truncated PFM", filename);
+
+    // wiersze w pliku od dołu; memcpy, bo przesunięcie danych nie musi być wyrównane
+    Array_2D<float> out(W, H);
+    rc::common::ThreadPool::shared().parallelFor(H, kBandRows, [&](std::size_t y0, std::size_t y1, std::size_t) {
+        for (std::size_t y = y0; y < y1; y++) {
+            float* dst = out.beginRow(static_cast<int>(y));
+            std::memcpy(dst, m.data + offset + (H - 1 - y) * W * sizeof(float), W * sizeof(float));
+            if (bigEndian)
+                for (int x = 0; x < W; x++)
+                    dst[x] = swapFloat(dst[x]);
+        }
+    });
+    return out;
+}
+
+namespace {
+    TiledHeightmapHeader parseTiledHeader(const std::byte* data, std::size_t size, const std::string& filename) {
+        TiledHeightmapHeader h;
+        if (size < sizeof(h))
+            fail("truncated .rchm header", filename);
+        std::memcpy(&h, data, sizeof(h));
+        if (std::memcmp(h.magic, "RCHM", 4) != 0)
+            fail("not a .rchm heightmap", filename);
+        if (h.version != 1)
+            fail("unsupported .rchm version", filename);
+        checkSize(static_cast<int>(h.width), static_cast<int>(h.height), filename);
+        const std::size_t tiles = static_cast<std::size_t>(h.tilesX) * h.tilesY;
+        if (h.tileSize == 0 || h.tilesX != (h.width + h.tileSize - 1) / h.tileSize ||
+            h.tilesY != (h.height + h.tileSize - 1) / h.tileSize || h.dataOffset % alignof(float) != 0 ||
+            h.dataOffset < sizeof(h) + tiles * 2 * sizeof(float))
+            fail("corrupt .rchm header", filename);
+        return h;
+    }
+} // namespace
+
+TiledHeightmapHeader readTiledHeader(const std::string& filename, std::vector<float>* tileRanges) {
+    std::ifstream file(filename, std::ios::binary);
+    if (!file)
+        fail("cannot open heightmap", filename);
+    std::byte raw[sizeof(TiledHeightmapHeader)]{};
+    file.read(reinterpret_cast<char*>(raw), sizeof(raw));
+    const TiledHeightmapHeader h = parseTiledHeader(raw, static_cast<std::size_t>(file.gcount()), filename);
+    if (tileRanges) {
+        tileRanges->resize(static_cast<std::size_t>(h.tilesX) * h.tilesY * 2);
+        file.read(reinterpret_cast<char*>(tileRanges->data()),
+                  static_cast<std::streamsize>(tileRanges->size() * sizeof(float)));
+        if (!file)
+            fail("truncated .rchm tile table", filename);
+    }
+    return h;
+}
+
+Array_2D<float> loadTiled(const std::string& filename) {
+    Mapping m = mapFile(filename);
+    const TiledHeightmapHeader h = parseTiledHeader(m.data, m.size, filename);
+    if (h.dataOffset + static_cast<std::size_t>(h.width) * h.height * sizeof(float) > m.size)
+        fail("truncated .rchm data", filename);
+    // bez kopii: strony czytane przy pierwszym dotknięciu
+    return {static_cast<int>(h.width), static_cast<int>(h.height), reinterpret_cast<float*>(m.data + h.dataOffset),
+            std::move(m.keep)};
+}
+
+Array_2D<float> loadHeightmap(const std::string& filename, HeightRange range) {
+    char magic[4]{};
+    {
+        std::ifstream file(filename, std::ios::binary);
+        if (!file)
+            fail("cannot open heightmap", filename);
+        file.read(magic, sizeof(magic));
+    }
+    // niedokończony .rchm (bez nagłówka) ma zgłosić błąd .rchm, a nie rozmiaru raw16
+    const bool rchmName = filename.size() >= 5 && filename.compare(filename.size() - 5, 5, ".rchm") == 0;
+    if (std::memcmp(magic, "RCHM", 4) == 0 || rchmName)
+        return loadTiled(filename);
+    if (magic[0] == 'P' && magic[1] == '5')
+        return loadPGM(filename, range);
+    if (magic[0] == 'P' && (magic[1] == 'f' || magic[1] == 'F'))
+        return loadPFM(filename);
+    return loadRaw16(filename, range);
+}
+
+TiledHeightmapWriter::TiledHeightmapWriter(const std::string& filename, int width, int height, int tileSize) :
+    filename_(filename) {
+    checkSize(width, height, filename);
+    if (tileSize <= 0)
+        fail("bad .rchm tile size", filename);
+    header_.width = width;
+    header_.height = height;
+    header_.tileSize = tileSize;
+    header_.tilesX = (width + tileSize - 1) / tileSize;
+    header_.tilesY = (height + tileSize - 1) / tileSize;
+    const std::size_t tiles = static_cast<std::size_t>(header_.tilesX) * header_.tilesY;
+    const std::size_t tableEnd = sizeof(header_) + tiles * 2 * sizeof(float);
+    header_.dataOffset = static_cast<std::uint32_t>((tableEnd + kPageBytes - 1) / kPageBytes * kPageBytes);
+    tileRanges_.resize(tiles * 2);
+    for (std::size_t t = 0; t < tiles; t++) {
+        tileRanges_[2 * t] = std::numeric_limits<float>::max();
+        tileRanges_[2 * t + 1] = std::numeric_limits<float>::lowest();
+    }
+
+    // nagłówek zerami aż do finish(); plik tymczasowy zastępuje docelowy dopiero w finish()
+    file_ = openOut(filename);
+    const std::vector<char> zeros(header_.dataOffset, 0);
+    file_.write(zeros.data(), static_cast<std::streamsize>(zeros.size()));
+}
+
+TiledHeightmapWriter::~TiledHeightmapWriter() {
+    if (!finished_)
+        discardOut(file_, filename_);
+}
+
+void TiledHeightmapWriter::writeRows(const float* rows, int count) {
+    if (finished_ || count < 0 || rows_ + count > static_cast<int>(header_.height))
+        fail(".rchm rows past the end", filename_);
+    const std::size_t W = header_.width, T = header_.tileSize;
+    for (int r = 0; r < count; r++) {
+        const float* row = rows + r * W;
+        float* range = tileRanges_.data() + (rows_ + r) / T * header_.tilesX * 2;
+        for (std::size_t x0 = 0, t = 0; x0 < W; x0 += T, t++) {
+            const auto [lo, hi] = std::minmax_element(row + x0, row + std::min(x0 + T, W));
+            range[2 * t] = std::min(range[2 * t], *lo);
+            range[2 * t + 1] = std::max(range[2 * t + 1], *hi);
+        }
+    }
+    file_.write(reinterpret_cast<const char*>(rows), static_cast<std::streamsize>(W * count * sizeof(float)));
+    if (!file_) {
+        discardOut(file_, filename_);
+        fail("cannot write heightmap", filename_);
+    }
+    rows_ += count;
+}
+
+void TiledHeightmapWriter::finish() {
+    if (finished_)
+        return;
+    if (rows_ != static_cast<int>(header_.height))
+        fail(".rchm finished before all rows were written", filename_);
+    header_.minH = std::numeric_limits<float>::max();
+    header_.maxH = std::numeric_limits<float>::lowest();
+    for (std::size_t t = 0; t < tileRanges_.size(); t += 2) {
+        header_.minH = std::min(header_.minH, tileRanges_[t]);
+        header_.maxH = std::max(header_.maxH, tileRanges_[t + 1]);
     }
-    file.close();
+    file_.seekp(0);
+    file_.write(reinterpret_cast<const char*>(&header_), sizeof(header_));
+    file_.write(reinterpret_cast<const char*>(tileRanges_.data()),
+                static_cast<std::streamsize>(tileRanges_.size() * sizeof(float)));
+    closeOut(file_, filename_);
+    finished_ = true;
 }
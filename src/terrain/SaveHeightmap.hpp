@@ -5,8 +5,86 @@
 #ifndef SAVEHEIGHTMAP_HPP
 #define SAVEHEIGHTMAP_HPP
 
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
 #include "math/Array_2D.hpp"
 
+// Wysokości w świecie <-> pliki. Formaty 16-bit trzymają wartości w [min, max] (PGM zapisuje zakres
+// w komentarzu "# height_range min max"), PFM i natywny .rchm - float32 bez strat. Wczytywanie przez mmap:
+// .rchm trafia do Array_2D bez kopii (widok na zmapowany plik), pozostałe są konwertowane z mapowania
+// w puli wątków. Zapis idzie do "<plik>.tmp" i na końcu zastępuje plik przez rename - eksport na plik,
+// z którego wczytano widok .rchm, nie narusza tego widoku. Błędy - std::runtime_error z nazwą pliku.
+
+struct HeightRange {
+    float min = 0.0f, max = 1.0f;
+};
+
+// zakres wartości tablicy (min == max rozszerzone o 1, żeby kwantyzacja nie dzieliła przez zero)
+[[nodiscard]] HeightRange heightRangeOf(const Array_2D<float>& arr);
+
+// P5, 16-bit big-endian jak w specyfikacji PGM, zakres wysokości w komentarzu nagłówka
 void savePGM(const Array_2D<float>& arr, const std::string& filename);
+// surowe uint16 little-endian rzędami, bez nagłówka (wymiary i zakres zna wczytujący)
+void saveRaw16(const Array_2D<float>& arr, const std::string& filename, HeightRange range);
+// "Pf", float32 little-endian (skala -1), wiersze od dołu jak w specyfikacji PFM
+void savePFM(const Array_2D<float>& arr, const std::string& filename);
+// natywny .rchm przez TiledHeightmapWriter
+void saveTiled(const Array_2D<float>& arr, const std::string& filename, int tileSize = 256);
+
+// P5 8- lub 16-bit; bez komentarza z zakresem wysokości dostają fallback
+[[nodiscard]] Array_2D<float> loadPGM(const std::string& filename, HeightRange fallback = {});
+// width = height = 0 - mapa kwadratowa z rozmiaru pliku
+[[nodiscard]] Array_2D<float> loadRaw16(const std::string& filename, HeightRange range, int width = 0,
+                                        int height = 0);
+[[nodiscard]] Array_2D<float> loadPFM(const std::string& filename);
+[[nodiscard]] Array_2D<float> loadTiled(const std::string& filename);
+// format po sygnaturze ("P5", "Pf", "RCHM"); reszta jako kwadratowy raw16 z zakresem range
+[[nodiscard]] Array_2D<float> loadHeightmap(const std::string& filename, HeightRange range = {});
+
+// Natywny format .rchm: nagłówek, tabela (min, max) kafelków tileSize x tileSize (rzędami kafelków)
+// i od przesunięcia wyrównanego do 4 KiB float32 little-endian rzędami - całość mapowana wprost do Array_2D.
+// Kafelki wyznaczają tylko tabelę zakresów i porcje zapisu, dane zostają ciągłe.
+struct TiledHeightmapHeader {
+    char magic[4] = {'R', 'C', 'H', 'M'};
+    std::uint32_t version = 1;
+    std::uint32_t width = 0, height = 0;
+    std::uint32_t tileSize = 0;
+    std::uint32_t tilesX = 0, tilesY = 0;
+    std::uint32_t dataOffset = 0; // bajty od początku pliku
+    float minH = 0.0f, maxH = 0.0f;
+};
+static_assert(sizeof(TiledHeightmapHeader) == 40);
+
+// nagłówek i zakresy kafelków (2 floaty na kafelek) bez mapowania danych
+[[nodiscard]] TiledHeightmapHeader readTiledHeader(const std::string& filename,
+                                                   std::vector<float>* tileRanges = nullptr);
+
+// Zapis .rchm strumieniowo: wiersze w dowolnych porcjach (np. pasy z generate), w pamięci tylko zakresy
+// kafelków. finish() dopisuje nagłówek i podmienia plik docelowy; writer zniszczony bez finish() usuwa
+// plik tymczasowy, a docelowy zostaje nietknięty.
+class TiledHeightmapWriter {
+public:
+    TiledHeightmapWriter(const std::string& filename, int width, int height, int tileSize = 256);
+    ~TiledHeightmapWriter();
+    TiledHeightmapWriter(const TiledHeightmapWriter&) = delete;
+    TiledHeightmapWriter& operator=(const TiledHeightmapWriter&) = delete;
+
+    // count kolejnych wierszy po width wartości
+    void writeRows(const float* rows, int count);
+    // wszystkie wiersze zapisane - nagłówek i tabela kafelków
+    void finish();
+    [[nodiscard]] int rowsWritten() const { return rows_; }
+
+private:
+    std::string filename_;
+    std::ofstream file_;
+    TiledHeightmapHeader header_;
+    std::vector<float> tileRanges_;
+    int rows_ = 0;
+    bool finished_ = false;
+};
 
 #endif // SAVEHEIGHTMAP_HPP
@@ -5,86 +5,504 @@
 #include "SimplexNoise.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <random>
 #include <vector>
 
+#include "common/SimdTarget.hpp"
 #include "glm/glm.hpp"
 
 constexpr float F2 = 0.36602540378f; // (sqrt(3)-1)/2
 constexpr float G2 = 0.2113248654f; // (3-sqrt(3))/6
 
+namespace {
+    // Jedna definicja szumu dla wszystkich ścieżek: te same działania w tej samej kolejności, t^4 jako
+    // (t*t)^2 we float i max(t, 0) zamiast gałęzi - pasy SIMD dają dokładnie bity noiseScalar.
+    // Bez FMA: target "avx2" nie włącza "fma", a plik (jak TerrainGenerate i NoiseLayerCache) idzie
+    // z -ffp-contract=off - inaczej przy -march=native kompilator łączy mnożenia z dodawaniem.
+    // Grad = true liczy też pochodną analitycznie: przesunięcia d narożników zmieniają się z (x, y)
+    // jak 1:1, więc d(w^4 * dot)/dd = w^4 * g - 8 w^3 * dot * d.
+    struct Tables {
+        const int* perm;
+        const float* gx;
+        const float* gy;
+    };
+
+    template <bool Grad>
+    float cornerScalar(float cx, float cy, float gx, float gy, float& ddx, float& ddy) {
+        const float dot = gx * cx + gy * cy;
+        const float w = std::max(0.5f - cx * cx - cy * cy, 0.0f);
+        const float w2 = w * w;
+        const float w4 = w2 * w2;
+        if constexpr (Grad) {
+            const float k = w2 * w * dot * 8.0f;
+            ddx = w4 * gx - k * cx;
+            ddy = w4 * gy - k * cy;
+        }
+        return w4 * dot;
+    }
+
+    template <bool Grad>
+    float noiseScalar(const Tables& tb, float x, float y, float* dx = nullptr, float* dy = nullptr) {
+        // skewing
+        const float s = (x + y) * F2;
+        const int i = static_cast<int>(std::floor(x + s));
+        const int j = static_cast<int>(std::floor(y + s));
+
+        // unskewing
+        const float t = static_cast<float>(i + j) * G2;
+        const float x0 = x - (static_cast<float>(i) - t);
+        const float y0 = y - (static_cast<float>(j) - t);
+
+        const int i1 = x0 > y0 ? 1 : 0;
+        const int j1 = 1 - i1;
+
+        const int ii = i & 255;
+        const int jj = j & 255;
+
+        const int gi0 = tb.perm[ii + tb.perm[jj]] & 15;
+        const int gi1 = tb.perm[ii + i1 + tb.perm[jj + j1]] & 15;
+        const int gi2 = tb.perm[ii + 1 + tb.perm[jj + 1]] & 15;
+
+        const float x1 = x0 - static_cast<float>(i1) + G2;
+        const float y1 = y0 - static_cast<float>(j1) + G2;
+        const float x2 = x0 - 1.0f + 2 * G2;
+        const float y2 = y0 - 1.0f + 2 * G2;
+
+        float d0x = 0, d0y = 0, d1x = 0, d1y = 0, d2x = 0, d2y = 0;
+        const float c0 = cornerScalar<Grad>(x0, y0, tb.gx[gi0], tb.gy[gi0], d0x, d0y);
+        const float c1 = cornerScalar<Grad>(x1, y1, tb.gx[gi1], tb.gy[gi1], d1x, d1y);
+        const float c2 = cornerScalar<Grad>(x2, y2, tb.gx[gi2], tb.gy[gi2], d2x, d2y);
+        if constexpr (Grad) {
+            *dx = 70.0f * (d0x + d1x + d2x);
+            *dy = 70.0f * (d0y + d1y + d2y);
+        }
+        return 70.0f * (c0 + c1 + c2);
+    }
+
+    // suma oktaw jak w SimplexNoise::fbm; pochodna oktawy skalowana amplitudą i częstotliwością,
+    // do gradOctaves pierwszych oktaw
+    template <bool Grad>
+    float fbmScalar(const Tables& tb, float x, float y, float frequency, int octaves, float lacunarity,
+                    float persistence, int gradOctaves = 0, float* dx = nullptr, float* dy = nullptr) {
+        float total = 0.0f, gx = 0.0f, gy = 0.0f;
+        float amplitude = 1.0f;
+        for (int i = 0; i < octaves; i++) {
+            float ndx = 0.0f, ndy = 0.0f;
+            total += noiseScalar<Grad>(tb, x * frequency, y * frequency, &ndx, &ndy) * amplitude;
+            if (Grad && i < gradOctaves) {
+                const float af = amplitude * frequency;
+                gx += ndx * af;
+                gy += ndy * af;
+            }
+            frequency *= lacunarity;
+            amplitude *= persistence;
+        }
+        if constexpr (Grad) {
+            *dx = gx;
+            *dy = gy;
+        }
+        return total;
+    }
+
+#ifdef RC_SIMD_X86
+    // wkład narożnika: max(0.5 - |d|^2, 0)^4 * dot(g, d) (+ pochodna)
+    template <bool Grad>
+    RC_TARGET("sse4.1")
+    __m128 cornerSSE41(__m128 cx, __m128 cy, __m128 gx, __m128 gy, __m128& ddx, __m128& ddy) {
+        const __m128 dot = _mm_add_ps(_mm_mul_ps(gx, cx), _mm_mul_ps(gy, cy));
+        __m128 w = _mm_sub_ps(_mm_sub_ps(_mm_set1_ps(0.5f), _mm_mul_ps(cx, cx)), _mm_mul_ps(cy, cy));
+        w = _mm_max_ps(w, _mm_setzero_ps());
+        const __m128 w2 = _mm_mul_ps(w, w);
+        const __m128 w4 = _mm_mul_ps(w2, w2);
+        if constexpr (Grad) {
+            const __m128 k = _mm_mul_ps(_mm_mul_ps(_mm_mul_ps(w2, w), dot), _mm_set1_ps(8.0f));
+            ddx = _mm_sub_ps(_mm_mul_ps(w4, gx), _mm_mul_ps(k, cx));
+            ddy = _mm_sub_ps(_mm_mul_ps(w4, gy), _mm_mul_ps(k, cy));
+        }
+        return _mm_mul_ps(w4, dot);
+    }
+
+    // SSE4.1: 4 pasy; bez gather - indeksy permutacji i gradienty przez tablicę na stosie
+    template <bool Grad>
+    RC_TARGET("sse4.1")
+    __m128 noiseSSE41(const Tables& tb, __m128 x, __m128 y, __m128& dx, __m128& dy) {
+        const __m128 s = _mm_mul_ps(_mm_add_ps(x, y), _mm_set1_ps(F2));
+        const __m128i i = _mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(x, s)));
+        const __m128i j = _mm_cvttps_epi32(_mm_floor_ps(_mm_add_ps(y, s)));
+
+        const __m128 t = _mm_mul_ps(_mm_cvtepi32_ps(_mm_add_epi32(i, j)), _mm_set1_ps(G2));
+        const __m128 x0 = _mm_sub_ps(x, _mm_sub_ps(_mm_cvtepi32_ps(i), t));
+        const __m128 y0 = _mm_sub_ps(y, _mm_sub_ps(_mm_cvtepi32_ps(j), t));
+
+        const __m128i i1 = _mm_and_si128(_mm_castps_si128(_mm_cmpgt_ps(x0, y0)), _mm_set1_epi32(1));
+        const __m128i j1 = _mm_sub_epi32(_mm_set1_epi32(1), i1);
+
+        alignas(16) int ii[4], jj[4], i1s[4], j1s[4];
+        _mm_store_si128(reinterpret_cast<__m128i*>(ii), _mm_and_si128(i, _mm_set1_epi32(255)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(jj), _mm_and_si128(j, _mm_set1_epi32(255)));
+        _mm_store_si128(reinterpret_cast<__m128i*>(i1s), i1);
+        _mm_store_si128(reinterpret_cast<__m128i*>(j1s), j1);
+        alignas(16) float g0x[4], g0y[4], g1x[4], g1y[4], g2x[4], g2y[4];
+        for (int k = 0; k < 4; ++k) {
+            const int gi0 = tb.perm[ii[k] + tb.perm[jj[k]]] & 15;
+            const int gi1 = tb.perm[ii[k] + i1s[k] + tb.perm[jj[k] + j1s[k]]] & 15;
+            const int gi2 = tb.perm[ii[k] + 1 + tb.perm[jj[k] + 1]] & 15;
+            g0x[k] = tb.gx[gi0];
+            g0y[k] = tb.gy[gi0];
+            g1x[k] = tb.gx[gi1];
+            g1y[k] = tb.gy[gi1];
+            g2x[k] = tb.gx[gi2];
+            g2y[k] = tb.gy[gi2];
+        }
+
+        const __m128 g2 = _mm_set1_ps(G2);
+        const __m128 x1 = _mm_add_ps(_mm_sub_ps(x0, _mm_cvtepi32_ps(i1)), g2);
+        const __m128 y1 = _mm_add_ps(_mm_sub_ps(y0, _mm_cvtepi32_ps(j1)), g2);
+        const __m128 x2 = _mm_add_ps(_mm_sub_ps(x0, _mm_set1_ps(1.0f)), _mm_set1_ps(2 * G2));
+        const __m128 y2 = _mm_add_ps(_mm_sub_ps(y0, _mm_set1_ps(1.0f)), _mm_set1_ps(2 * G2));
+
+        __m128 d0x, d0y, d1x, d1y, d2x, d2y;
+        const __m128 c0 = cornerSSE41<Grad>(x0, y0, _mm_load_ps(g0x), _mm_load_ps(g0y), d0x, d0y);
+        const __m128 c1 = cornerSSE41<Grad>(x1, y1, _mm_load_ps(g1x), _mm_load_ps(g1y), d1x, d1y);
+        const __m128 c2 = cornerSSE41<Grad>(x2, y2, _mm_load_ps(g2x), _mm_load_ps(g2y), d2x, d2y);
+        const __m128 k70 = _mm_set1_ps(70.0f);
+        if constexpr (Grad) {
+            dx = _mm_mul_ps(k70, _mm_add_ps(_mm_add_ps(d0x, d1x), d2x));
+            dy = _mm_mul_ps(k70, _mm_add_ps(_mm_add_ps(d0y, d1y), d2y));
+        }
+        return _mm_mul_ps(k70, _mm_add_ps(_mm_add_ps(c0, c1), c2));
+    }
+
+    // AVX2: 8 pasów; permutacja przez gather, gradienty (16 wpisów) przez dwa permutevar + blend
+    RC_TARGET("avx2")
+    __m256 gradAVX2(const float* table, __m256i gi) {
+        const __m256 lo = _mm256_permutevar8x32_ps(_mm256_load_ps(table), gi);
+        const __m256 hi = _mm256_permutevar8x32_ps(_mm256_load_ps(table + 8), gi);
+        return _mm256_blendv_ps(lo, hi, _mm256_castsi256_ps(_mm256_slli_epi32(gi, 28))); // bit 3 -> znak
+    }
+
+    RC_TARGET("avx2")
+    __m256i permAVX2(const Tables& tb, __m256i idx) {
+        return _mm256_i32gather_epi32(tb.perm, idx, 4);
+    }
+
+    template <bool Grad>
+    RC_TARGET("avx2")
+    __m256 cornerAVX2(__m256 cx, __m256 cy, __m256 gx, __m256 gy, __m256& ddx, __m256& ddy) {
+        const __m256 dot = _mm256_add_ps(_mm256_mul_ps(gx, cx), _mm256_mul_ps(gy, cy));
+        __m256 w = _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(0.5f), _mm256_mul_ps(cx, cx)), _mm256_mul_ps(cy, cy));
+        w = _mm256_max_ps(w, _mm256_setzero_ps());
+        const __m256 w2 = _mm256_mul_ps(w, w);
+        const __m256 w4 = _mm256_mul_ps(w2, w2);
+        if constexpr (Grad) {
+            const __m256 k = _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(w2, w), dot), _mm256_set1_ps(8.0f));
+            ddx = _mm256_sub_ps(_mm256_mul_ps(w4, gx), _mm256_mul_ps(k, cx));
+            ddy = _mm256_sub_ps(_mm256_mul_ps(w4, gy), _mm256_mul_ps(k, cy));
+        }
+        return _mm256_mul_ps(w4, dot);
+    }
+
+    template <bool Grad>
+    RC_TARGET("avx2")
+    __m256 noiseAVX2(const Tables& tb, __m256 x, __m256 y, __m256& dx, __m256& dy) {
+        const __m256 s = _mm256_mul_ps(_mm256_add_ps(x, y), _mm256_set1_ps(F2));
+        const __m256i i = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(x, s)));
+        const __m256i j = _mm256_cvttps_epi32(_mm256_floor_ps(_mm256_add_ps(y, s)));
+
+        const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_add_epi32(i, j)), _mm256_set1_ps(G2));
+        const __m256 x0 = _mm256_sub_ps(x, _mm256_sub_ps(_mm256_cvtepi32_ps(i), t));
+        const __m256 y0 = _mm256_sub_ps(y, _mm256_sub_ps(_mm256_cvtepi32_ps(j), t));
+
+        const __m256i one = _mm256_set1_epi32(1);
+        const __m256i i1 = _mm256_and_si256(_mm256_castps_si256(_mm256_cmp_ps(x0, y0, _CMP_GT_OQ)), one);
+        const __m256i j1 = _mm256_sub_epi32(one, i1);
+
+        const __m256i ii = _mm256_and_si256(i, _mm256_set1_epi32(255));
+        const __m256i jj = _mm256_and_si256(j, _mm256_set1_epi32(255));
+        const __m256i m15 = _mm256_set1_epi32(15);
+        const __m256i gi0 = _mm256_and_si256(permAVX2(tb, _mm256_add_epi32(ii, permAVX2(tb, jj))), m15);
+        const __m256i gi1 = _mm256_and_si256(
+                permAVX2(tb, _mm256_add_epi32(_mm256_add_epi32(ii, i1), permAVX2(tb, _mm256_add_epi32(jj, j1)))), m15);
+        const __m256i gi2 = _mm256_and_si256(
+                permAVX2(tb, _mm256_add_epi32(_mm256_add_epi32(ii, one), permAVX2(tb, _mm256_add_epi32(jj, one)))), m15);
+
+        const __m256 g2 = _mm256_set1_ps(G2);
+        const __m256 x1 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_cvtepi32_ps(i1)), g2);
+        const __m256 y1 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_cvtepi32_ps(j1)), g2);
+        const __m256 x2 = _mm256_add_ps(_mm256_sub_ps(x0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2 * G2));
+        const __m256 y2 = _mm256_add_ps(_mm256_sub_ps(y0, _mm256_set1_ps(1.0f)), _mm256_set1_ps(2 * G2));
+
+        __m256 d0x, d0y, d1x, d1y, d2x, d2y;
+        const __m256 c0 = cornerAVX2<Grad>(x0, y0, gradAVX2(tb.gx, gi0), gradAVX2(tb.gy, gi0), d0x, d0y);
+        const __m256 c1 = cornerAVX2<Grad>(x1, y1, gradAVX2(tb.gx, gi1), gradAVX2(tb.gy, gi1), d1x, d1y);
+        const __m256 c2 = cornerAVX2<Grad>(x2, y2, gradAVX2(tb.gx, gi2), gradAVX2(tb.gy, gi2), d2x, d2y);
+        const __m256 k70 = _mm256_set1_ps(70.0f);
+        if constexpr (Grad) {
+            dx = _mm256_mul_ps(k70, _mm256_add_ps(_mm256_add_ps(d0x, d1x), d2x));
+            dy = _mm256_mul_ps(k70, _mm256_add_ps(_mm256_add_ps(d0y, d1y), d2y));
+        }
+        return _mm256_mul_ps(k70, _mm256_add_ps(_mm256_add_ps(c0, c1), c2));
+    }
+
+    RC_TARGET("sse4.1")
+    void noiseBatchSSE41(const Tables& tb, const float* x, const float* y, float* out, std::size_t n) {
+        __m128 dx, dy;
+        for (std::size_t k = 0; k < n; k += 4)
+            _mm_storeu_ps(out + k, noiseSSE41<false>(tb, _mm_loadu_ps(x + k), _mm_loadu_ps(y + k), dx, dy));
+    }
+
+    RC_TARGET("avx2")
+    void noiseBatchAVX2(const Tables& tb, const float* x, const float* y, float* out, std::size_t n) {
+        __m256 dx, dy;
+        for (std::size_t k = 0; k < n; k += 8)
+            _mm256_storeu_ps(out + k, noiseAVX2<false>(tb, _mm256_loadu_ps(x + k), _mm256_loadu_ps(y + k), dx, dy));
+    }
+
+    // oktawy w pętli wewnętrznej - suma zostaje w rejestrze, kolejność działań jak w fbmScalar
+    template <bool Grad>
+    RC_TARGET("sse4.1")
+    void fbmRowSSE41(const Tables& tb, const float* x, float y, float* out, float* outDx, float* outDy,
+                     std::size_t n, float frequency, int octaves, float lacunarity, float persistence,
+                     int gradOctaves) {
+        for (std::size_t k = 0; k < n; k += 4) {
+            const __m128 px = _mm_loadu_ps(x + k);
+            __m128 total = _mm_setzero_ps(), gx = _mm_setzero_ps(), gy = _mm_setzero_ps();
+            float f = frequency, amplitude = 1.0f;
+            for (int o = 0; o < octaves; ++o) {
+                __m128 ndx, ndy;
+                const __m128 v = noiseSSE41<Grad>(tb, _mm_mul_ps(px, _mm_set1_ps(f)), _mm_set1_ps(y * f), ndx, ndy);
+                total = _mm_add_ps(total, _mm_mul_ps(v, _mm_set1_ps(amplitude)));
+                if (Grad && o < gradOctaves) {
+                    const __m128 af = _mm_set1_ps(amplitude * f);
+                    gx = _mm_add_ps(gx, _mm_mul_ps(ndx, af));
+                    gy = _mm_add_ps(gy, _mm_mul_ps(ndy, af));
+                }
+                f *= lacunarity;
+                amplitude *= persistence;
+            }
+            _mm_storeu_ps(out + k, total);
+            if constexpr (Grad) {
+                _mm_storeu_ps(outDx + k, gx);
+                _mm_storeu_ps(outDy + k, gy);
+            }
+        }
+    }
+
+    template <bool Grad>
+    RC_TARGET("avx2")
+    void fbmRowAVX2(const Tables& tb, const float* x, float y, float* out, float* outDx, float* outDy, std::size_t n,
+                    float frequency, int octaves, float lacunarity, float persistence, int gradOctaves) {
+        for (std::size_t k = 0; k < n; k += 8) {
+            const __m256 px = _mm256_loadu_ps(x + k);
+            __m256 total = _mm256_setzero_ps(), gx = _mm256_setzero_ps(), gy = _mm256_setzero_ps();
+            float f = frequency, amplitude = 1.0f;
+            for (int o = 0; o < octaves; ++o) {
+                __m256 ndx, ndy;
+                const __m256 v =
+                        noiseAVX2<Grad>(tb, _mm256_mul_ps(px, _mm256_set1_ps(f)), _mm256_set1_ps(y * f), ndx, ndy);
+                total = _mm256_add_ps(total, _mm256_mul_ps(v, _mm256_set1_ps(amplitude)));
+                if (Grad && o < gradOctaves) {
+                    const __m256 af = _mm256_set1_ps(amplitude * f);
+                    gx = _mm256_add_ps(gx, _mm256_mul_ps(ndx, af));
+                    gy = _mm256_add_ps(gy, _mm256_mul_ps(ndy, af));
+                }
+                f *= lacunarity;
+                amplitude *= persistence;
+            }
+            _mm256_storeu_ps(out + k, total);
+            if constexpr (Grad) {
+                _mm256_storeu_ps(outDx + k, gx);
+                _mm256_storeu_ps(outDy + k, gy);
+            }
+        }
+    }
+
+    template <bool Grad>
+    RC_TARGET("sse4.1")
+    void noiseRowSSE41(const Tables& tb, const float* x, float y, float* out, float* outDx, float* outDy,
+                       std::size_t n) {
+        for (std::size_t k = 0; k < n; k += 4) {
+            __m128 ndx, ndy;
+            _mm_storeu_ps(out + k, noiseSSE41<Grad>(tb, _mm_loadu_ps(x + k), _mm_set1_ps(y), ndx, ndy));
+            if constexpr (Grad) {
+                _mm_storeu_ps(outDx + k, ndx);
+                _mm_storeu_ps(outDy + k, ndy);
+            }
+        }
+    }
+
+    template <bool Grad>
+    RC_TARGET("avx2")
+    void noiseRowAVX2(const Tables& tb, const float* x, float y, float* out, float* outDx, float* outDy,
+                      std::size_t n) {
+        for (std::size_t k = 0; k < n; k += 8) {
+            __m256 ndx, ndy;
+            _mm256_storeu_ps(out + k, noiseAVX2<Grad>(tb, _mm256_loadu_ps(x + k), _mm256_set1_ps(y), ndx, ndy));
+            if constexpr (Grad) {
+                _mm256_storeu_ps(outDx + k, ndx);
+                _mm256_storeu_ps(outDy + k, ndy);
+            }
+        }
+    }
+
+    SimplexNoise::SimdLevel detectSimd() {
+#if defined(_MSC_VER) && !defined(__clang__)
+        int r[4];
+        __cpuid(r, 0);
+        const int maxLeaf = r[0];
+        __cpuid(r, 1);
+        const bool sse41 = (r[2] & (1 << 19)) != 0;
+        const bool osxsave = (r[2] & (1 << 27)) != 0, avx = (r[2] & (1 << 28)) != 0;
+        bool avx2 = false;
+        if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+            __cpuidex(r, 7, 0);
+            avx2 = (r[1] & (1 << 5)) != 0;
+        }
+#else
+        __builtin_cpu_init();
+        const bool sse41 = __builtin_cpu_supports("sse4.1");
+        const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+        return avx2 ? SimplexNoise::SimdLevel::AVX2 : sse41 ? SimplexNoise::SimdLevel::SSE41
+                                                            : SimplexNoise::SimdLevel::Scalar;
+    }
+#else
+    SimplexNoise::SimdLevel detectSimd() { return SimplexNoise::SimdLevel::Scalar; }
+#endif
+
+    const SimplexNoise::SimdLevel kDetected = detectSimd();
+    std::atomic<SimplexNoise::SimdLevel> g_level{kDetected};
+
+    // ile pierwszych elementów z n liczy ścieżka SIMD - reszta skalarnie
+    std::size_t simdBody(SimplexNoise::SimdLevel level, std::size_t n) {
+        const std::size_t lanes = level == SimplexNoise::SimdLevel::AVX2    ? 8
+                                  : level == SimplexNoise::SimdLevel::SSE41 ? 4
+                                                                            : 0;
+        return lanes ? n - n % lanes : 0;
+    }
+} // namespace
+
 SimplexNoise::SimplexNoise(int seed) : seed_(seed) {
     init_perm_();
     init_gradient_table_();
 }
 
 float SimplexNoise::noise(float x, float y) const {
-    // skewing
-    float s = (x + y) * F2;
-    int i = static_cast<int>(std::floor(x + s));
-    int j = static_cast<int>(std::floor(y + s));
-
-    // unskewing
-    float t = static_cast<float>((i + j)) * G2;
-    float x0 = x - (static_cast<float>(i) - t);
-    float y0 = y - (static_cast<float>(j) - t);
-
-    int i1, j1;
-    if (x0 > y0) {
-        i1 = 1;
-        j1 = 0;
-    } else {
-        i1 = 0;
-        j1 = 1;
-    }
-
-    int ii = i & 255;
-    int jj = j & 255;
-
-    unsigned gi0 = perm_[(ii) + perm_[(jj)]] % 16;
-    unsigned gi1 = perm_[(ii + i1) + perm_[(jj + j1)]] % 16;
-    unsigned gi2 = perm_[(ii + 1) + perm_[(jj + 1)]] % 16;
-
-    float x1 = x0 - static_cast<float>(i1) + G2;
-    float y1 = y0 - static_cast<float>(j1) + G2;
-    float x2 = x0 - 1.0f + 2 * G2;
-    float y2 = y0 - 1.0f + 2 * G2;
-
-    float dot0 = glm::dot(gradient_table_[gi0], glm::vec2(x0, y0));
-    float dot1 = glm::dot(gradient_table_[gi1], glm::vec2(x1, y1));
-    float dot2 = glm::dot(gradient_table_[gi2], glm::vec2(x2, y2));
-
-    // dot products weights
-    float t0 = 0.5f - x0 * x0 - y0 * y0;
-    float t1 = 0.5f - x1 * x1 - y1 * y1;
-    float t2 = 0.5f - x2 * x2 - y2 * y2;
-
-    float contrib0 = 0.0f, contrib1 = 0.0f, contrib2 = 0.0f;
-    if (t0 > 0)
-        contrib0 = static_cast<float>(pow(t0, 4)) * dot0;
-    if (t1 > 0)
-        contrib1 = static_cast<float>(pow(t1, 4)) * dot1;
-    if (t2 > 0)
-        contrib2 = static_cast<float>(pow(t2, 4)) * dot2;
-
-    float noise = 70.0f * (contrib0 + contrib1 + contrib2);
-
-    return noise;
+    return noiseScalar<false>({perm_.data(), gradX_.data(), gradY_.data()}, x, y);
+}
+
+float SimplexNoise::noise(float x, float y, glm::vec2& grad) const {
+    return noiseScalar<true>({perm_.data(), gradX_.data(), gradY_.data()}, x, y, &grad.x, &grad.y);
 }
 
 float SimplexNoise::fbm(float x, float y, float frequency, int octaves, float lacunarity, float persistence) const {
+    return fbmScalar<false>({perm_.data(), gradX_.data(), gradY_.data()}, x, y, frequency, octaves, lacunarity,
+                            persistence);
+}
 
-    float total = 0.0f;
-    float amplitude = 1.0f;
+float SimplexNoise::fbm(float x, float y, glm::vec2& grad, float frequency, int octaves, float lacunarity,
+                        float persistence) const {
+    return fbmScalar<true>({perm_.data(), gradX_.data(), gradY_.data()}, x, y, frequency, octaves, lacunarity,
+                           persistence, octaves, &grad.x, &grad.y);
+}
 
-    for (int i = 0; i < octaves; i++) {
-        total += noise(x * frequency, y * frequency) * amplitude;
-        frequency *= lacunarity;
-        amplitude *= persistence;
+void SimplexNoise::noise8(const float* x, const float* y, float* out) const {
+    noise(std::span<const float>(x, 8), std::span<const float>(y, 8), std::span<float>(out, 8));
+}
+
+void SimplexNoise::noise(std::span<const float> x, std::span<const float> y, std::span<float> out) const {
+    const Tables tb{perm_.data(), gradX_.data(), gradY_.data()};
+    const SimdLevel level = g_level.load(std::memory_order_relaxed);
+    const std::size_t n = out.size();
+    const std::size_t body = simdBody(level, n);
+#ifdef RC_SIMD_X86
+    if (level == SimdLevel::AVX2)
+        noiseBatchAVX2(tb, x.data(), y.data(), out.data(), body);
+    else if (level == SimdLevel::SSE41)
+        noiseBatchSSE41(tb, x.data(), y.data(), out.data(), body);
+#endif
+    for (std::size_t k = body; k < n; ++k)
+        out[k] = noiseScalar<false>(tb, x[k], y[k]);
+}
+
+namespace {
+    template <bool Grad>
+    void fbmRowDispatch(const Tables& tb, std::span<const float> x, float y, std::span<float> out, float* dx,
+                        float* dy, float frequency, int octaves, float lacunarity, float persistence,
+                        int gradOctaves) {
+        const auto level = SimplexNoise::simdLevel();
+        const std::size_t n = out.size();
+        const std::size_t body = simdBody(level, n);
+#ifdef RC_SIMD_X86
+        if (level == SimplexNoise::SimdLevel::AVX2)
+            fbmRowAVX2<Grad>(tb, x.data(), y, out.data(), dx, dy, body, frequency, octaves, lacunarity, persistence,
+                             gradOctaves);
+        else if (level == SimplexNoise::SimdLevel::SSE41)
+            fbmRowSSE41<Grad>(tb, x.data(), y, out.data(), dx, dy, body, frequency, octaves, lacunarity, persistence,
+                              gradOctaves);
+#endif
+        for (std::size_t k = body; k < n; ++k)
+            out[k] = fbmScalar<Grad>(tb, x[k], y, frequency, octaves, lacunarity, persistence, gradOctaves,
+                                     Grad ? dx + k : nullptr, Grad ? dy + k : nullptr);
+    }
+} // namespace
+
+void SimplexNoise::noiseRow(std::span<const float> x, float y, std::span<float> out, std::span<float> dx,
+                            std::span<float> dy) const {
+    const Tables tb{perm_.data(), gradX_.data(), gradY_.data()};
+    const SimdLevel level = g_level.load(std::memory_order_relaxed);
+    const bool grad = !dx.empty();
+    const std::size_t n = out.size();
+    const std::size_t body = simdBody(level, n);
+#ifdef RC_SIMD_X86
+    if (level == SimdLevel::AVX2) {
+        if (grad)
+            noiseRowAVX2<true>(tb, x.data(), y, out.data(), dx.data(), dy.data(), body);
+        else
+            noiseRowAVX2<false>(tb, x.data(), y, out.data(), nullptr, nullptr, body);
+    } else if (level == SimdLevel::SSE41) {
+        if (grad)
+            noiseRowSSE41<true>(tb, x.data(), y, out.data(), dx.data(), dy.data(), body);
+        else
+            noiseRowSSE41<false>(tb, x.data(), y, out.data(), nullptr, nullptr, body);
     }
+#endif
+    for (std::size_t k = body; k < n; ++k)
+        out[k] = grad ? noiseScalar<true>(tb, x[k], y, &dx[k], &dy[k]) : noiseScalar<false>(tb, x[k], y);
+}
 
-    return total;
+void SimplexNoise::fbmRow(std::span<const float> x, float y, std::span<float> out, float frequency, int octaves,
+                          float lacunarity, float persistence) const {
+    fbmRowDispatch<false>({perm_.data(), gradX_.data(), gradY_.data()}, x, y, out, nullptr, nullptr, frequency,
+                          octaves, lacunarity, persistence, 0);
+}
+
+void SimplexNoise::fbmRow(std::span<const float> x, float y, std::span<float> out, std::span<float> dx,
+                          std::span<float> dy, float frequency, int octaves, float lacunarity, float persistence,
+                          int gradOctaves) const {
+    fbmRowDispatch<true>({perm_.data(), gradX_.data(), gradY_.data()}, x, y, out, dx.data(), dy.data(), frequency,
+                         octaves, lacunarity, persistence, gradOctaves < 0 ? octaves : gradOctaves);
+}
+
+SimplexNoise::SimdLevel SimplexNoise::simdLevel() {
+    return g_level.load(std::memory_order_relaxed);
+}
+
+void SimplexNoise::forceSimdLevel(SimdLevel level) {
+    g_level.store(std::min(level, kDetected), std::memory_order_relaxed);
+}
+
+const char* SimplexNoise::simdLevelName(SimdLevel level) {
+    switch (level) {
+        case SimdLevel::AVX2:
+            return "AVX2";
+        case SimdLevel::SSE41:
+            return "SSE4.1";
+        default:
+            return "scalar";
+    }
 }
 
 void SimplexNoise::init_perm_() {
@@ -106,5 +524,7 @@ void SimplexNoise::init_gradient_table_() {
     for (int i = 0; i < 16; i++) {
         float angle = static_cast<float>(i) * 2.0f * static_cast<float>(M_PI) / 16.0f;
         gradient_table_.emplace_back(std::cos(angle), std::sin(angle));
+        gradX_[i] = gradient_table_.back().x;
+        gradY_[i] = gradient_table_.back().y;
     }
 }
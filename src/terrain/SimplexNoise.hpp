@@ -4,12 +4,19 @@
 
 #ifndef SIMPLEX_NOISE_HPP
 #define SIMPLEX_NOISE_HPP
+#include <array>
+#include <cstdint>
+#include <span>
 #include <vector>
 
 #include "glm/glm.hpp"
 
 class SimplexNoise {
 public:
+    // ścieżka wsadowa wybierana przy starcie wg CPU; wszystkie dają te same bity co noise() - przy kompilacji
+    // bez łączenia mnożeń z dodawaniem (-ffp-contract=off w CMake)
+    enum class SimdLevel : std::uint8_t { Scalar, SSE41, AVX2 };
+
     explicit SimplexNoise(int seed);
 
     // core API
@@ -18,10 +25,40 @@ public:
     [[nodiscard]] float fbm(float x, float y, float frequency = 1.5f, int octaves = 8, float lacunarity = 2.0f,
                             float persistence = 0.5f) const;
 
+    // to samo + analityczny gradient (d/dx, d/dy) w grad; wartość ma te same bity co bez gradientu
+    [[nodiscard]] float noise(float x, float y, glm::vec2& grad) const;
+    [[nodiscard]] float fbm(float x, float y, glm::vec2& grad, float frequency = 1.5f, int octaves = 8,
+                            float lacunarity = 2.0f, float persistence = 0.5f) const;
+
+    // out[k] = noise(x[k], y[k]) dla 8 punktów
+    void noise8(const float* x, const float* y, float* out) const;
+    // out[k] = noise(x[k], y[k]); rozmiary x, y, out równe
+    void noise(std::span<const float> x, std::span<const float> y, std::span<float> out) const;
+    // out[k] = noise(x[k], y) i surowy gradient do dx, dy (puste - bez gradientu); jedna oktawa wiersza,
+    // te same bity co oktawa w fbmRow dla x[k] = x * f, y = y * f
+    void noiseRow(std::span<const float> x, float y, std::span<float> out, std::span<float> dx = {},
+                  std::span<float> dy = {}) const;
+    // out[k] = fbm(x[k], y, ...) - jeden wiersz mapy; oktawy liczone w rejestrach
+    void fbmRow(std::span<const float> x, float y, std::span<float> out, float frequency = 1.5f, int octaves = 8,
+                float lacunarity = 2.0f, float persistence = 0.5f) const;
+    // + gradient fbm po x i y do dx, dy (rozmiar jak out) z gradOctaves pierwszych oktaw (< 0 - wszystkich);
+    // wyższe oktawy wchodzą tylko do wartości
+    void fbmRow(std::span<const float> x, float y, std::span<float> out, std::span<float> dx, std::span<float> dy,
+                float frequency = 1.5f, int octaves = 8, float lacunarity = 2.0f, float persistence = 0.5f,
+                int gradOctaves = -1) const;
+
+    [[nodiscard]] static SimdLevel simdLevel();
+    // do porównań - poziom ponad możliwości CPU jest obcinany
+    static void forceSimdLevel(SimdLevel level);
+    [[nodiscard]] static const char* simdLevelName(SimdLevel level);
+
 private:
     int seed_;
     std::vector<int> perm_;
     std::vector<glm::vec2> gradient_table_;
+    // gradienty jako osobne tablice x/y - ładowane wektorowo w ścieżkach SIMD
+    alignas(32) std::array<float, 16> gradX_{};
+    alignas(32) std::array<float, 16> gradY_{};
 
     void init_perm_();
     void init_gradient_table_();
@@ -5,17 +5,24 @@
 #include "Terrain.hpp"
 
 #include <algorithm>
-#include <cmath>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <glad.h>
 #include <glm/glm.hpp>
 #include <limits>
 #include <vector>
 
-#include "SimplexNoise.hpp"
-#include "math/Array_2D.hpp"
+#include "common/ThreadPool.hpp"
+#include "gfx/geometry/PackedVertex.hpp"
+#include "gfx/render/VertexLayout.hpp"
+
+// TVertex musi mieć układ geometry::Vertex - wspólne setupVertexAttribs / packVertices
+static_assert(sizeof(TVertex) == sizeof(rc::gfx::geometry::Vertex) &&
+              offsetof(TVertex, nrm) == offsetof(rc::gfx::geometry::Vertex, normal) &&
+              offsetof(TVertex, uv) == offsetof(rc::gfx::geometry::Vertex, uv));
 
-Terrain::Terrain(int width, int height, int seed) :
-    width_(width), height_(height), heightmap_(width, height), noise_(seed), vbo_(0), vao_(0), ibo_(0) {}
 void Terrain::releaseGL() {
     if (vbo_) {
         glDeleteBuffers(1, &vbo_);
@@ -25,161 +32,443 @@ void Terrain::releaseGL() {
         glDeleteBuffers(1, &ibo_);
         ibo_ = 0;
     }
+    if (quantVbo_) {
+        glDeleteBuffers(1, &quantVbo_);
+        quantVbo_ = 0;
+    }
+    if (lodCmdBuf_) {
+        glDeleteBuffers(1, &lodCmdBuf_);
+        lodCmdBuf_ = 0;
+    }
     if (vao_) {
         glDeleteVertexArrays(1, &vao_);
         vao_ = 0;
     }
+    gpuBytes_ = 0;
+    upload_ = {};
+    lodSlotOf_.clear();
+    lodSlotKey_.clear();
+    lodSlotFrame_.clear();
+    lodFree_.clear();
+    lodCmdCount_ = 0;
 }
 
 
-void Terrain::generate(float scale, float frequency, int octaves, float lacunarity, float persistence, float exponent,
-                       float height_scale) {
+void Terrain::uploadToGPU() {
+    beginUpload();
+    if (!upload_.active)
+        return;
+    const auto t0 = std::chrono::steady_clock::now();
+    uploadVertexRows_(0, static_cast<size_t>(height_));
+    uploadIndexStripes_(0, upload_.stripeMeshlets.size());
+    finishUpload_();
+    genStats_.uploadMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    genStats_.uploadSteps = 1;
+}
 
-    for (int y = 0; y < height_; y++) {
-        for (int x = 0; x < width_; x++) {
-            float h = noise_.fbm(static_cast<float>(x) * scale + offset_, static_cast<float>(y) * scale + offset_,
-                                 frequency, octaves, lacunarity, persistence);
-            heightmap_(x, y) = h;
-        }
+void Terrain::beginUpload() {
+    // Wierzchołki i indeksy są liczone wprost do zmapowanych zakresów buforów GL - na CPU zostają tylko
+    // wysokości, normalne i meshlety. Tu tylko bufory i atrybuty; treść dopisują kolejne porcje.
+    releaseGL();
+    const auto t0 = std::chrono::steady_clock::now();
+    genStats_.uploadSteps = 0;
+    if (chunked_) {
+        uploadLod_();
+        genStats_.uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        return;
     }
-    heightmap_.normalize();
 
-    vertices_.clear();
-    indices_.clear();
-    vertices_.reserve(width_ * height_);
-    indices_.reserve((width_ - 1) * (height_ - 1) * 6);
+    using rc::gfx::geometry::PackedVertex;
+    const auto W = static_cast<size_t>(width_), H = static_cast<size_t>(height_);
+    glGenVertexArrays(1, &vao_);
+    glGenBuffers(1, &vbo_);
+    glGenBuffers(1, &ibo_);
 
-    for (int y = 0; y < height_; y++) {
-        for (int x = 0; x < width_; x++) {
-            vertices_.emplace_back(x, std::pow(heightmap_(x, y), exponent) * height_scale, y);
-        }
+    glBindVertexArray(vao_);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+    const size_t vBytes = W * H * (packed_ ? sizeof(PackedVertex) : sizeof(TVertex));
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vBytes), nullptr, GL_STATIC_DRAW);
+    // jedna ramka na cały teren; UV = x/2 są dokładne w half
+    upload_.box = rc::gfx::geometry::fitQuantBox(glm::vec3(0.f, minH(), 0.f), glm::vec3(W - 1, maxH(), H - 1),
+                                                 glm::vec2(0.f));
+    if (packed_) {
+        rc::gfx::render::setupVertexAttribs(rc::gfx::geometry::VertexFormat::Packed);
+
+        const auto rows = rc::gfx::geometry::packedQuantRows(upload_.box);
+        glGenBuffers(1, &quantVbo_);
+        glBindBuffer(GL_ARRAY_BUFFER, quantVbo_);
+        glBufferData(GL_ARRAY_BUFFER, sizeof(rows), rows.data(), GL_STATIC_DRAW);
+        rc::gfx::render::setupQuantAttribs();
+    } else {
+        rc::gfx::render::setupVertexAttribs(rc::gfx::geometry::VertexFormat::Float); // TVertex == Vertex
     }
-    for (int y = 0; y < height_ - 1; y++) {
-        for (int x = 0; x < width_ - 1; x++) {
-            unsigned int x0y0 = y * width_ + x;
-            unsigned int x0y1 = (y + 1) * width_ + x;
-            unsigned int x1y0 = y * width_ + (x + 1);
-            unsigned int x1y1 = (y + 1) * width_ + (x + 1);
-
-            // triangulacja siatki
-            indices_.emplace_back(x0y0);
-            indices_.emplace_back(x0y1);
-            indices_.emplace_back(x1y0);
-
-            indices_.emplace_back(x0y1);
-            indices_.emplace_back(x1y1);
-            indices_.emplace_back(x1y0);
+
+    indexCount_ = (W - 1) * (H - 1) * 6;
+    const size_t iBytes = indexCount_ * sizeof(unsigned int);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(iBytes), nullptr, GL_STATIC_DRAW);
+    glBindVertexArray(0);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    gpuBytes_ = vBytes + iBytes;
+
+    upload_.stripeMeshlets.resize((W - 1 + indexStripe_ - 1) / indexStripe_);
+    upload_.active = true;
+    genStats_.uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+bool Terrain::uploadStep(double budgetMs) {
+    if (!upload_.active)
+        return true;
+    // porcje ~uploadChunk_ wierzchołków (kwadów dla indeksów) aż do wyczerpania budżetu klatki
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto W = static_cast<size_t>(width_), H = static_cast<size_t>(height_);
+    const size_t rowChunk = std::max<size_t>(1, uploadChunk_ / W);
+    const size_t stripeChunk = std::max<size_t>(1, uploadChunk_ / (indexStripe_ * H));
+    const size_t stripes = upload_.stripeMeshlets.size();
+    double ms = 0.0;
+    while (upload_.active && ms < budgetMs) {
+        if (upload_.nextRow < H) {
+            const size_t y1 = std::min(upload_.nextRow + rowChunk, H);
+            uploadVertexRows_(upload_.nextRow, y1);
+            upload_.nextRow = y1;
+        } else if (upload_.nextStripe < stripes) {
+            const size_t s1 = std::min(upload_.nextStripe + stripeChunk, stripes);
+            uploadIndexStripes_(upload_.nextStripe, s1);
+            upload_.nextStripe = s1;
+        } else {
+            finishUpload_();
         }
+        ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
     }
+    genStats_.uploadMs += ms;
+    genStats_.uploadSteps++;
+    return !upload_.active;
+}
 
-    normals_.resize(vertices_.size(), glm::vec3(0.0f));
-
-    // oblicz face normals dla trójkątów
-    for (size_t i = 0; i < indices_.size(); i += 3) {
-        const unsigned int ia = indices_[i];
-        const unsigned int ib = indices_[i + 1];
-        const unsigned int ic = indices_[i + 2];
+float Terrain::uploadProgress() const {
+    if (!upload_.active)
+        return 1.0f;
+    const size_t total = static_cast<size_t>(height_) + upload_.stripeMeshlets.size();
+    return static_cast<float>(upload_.nextRow + upload_.nextStripe) / static_cast<float>(total);
+}
 
-        const glm::vec3& A = vertices_[ia];
-        const glm::vec3& B = vertices_[ib];
-        const glm::vec3& C = vertices_[ic];
+void Terrain::uploadVertexRows_(size_t y0, size_t y1) {
+    using rc::gfx::geometry::PackedVertex;
+    const auto W = static_cast<size_t>(width_), H = static_cast<size_t>(height_);
+    constexpr size_t kMinRows = 8;
+    const size_t vertexSize = packed_ ? sizeof(PackedVertex) : sizeof(TVertex);
+    const float* heights = heightmap_.data();
+    const auto& box = upload_.box;
+
+    // bufor jeszcze nierysowany - zakres bez synchronizacji z GPU
+    glBindBuffer(GL_COPY_WRITE_BUFFER, vbo_);
+    auto* vmap = static_cast<unsigned char*>(glMapBufferRange(
+            GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(y0 * W * vertexSize),
+            static_cast<GLsizeiptr>((y1 - y0) * W * vertexSize),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    rc::common::ThreadPool::shared().parallelFor(y1 - y0, kMinRows, [&](size_t r0, size_t r1, size_t) {
+        for (size_t y = y0 + r0; y < y0 + r1; y++) {
+            for (size_t x = 0; x < W; x++) {
+                const size_t idx = y * W + x;
+                unsigned char* dst = vmap + (idx - y0 * W) * vertexSize;
+                const glm::vec3 pos(x, heights[idx], y);
+                const glm::vec2 uv = glm::vec2(x, y) * uvPerUnit_;
+                glm::vec3 nrm;
+                if (!normals_.empty()) {
+                    nrm = rc::gfx::geometry::unpackOctNormal(normals_[idx]);
+                } else { // różnice centralne
+                    const size_t xl = x > 0 ? x - 1 : x, xr = std::min(x + 1, W - 1);
+                    const size_t yl = y > 0 ? y - 1 : y, yr = std::min(y + 1, H - 1);
+                    const float dhdx = (heights[y * W + xr] - heights[y * W + xl]) / static_cast<float>(xr - xl);
+                    const float dhdy = (heights[yr * W + x] - heights[yl * W + x]) / static_cast<float>(yr - yl);
+                    nrm = glm::normalize(glm::vec3(-dhdx, 1.0f, -dhdy));
+                }
+                if (packed_) {
+                    PackedVertex pv = rc::gfx::geometry::packVertex(pos, nrm, uv, box);
+                    if (!normals_.empty())
+                        pv.normal = normals_[idx]; // już spakowana - bez drugiego zaokrąglenia
+                    std::memcpy(dst, &pv, sizeof(PackedVertex));
+                } else {
+                    const TVertex tv{pos, nrm, uv};
+                    std::memcpy(dst, &tv, sizeof(TVertex));
+                }
+            }
+        }
+    });
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
 
-        glm::vec3 U = B - A;
-        glm::vec3 V = C - A;
-        glm::vec3 N = glm::normalize(glm::cross(U, V));
+void Terrain::uploadIndexStripes_(size_t s0, size_t s1) {
+    // Trójkąty w pionowych pasach po indexStripe_ kwadów: poprzedni rząd pasa (indexStripe_+1 wierzchołków)
+    // zostaje w 16-elementowym cache'u po transformacji. ACMR ~0.57 zamiast ~1.0 dla kolejności rzędami.
+    // Pas ma z góry znaną liczbę indeksów, więc pasy wypełniają się niezależnie, a kolejne pasy to kolejne
+    // zakresy bufora. Meshlety pasa liczone są na jego lokalnych kopiach pozycji i indeksów (podział zależy
+    // tylko od tego, które indeksy są równe).
+    constexpr size_t kStripe = indexStripe_;
+    const auto W = static_cast<size_t>(width_), H = static_cast<size_t>(height_);
+    const float* heights = heightmap_.data();
+    const auto stripeFirst = [&](size_t s) { return std::min(s * kStripe, W - 1) * (H - 1) * 6; };
+    const size_t base = stripeFirst(s0);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, ibo_);
+    auto* imap = static_cast<unsigned int*>(glMapBufferRange(
+            GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(base * sizeof(unsigned int)),
+            static_cast<GLsizeiptr>((stripeFirst(s1) - base) * sizeof(unsigned int)),
+            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    rc::common::ThreadPool::shared().parallelFor(s1 - s0, 1, [&](size_t c0, size_t c1, size_t) {
+        std::vector<glm::vec3> localPos;
+        std::vector<unsigned int> localIdx;
+        for (size_t s = s0 + c0; s < s0 + c1; s++) {
+            const size_t x0 = s * kStripe, x1 = std::min(x0 + kStripe, W - 1);
+            const size_t cols = x1 - x0 + 1;
+            const size_t first = stripeFirst(s);
+            localPos.resize(cols * H);
+            for (size_t y = 0; y < H; y++)
+                for (size_t x = x0; x <= x1; x++)
+                    localPos[y * cols + (x - x0)] = glm::vec3(x, heights[y * W + x], y);
+            localIdx.clear();
+            size_t i = first - base;
+            for (size_t y = 0; y < H - 1; y++) {
+                for (size_t x = x0; x < x1; x++) {
+                    unsigned int x0y0 = y * W + x;
+                    unsigned int x0y1 = (y + 1) * W + x;
+                    unsigned int x1y0 = y * W + (x + 1);
+                    unsigned int x1y1 = (y + 1) * W + (x + 1);
+
+                    // triangulacja siatki
+                    for (unsigned int v: {x0y0, x0y1, x1y0, x0y1, x1y1, x1y0}) {
+                        imap[i++] = v;
+                        localIdx.push_back(static_cast<unsigned int>((v / W) * cols + (v % W - x0)));
+                    }
+                }
+            }
+            // pas 7 kwadów daje meshlety 7x7 kwadów (limit 64 wierzchołków); podział per pas
+            upload_.stripeMeshlets[s].clear();
+            rc::gfx::geometry::buildMeshlets(localPos, localIdx, static_cast<std::uint32_t>(first),
+                                             upload_.stripeMeshlets[s]);
+        }
+    });
+    glUnmapBuffer(GL_COPY_WRITE_BUFFER);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
 
-        normals_[ia] += N;
-        normals_[ib] += N;
-        normals_[ic] += N;
-    }
-    for (auto& n: normals_)
-        n = glm::normalize(n);
+void Terrain::finishUpload_() {
+    meshlets_.clear();
+    for (const auto& m: upload_.stripeMeshlets)
+        meshlets_.insert(meshlets_.end(), m.begin(), m.end());
+    meshlets_.shrink_to_fit();
+    upload_ = {};
+}
 
-    float mPerTile = 2.f;
+void Terrain::draw() const {
 
-    gpuVerts_.resize(vertices_.size());
-    for (size_t y = 0; y < height_; y++) {
-        for (size_t x = 0; x < width_; x++) {
-            size_t idx = y * width_ + x;
-            glm::vec2 uv = glm::vec2(x, y) / mPerTile;
-            gpuVerts_[idx] = {vertices_[idx], normals_[idx], uv};
+    glBindVertexArray(vao_);
+    if (chunked_) {
+        if (lodCmdCount_ > 0) {
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, lodCmdBuf_);
+            glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_SHORT, nullptr, lodCmdCount_, 0);
+            glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
         }
+    } else {
+        glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indexCount_), GL_UNSIGNED_INT, nullptr);
     }
+    glBindVertexArray(0);
 }
 
-float Terrain::sampleHeightBilinear(float x, float z) const {
-    int ix = static_cast<int>(std::floor(x));
-    int iz = static_cast<int>(std::floor(z));
-    float fx = x - static_cast<float>(ix);
-    float fz = z - static_cast<float>(iz);
-
-    auto H = [&](int X, int Z) {
-        X = std::clamp(X, 0, width_  - 1);
-        Z = std::clamp(Z, 0, height_ - 1);
-        return vertices_[Z * width_ + X].y;
-    };
-
-    float h00 = H(ix,   iz  );
-    float h10 = H(ix+1, iz  );
-    float h01 = H(ix,   iz+1);
-    float h11 = H(ix+1, iz+1);
+void Terrain::draw(const rc::math::Frustum& frustum, const glm::vec3& camPos) const {
+    if (chunked_) { // łaty są już odrzucone w updateLod
+        draw();
+        return;
+    }
+    cull_ = {};
+    visible_.clear();
+    rc::gfx::geometry::cullMeshlets(meshlets_, frustum, camPos, visible_, cull_);
+    if (visible_.empty())
+        return;
+    drawCounts_.clear();
+    drawOffsets_.clear();
+    for (const auto& r: visible_) {
+        drawCounts_.push_back(static_cast<GLsizei>(r.count));
+        drawOffsets_.push_back(reinterpret_cast<const void*>(static_cast<std::uintptr_t>(r.first) * sizeof(unsigned int)));
+    }
 
-    float hx0 = glm::mix(h00, h10, fx);
-    float hx1 = glm::mix(h01, h11, fx);
-    return glm::mix(hx0, hx1, fz);
+    glBindVertexArray(vao_);
+    glMultiDrawElements(GL_TRIANGLES, drawCounts_.data(), GL_UNSIGNED_INT, drawOffsets_.data(),
+                        static_cast<GLsizei>(drawCounts_.size()));
+    glBindVertexArray(0);
 }
 
-void Terrain::uploadToGPU() {
+std::uint32_t Terrain::lodSlotCount_() const {
+    return static_cast<std::uint32_t>(std::min<std::size_t>(lodSlots_, quadtree_.nodeCount()));
+}
 
-    if (vao_)
-        glDeleteVertexArrays(1, &vao_);
-    if (vbo_)
-        glDeleteBuffers(1, &vbo_);
-    if (ibo_)
-        glDeleteBuffers(1, &ibo_);
+void Terrain::uploadLod_() {
+    // Pula stałej liczby łat po kPatchVertexCount wierzchołków - łata rysowana z base vertex = miejsce * rozmiar
+    // łaty i wspólnymi indeksami 16-bit (16 wariantów zszycia). W Packed każda łata ma swoją ramkę
+    // kwantyzacji (base instance = miejsce).
+    using rc::gfx::geometry::PackedVertex;
+    const std::uint32_t slots = lodSlotCount_();
+    const std::size_t vertexSize = packed_ ? sizeof(PackedVertex) : sizeof(TVertex);
+    const auto patch = TerrainQuadtree::buildPatchIndices();
+    patchFirst_ = patch.first;
+    patchCount_ = patch.count;
 
     glGenVertexArrays(1, &vao_);
     glGenBuffers(1, &vbo_);
     glGenBuffers(1, &ibo_);
+    glGenBuffers(1, &lodCmdBuf_);
 
     glBindVertexArray(vao_);
     glBindBuffer(GL_ARRAY_BUFFER, vbo_);
-    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(gpuVerts_.size() * sizeof(TVertex)), gpuVerts_.data(),
-                 GL_STATIC_DRAW);
-
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(TVertex), reinterpret_cast<void*>(offsetof(TVertex, pos)));
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(TVertex), reinterpret_cast<void*>((offsetof(TVertex, nrm))));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(TVertex), reinterpret_cast<void*>((offsetof(TVertex, uv))));
-    glEnableVertexAttribArray(2);
+    const std::size_t vBytes = slots * TerrainQuadtree::kPatchVertexCount * vertexSize;
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(vBytes), nullptr, GL_DYNAMIC_DRAW);
+    gpuBytes_ = vBytes;
+    rc::gfx::render::setupVertexAttribs(packed_ ? rc::gfx::geometry::VertexFormat::Packed
+                                               : rc::gfx::geometry::VertexFormat::Float);
+    if (packed_) {
+        glGenBuffers(1, &quantVbo_);
+        glBindBuffer(GL_ARRAY_BUFFER, quantVbo_);
+        const std::size_t qBytes = slots * 2 * sizeof(glm::vec4);
+        glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(qBytes), nullptr, GL_DYNAMIC_DRAW);
+        gpuBytes_ += qBytes;
+        rc::gfx::render::setupQuantAttribs();
+    }
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ibo_);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices_.size() * sizeof(unsigned int)),
-                 indices_.data(), GL_STATIC_DRAW);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(patch.indices.size() * sizeof(std::uint16_t)),
+                 patch.indices.data(), GL_STATIC_DRAW);
+    gpuBytes_ += patch.indices.size() * sizeof(std::uint16_t);
 
     glBindVertexArray(0);
-}
-
-void Terrain::draw() const {
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
 
-    glBindVertexArray(vao_);
-    glDrawElements(GL_TRIANGLES, static_cast<GLsizei>(indices_.size()), GL_UNSIGNED_INT, nullptr);
-    glBindVertexArray(0);
+    lodSlotKey_.assign(slots, 0);
+    lodSlotFrame_.assign(slots, 0);
+    lodFree_.resize(slots);
+    for (std::uint32_t i = 0; i < slots; i++)
+        lodFree_[i] = slots - 1 - i; // pop_back daje kolejne miejsca od 0
 }
 
-float Terrain::minH() const {
-    float minHeight = std::numeric_limits<float>::max();
-    for (auto& v: vertices_) {
-        minHeight = std::min(minHeight, v.y);
+void Terrain::updateLod(const glm::vec3& camPos, const rc::math::Frustum& frustum) {
+    using rc::gfx::geometry::PackedVertex;
+    constexpr std::uint32_t kNoSlot = std::numeric_limits<std::uint32_t>::max();
+    lod_ = {};
+    lodCmdCount_ = 0;
+    if (!chunked_ || !vao_)
+        return;
+
+    TerrainQuadtree::SelectStats sel;
+    quadtree_.select(camPos, &frustum, lodNodes_, &sel);
+    lod_.nodes = sel.selected;
+    lod_.culled = sel.culled;
+    lodFrame_++;
+
+    // Brakujące łaty dostają wolne miejsce albo najdawniej rysowane spoza bieżącego wyboru
+    std::vector<std::uint32_t> slotOf(lodNodes_.size(), kNoSlot);
+    std::vector<std::size_t> missing;
+    for (std::size_t i = 0; i < lodNodes_.size(); i++) {
+        if (const auto it = lodSlotOf_.find(lodNodes_[i].key()); it != lodSlotOf_.end()) {
+            slotOf[i] = it->second;
+            lodSlotFrame_[it->second] = lodFrame_;
+        } else {
+            missing.push_back(i);
+        }
+    }
+    std::vector<std::uint32_t> missingSlot;
+    for (const std::size_t i: missing) {
+        std::uint32_t slot = kNoSlot;
+        if (!lodFree_.empty()) {
+            slot = lodFree_.back();
+            lodFree_.pop_back();
+        } else {
+            std::uint32_t oldest = lodFrame_;
+            for (std::uint32_t s = 0; s < lodSlotFrame_.size(); s++)
+                if (lodSlotFrame_[s] < oldest) {
+                    oldest = lodSlotFrame_[s];
+                    slot = s;
+                }
+            if (slot != kNoSlot)
+                lodSlotOf_.erase(lodSlotKey_[slot]);
+        }
+        if (slot == kNoSlot) {
+            lod_.dropped++;
+            missingSlot.push_back(kNoSlot);
+            continue;
+        }
+        slotOf[i] = slot;
+        lodSlotKey_[slot] = lodNodes_[i].key();
+        lodSlotFrame_[slot] = lodFrame_;
+        lodSlotOf_[lodSlotKey_[slot]] = slot;
+        missingSlot.push_back(slot);
     }
-    return minHeight;
-}
-float Terrain::maxH() const {
-    float maxHeight = std::numeric_limits<float>::lowest();
-    for (auto& v: vertices_) {
 
-        maxHeight = std::max(maxHeight, v.y);
+    // łaty budowane równolegle, wysyłane z wątku GL
+    if (!missing.empty()) {
+        constexpr std::size_t kPatch = TerrainQuadtree::kPatchVertexCount;
+        std::vector<TVertex> verts(missing.size() * kPatch);
+        std::vector<PackedVertex> packed(packed_ ? verts.size() : 0);
+        std::vector<std::array<glm::vec4, 2>> quant(packed_ ? missing.size() : 0);
+        rc::common::ThreadPool::shared().parallelFor(missing.size(), 1, [&](size_t m0, size_t m1, size_t) {
+            for (size_t m = m0; m < m1; m++) {
+                if (missingSlot[m] == kNoSlot)
+                    continue;
+                TVertex* v = verts.data() + m * kPatch;
+                quadtree_.buildPatch(lodNodes_[missing[m]], heights_(), normals_, uvPerUnit_, v);
+                if (!packed_)
+                    continue;
+                glm::vec3 lo(std::numeric_limits<float>::max()), hi(std::numeric_limits<float>::lowest());
+                glm::vec2 uvLo(std::numeric_limits<float>::max());
+                for (size_t k = 0; k < kPatch; k++) {
+                    lo = glm::min(lo, v[k].pos);
+                    hi = glm::max(hi, v[k].pos);
+                    uvLo = glm::min(uvLo, v[k].uv);
+                }
+                const auto box = rc::gfx::geometry::fitQuantBox(lo, hi, uvLo);
+                for (size_t k = 0; k < kPatch; k++)
+                    packed[m * kPatch + k] = rc::gfx::geometry::packVertex(v[k].pos, v[k].nrm, v[k].uv, box);
+                quant[m] = rc::gfx::geometry::packedQuantRows(box);
+            }
+        });
+        const std::size_t vertexSize = packed_ ? sizeof(PackedVertex) : sizeof(TVertex);
+        const auto* src = packed_ ? reinterpret_cast<const unsigned char*>(packed.data())
+                                  : reinterpret_cast<const unsigned char*>(verts.data());
+        for (size_t m = 0; m < missing.size(); m++) {
+            if (missingSlot[m] == kNoSlot)
+                continue;
+            glBindBuffer(GL_ARRAY_BUFFER, vbo_);
+            glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(missingSlot[m] * kPatch * vertexSize),
+                            static_cast<GLsizeiptr>(kPatch * vertexSize), src + m * kPatch * vertexSize);
+            if (packed_) {
+                glBindBuffer(GL_ARRAY_BUFFER, quantVbo_);
+                glBufferSubData(GL_ARRAY_BUFFER, static_cast<GLintptr>(missingSlot[m] * sizeof(quant[m])),
+                                sizeof(quant[m]), quant[m].data());
+            }
+            lod_.uploaded++;
+        }
+        glBindBuffer(GL_ARRAY_BUFFER, 0);
+    }
+
+    // układ DrawElementsIndirectCommand z GL
+    struct IndirectCmd {
+        GLuint count, instanceCount, firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+    std::vector<IndirectCmd> cmds;
+    cmds.reserve(lodNodes_.size());
+    for (std::size_t i = 0; i < lodNodes_.size(); i++) {
+        if (slotOf[i] == kNoSlot)
+            continue;
+        const std::uint8_t s = lodNodes_[i].stitch;
+        cmds.push_back({patchCount_[s], 1, patchFirst_[s],
+                        static_cast<GLint>(slotOf[i] * TerrainQuadtree::kPatchVertexCount), slotOf[i]});
+        lod_.triangles += patchCount_[s] / 3;
     }
-    return maxHeight;
+    lod_.resident = lodSlotOf_.size();
+    lodCmdCount_ = static_cast<GLsizei>(cmds.size());
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, lodCmdBuf_);
+    glBufferData(GL_DRAW_INDIRECT_BUFFER, static_cast<GLsizeiptr>(cmds.size() * sizeof(IndirectCmd)), cmds.data(),
+                 GL_STREAM_DRAW);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 }
@@ -5,12 +5,23 @@
 #ifndef TERRAIN_HPP
 #define TERRAIN_HPP
 
+#include <array>
+#include <cstdint>
 #include <glm/glm.hpp>
+#include <span>
+#include <unordered_map>
 #include <vector>
 
+#include "HeightPyramid.hpp"
+#include "NoiseLayerCache.hpp"
 #include "SimplexNoise.hpp"
+#include "TerrainQuadtree.hpp"
+#include "common/Progress.hpp"
 #include "glad.h"
+#include "gfx/geometry/PackedVertex.hpp"
+#include "gfx/geometry/Meshlets.hpp"
 #include "math/Array_2D.hpp"
+#include "math/Frustum.hpp"
 
 struct TVertex {
     glm::vec3 pos;
@@ -20,34 +31,150 @@ struct TVertex {
 
 class Terrain {
 public:
+    struct GenerateStats {
+        double noiseMs = 0.0;  // fBm (z gradientem, gdy są normalne) dla wszystkich próbek
+        double meshMs = 0.0;   // wysokości, spakowane normalne, piramida min/max, ramki quadtree
+        double uploadMs = 0.0; // wierzchołki, indeksy i meshlety wprost do buforów GL (suma kroków uploadStep)
+        int uploadSteps = 0;   // klatki uploadStep (uploadToGPU - jeden krok)
+        double megasamplesPerSec = 0.0; // próbki fBm / s (w milionach)
+        unsigned threads = 1;
+        const char* simd = "scalar"; // ścieżka SimplexNoise::fbmRow
+        int layersComputed = 0;      // oktawy policzone w tym generate (z pamięcią warstw)
+        int layersReused = 0;        // oktawy wzięte z pamięci warstw
+    };
+    struct LodStats {
+        std::size_t nodes = 0;     // liście w ostrosłupie
+        std::size_t culled = 0;    // poddrzewa poza ostrosłupem
+        std::size_t uploaded = 0;  // łaty zbudowane i wysłane w tej klatce
+        std::size_t resident = 0;  // łaty na GPU
+        std::size_t dropped = 0;   // bez wolnego miejsca w puli - nie rysowane
+        std::size_t triangles = 0;
+    };
+
     Terrain(int width, int height, int seed);
     void releaseGL();
 
     void generate(float scale, float frequency = 0.01f, int octaves = 8, float lacunarity = 2.0f,
                   float persistence = 0.5f, float exponent = 1.0f, float height_scale = 20.0f);
+    // Wysokości w świecie z pliku (loadHeightmap) zamiast generate: wymiary z tablicy, normalne z różnic
+    // wysokości. Widok na zmapowany plik zostaje widokiem - bez kopii.
+    void setHeights(Array_2D<float> heights);
+    [[nodiscard]] const Array_2D<float>& heightmap() const { return heightmap_; }
     [[nodiscard]] float sampleHeightBilinear(float x, float z) const;
+    // out[k] = sampleHeightBilinear(x[k], z[k]) bit w bit; grad (rozmiar jak out albo puste) dostaje
+    // (dh/dx, dh/dz) tej samej interpolacji. Z AVX2 po 8 punktów przez gather, duże partie w puli wątków.
+    void sampleHeights(std::span<const float> x, std::span<const float> z, std::span<float> out,
+                       std::span<glm::vec2> grad = {}) const;
+    // pierwsze przecięcie origin + t * dir (t w [0, tMax]) z powierzchnią sampleHeightBilinear w obrębie mapy;
+    // piramida min/max przeskakuje puste przestrzenie nad terenem
+    [[nodiscard]] bool raycast(const glm::vec3& origin, const glm::vec3& dir, float tMax, float& tHit) const;
+    // odcinek a-b przez cały czas co najmniej clearance nad terenem (clearance = 0 - linia widzenia)
+    [[nodiscard]] bool segmentClear(const glm::vec3& a, const glm::vec3& b, float clearance = 0.0f) const;
     void uploadToGPU();
+    // Upload rozłożony na klatki wątku GL: beginUpload tworzy bufory, uploadStep dopisuje porcje wierszy
+    // wierzchołków i pasów indeksów przez mniej więcej budgetMs i zwraca true po ostatniej. Do tego czasu
+    // teren nie nadaje się do draw - rysuje się poprzedni. W trybie łat beginUpload robi wszystko od razu.
+    void beginUpload();
+    bool uploadStep(double budgetMs);
+    [[nodiscard]] bool uploading() const { return upload_.active; }
+    [[nodiscard]] float uploadProgress() const;
     void draw() const;
+    // tylko meshlety w ostrosłupie i nie odwrócone od kamery - jeden glMultiDrawElements
+    void draw(const rc::math::Frustum& frustum, const glm::vec3& camPos) const;
+    [[nodiscard]] const rc::gfx::geometry::MeshletCullStats& lastCull() const { return cull_; }
+    // 16 B PackedVertex zamiast 32 B TVertex (shader terrain_packed.vert); działa od następnego uploadToGPU
+    void setPackedVertices(bool packed) { packed_ = packed; }
+    [[nodiscard]] bool packedVertices() const { return packed_; }
+    [[nodiscard]] size_t gpuBytes() const { return gpuBytes_; }
+    // pamięć CPU po generate/upload: wysokości, normalne, meshlety, piramida min/max, ramki quadtree
+    [[nodiscard]] size_t cpuBytes() const;
+    // analityczne normalne spakowane do 4 B (packOctNormal); bez nich - różnice centralne wysokości.
+    // Działa od następnego generate.
+    void setPackedNormals(bool keep) { packedNormals_ = keep; }
+    [[nodiscard]] bool packedNormals() const { return packedNormals_; }
+    [[nodiscard]] const GenerateStats& lastGenerate() const { return genStats_; }
+    // Warstwy oktaw z cache (nie posiadana, musi przeżyć teren): zmiana wysokości, wykładnika, persystencji
+    // czy liczby oktaw nie liczy szumu od nowa. nullptr - fBm liczone w całości w fbmRow.
+    void setLayerCache(NoiseLayerCache* cache) { layerCache_ = cache; }
+    // Postęp generate w wierszach (z warstwami oktaw) i przerwanie przez cancel - generate wraca wtedy
+    // od razu, a teren nie nadaje się do użycia. Nie posiadany; nullptr - bez raportowania.
+    void setProgress(rc::common::Progress* progress) { progress_ = progress; }
+
+    // Teren w łatach TerrainQuadtree zamiast jednej siatki: generate liczy tylko wysokości, łaty powstają
+    // przy pierwszym wyborze i czekają w puli na GPU (najdawniej używane wypadają). Działa od następnego generate.
+    void setChunkedLod(bool chunked) { chunked_ = chunked; }
+    [[nodiscard]] bool chunkedLod() const { return chunked_; }
+    void setLodRange(float range) { quadtree_.setLodRange(range); }
+    [[nodiscard]] float lodRange() const { return quadtree_.lodRange(); }
+    // w trybie łat przed draw(): wybór węzłów dla kamery i dosłanie brakujących łat
+    void updateLod(const glm::vec3& camPos, const rc::math::Frustum& frustum);
+    [[nodiscard]] const LodStats& lastLod() const { return lod_; }
 
+    // zakres wysokości z ostatniego generate / setHeights
     [[nodiscard]] float minH() const;
     [[nodiscard]] float maxH() const;
 
     float worldHeightAt(int x, int z) const {
         x = std::clamp(x, 0, width_  - 1);
         z = std::clamp(z, 0, height_ - 1);
-        return vertices_[z * width_ + x].y;
+        return heightmap_.data()[z * width_ + x];
     }
 
 private:
     static constexpr float offset_ = 137.0f;
+    static constexpr float uvPerUnit_ = 0.5f; // 2 m na powtórzenie tekstury
+    // łaty w puli GPU; przy domyślnym lodRange wybór to ~100-200 liści
+    static constexpr std::uint32_t lodSlots_ = 512;
+    static constexpr size_t indexStripe_ = 7;       // kwady w pionowym pasie indeksów
+    static constexpr size_t uploadChunk_ = 1 << 15; // wierzchołki (kwady) na porcję uploadStep
     int width_, height_;
+    // Jedyne źródło kształtu terenu: wysokości w świecie, rzędami. Siatka GPU powstaje z nich w uploadToGPU.
     Array_2D<float> heightmap_;
-    std::vector<glm::vec3> vertices_;
-    std::vector<unsigned int> indices_;
-    std::vector<glm::vec3> normals_;
-    std::vector<TVertex> gpuVerts_;
+    std::vector<std::uint32_t> normals_; // packOctNormal na wierzchołek albo puste
+    float minH_ = 0.0f, maxH_ = 0.0f;
+    HeightPyramid pyramid_;
+    size_t indexCount_ = 0;
+    std::vector<rc::gfx::geometry::Meshlet> meshlets_;
+    mutable std::vector<rc::gfx::geometry::IndexRange> visible_;
+    mutable std::vector<GLsizei> drawCounts_;
+    mutable std::vector<const void*> drawOffsets_;
+    mutable rc::gfx::geometry::MeshletCullStats cull_;
+    int seed_;
     SimplexNoise noise_;
+    NoiseLayerCache* layerCache_ = nullptr;
+    rc::common::Progress* progress_ = nullptr;
     GLuint vbo_, vao_, ibo_;
+    GLuint quantVbo_ = 0; // ramka kwantyzacji dla formatu spakowanego
+    bool packed_ = false;
+    bool packedNormals_ = true;
+    size_t gpuBytes_ = 0;
+    GenerateStats genStats_;
+
+    [[nodiscard]] std::span<const float> heights_() const {
+        return {heightmap_.data(), static_cast<size_t>(width_) * height_};
+    }
+    struct UploadState {
+        bool active = false;
+        size_t nextRow = 0, nextStripe = 0;
+        rc::gfx::geometry::QuantBox box{};
+        std::vector<std::vector<rc::gfx::geometry::Meshlet>> stripeMeshlets; // [pas indeksów]
+    };
+    UploadState upload_;
+    void uploadVertexRows_(size_t y0, size_t y1);
+    void uploadIndexStripes_(size_t s0, size_t s1);
+    void finishUpload_();
+    void uploadLod_();
+    [[nodiscard]] std::uint32_t lodSlotCount_() const;
+    bool chunked_ = false;
+    TerrainQuadtree quadtree_;
+    std::array<std::uint32_t, TerrainQuadtree::kStitchVariants> patchFirst_{}, patchCount_{};
+    std::vector<TerrainQuadtree::Node> lodNodes_;
+    std::unordered_map<std::uint32_t, std::uint32_t> lodSlotOf_; // Node::key -> miejsce w puli
+    std::vector<std::uint32_t> lodSlotKey_, lodSlotFrame_, lodFree_;
+    std::uint32_t lodFrame_ = 0;
+    GLuint lodCmdBuf_ = 0;
+    GLsizei lodCmdCount_ = 0;
+    LodStats lod_;
 };
 
 
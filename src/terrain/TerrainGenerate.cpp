@@ -0,0 +1,335 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// Część Terrain bez GL: generowanie i wczytywanie wysokości, próbkowanie, przecięcia z piramidą min/max.
+// Osobno od Terrain.cpp (bufory i rysowanie), żeby benchmark budował się bez kontekstu GL.
+
+#include "Terrain.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <memory>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "NoiseLayerCache.hpp"
+#include "SimplexNoise.hpp"
+#include "common/SimdTarget.hpp"
+#include "common/ThreadPool.hpp"
+#include "gfx/geometry/PackedVertex.hpp"
+#include "math/Array_2D.hpp"
+
+Terrain::Terrain(int width, int height, int seed) :
+    width_(width), height_(height), heightmap_(width, height), seed_(seed), noise_(seed), vbo_(0), vao_(0), ibo_(0) {}
+
+void Terrain::generate(float scale, float frequency, int octaves, float lacunarity, float persistence, float exponent,
+                       float height_scale) {
+    // Każdy przebieg dzieli mapę na pasy wierszy w puli wątków. Wartość każdego elementu zależy tylko od jego
+    // współrzędnych, a redukcja min/max jest dokładna - wynik nie zależy od liczby wątków.
+    // Zostają tylko wysokości w świecie (heightmap_) i opcjonalnie spakowane normalne - siatkę buduje uploadToGPU.
+    auto& pool = rc::common::ThreadPool::shared();
+    const auto t0 = std::chrono::steady_clock::now();
+    const auto W = static_cast<size_t>(width_), H = static_cast<size_t>(height_);
+    constexpr size_t kMinRows = 8;
+
+    std::vector<float> bandMin(pool.chunkCount(H, kMinRows), std::numeric_limits<float>::max());
+    std::vector<float> bandMax(bandMin.size(), std::numeric_limits<float>::lowest());
+    const bool withNormals = packedNormals_;
+    // Oktaw o okresie krótszym niż ~4 oczka siatki (częstotliwość * scale > 0.25) siatka nie odwzorowuje -
+    // ich nachylenie w normalnych dałoby tylko szum cieniowania, więc gradient ich nie sumuje.
+    int gradOctaves = 0;
+    for (float f = frequency * scale; gradOctaves < octaves && f <= 0.25f; f *= lacunarity)
+        gradOctaves++;
+
+    // Z pamięcią warstw (gdy cały zestaw oktaw mieści się w jej budżecie) fBm składa się z surowych warstw
+    // oktaw w kolejności fbmRow - te same bity, a liczone są tylko warstwy, których jeszcze nie ma.
+    std::vector<std::shared_ptr<const NoiseLayerCache::Layer>> layers;
+    std::vector<float> octFreq, octAmp;
+    size_t need = 0;
+    for (int o = 0; layerCache_ && o < octaves; o++)
+        need += NoiseLayerCache::layerBytes(width_, height_, withNormals && o < gradOctaves);
+    const bool useLayers = layerCache_ && need <= layerCache_->budget();
+
+    // postęp w wierszach: warstwy oktaw (z pamięci od razu) i dwa przebiegi po mapie
+    rc::common::Progress* const progress = progress_;
+    const auto cancelled = [progress] { return progress && progress->cancelled(); };
+    if (progress)
+        progress->addWork((useLayers ? static_cast<size_t>(octaves) : 0) * H + 2 * H);
+    genStats_.layersComputed = genStats_.layersReused = 0;
+    if (useLayers) {
+        const auto before = layerCache_->stats();
+        float f = frequency, amplitude = 1.0f;
+        for (int o = 0; o < octaves; o++) {
+            octFreq.push_back(f);
+            octAmp.push_back(amplitude);
+            layers.push_back(layerCache_->layer(noise_, {seed_, width_, height_, scale, offset_, f},
+                                                withNormals && o < gradOctaves, progress));
+            if (!layers.back())
+                return; // przerwane
+            f *= lacunarity;
+            amplitude *= persistence;
+        }
+        const auto after = layerCache_->stats();
+        genStats_.layersComputed = static_cast<int>(after.misses - before.misses);
+        genStats_.layersReused = static_cast<int>(after.hits - before.hits);
+    }
+
+    // Wiersz naraz przez fbmRow (SIMD), z normalnymi także analityczny gradient fBm. Gradient czeka w grad
+    // na min/max całej mapy - dopiero wtedy przechodzi w normalną. Z warstwami gradient składa się dopiero tam.
+    std::vector<float> xs(W);
+    for (size_t x = 0; x < W; x++)
+        xs[x] = static_cast<float>(x) * scale + offset_;
+    std::vector<glm::vec2> grad(withNormals && layers.empty() ? W * H : 0);
+    pool.parallelFor(H, kMinRows, [&](size_t y0, size_t y1, size_t band) {
+        std::vector<float> du(grad.empty() ? 0 : W), dv(grad.empty() ? 0 : W);
+        for (size_t y = y0; y < y1; y++) {
+            if (cancelled())
+                return;
+            float* row = heightmap_.beginRow(static_cast<int>(y));
+            const float fy = static_cast<float>(y) * scale + offset_;
+            if (!layers.empty()) {
+                std::fill(row, row + W, 0.0f);
+                for (size_t o = 0; o < layers.size(); o++) {
+                    const float* v = layers[o]->value.data() + y * W;
+                    const float a = octAmp[o];
+                    for (size_t x = 0; x < W; x++)
+                        row[x] += v[x] * a;
+                }
+            } else if (!grad.empty())
+                noise_.fbmRow(xs, fy, std::span<float>(row, W), du, dv, frequency, octaves, lacunarity, persistence,
+                              gradOctaves);
+            else
+                noise_.fbmRow(xs, fy, std::span<float>(row, W), frequency, octaves, lacunarity, persistence);
+            for (size_t x = 0; x < W; x++) {
+                bandMin[band] = std::min(bandMin[band], row[x]);
+                bandMax[band] = std::max(bandMax[band], row[x]);
+                if (!grad.empty())
+                    grad[y * W + x] = glm::vec2(du[x], dv[x]);
+            }
+            if (progress)
+                progress->advance(1);
+        }
+    });
+    if (cancelled())
+        return;
+    const auto t1 = std::chrono::steady_clock::now();
+
+    // normalizacja do [0, 1] jak Array_2D::normalize, złączona z przebiegiem wysokości
+    const float hMin = *std::min_element(bandMin.begin(), bandMin.end());
+    const float hMax = *std::max_element(bandMax.begin(), bandMax.end());
+    const float range = hMax - hMin;
+    // te same pasy zbierają teraz min/max wysokości w świecie (minH/maxH bez przeglądania mapy)
+    std::fill(bandMin.begin(), bandMin.end(), std::numeric_limits<float>::max());
+    std::fill(bandMax.begin(), bandMax.end(), std::numeric_limits<float>::lowest());
+
+    // Wysokość h = height_scale * n^exponent, n = (fbm - hMin) / range, fbm próbkowane w (x, y) * scale.
+    // dh/dx = height_scale * exponent * n^(exponent-1) * fbm_u * scale / range (tak samo po y), a normalna
+    // powierzchni (x, h, y) to (-dh/dx, 1, -dh/dy).
+    const float dScale = range != 0.0f ? height_scale * scale / range : 0.0f;
+    normals_ = std::vector<std::uint32_t>(withNormals ? W * H : 0);
+    pool.parallelFor(H, kMinRows, [&](size_t y0, size_t y1, size_t band) {
+        std::vector<glm::vec2> rowGrad(withNormals && !layers.empty() ? W : 0);
+        for (size_t y = y0; y < y1; y++) {
+            if (cancelled())
+                return;
+            float* row = heightmap_.beginRow(static_cast<int>(y));
+            // gradient z warstw: ndx * (amplituda * częstotliwość) po oktawach, jak w fbmRow
+            if (!rowGrad.empty()) {
+                std::fill(rowGrad.begin(), rowGrad.end(), glm::vec2(0.0f));
+                for (int o = 0; o < gradOctaves; o++) {
+                    const float* dx = layers[o]->dx.data() + y * W;
+                    const float* dy = layers[o]->dy.data() + y * W;
+                    const float af = octAmp[o] * octFreq[o];
+                    for (size_t x = 0; x < W; x++)
+                        rowGrad[x] += glm::vec2(dx[x] * af, dy[x] * af);
+                }
+            }
+            for (size_t x = 0; x < W; x++) {
+                const float n = range != 0.0f ? (row[x] - hMin) / range : 0.0f;
+                row[x] = std::pow(n, exponent) * height_scale;
+                bandMin[band] = std::min(bandMin[band], row[x]);
+                bandMax[band] = std::max(bandMax[band], row[x]);
+                if (!withNormals)
+                    continue;
+
+                // n^(exponent-1) rozbiega w n = 0 dla exponent < 1 - minimum jak dla wysokości ~1e-4
+                const float slope = exponent == 1.0f
+                                            ? dScale
+                                            : dScale * exponent * std::pow(std::max(n, 1e-4f), exponent - 1.0f);
+                const glm::vec2 g = rowGrad.empty() ? grad[y * W + x] : rowGrad[x];
+                normals_[y * W + x] =
+                        rc::gfx::geometry::packOctNormal(glm::normalize(glm::vec3(-g.x * slope, 1.0f, -g.y * slope)));
+            }
+            if (progress)
+                progress->advance(1);
+        }
+    });
+    grad = {};
+    if (cancelled())
+        return;
+    minH_ = *std::min_element(bandMin.begin(), bandMin.end());
+    maxH_ = *std::max_element(bandMax.begin(), bandMax.end());
+
+    meshlets_.clear();
+    pyramid_.build(width_, height_, heights_());
+    if (chunked_)
+        quadtree_.build(width_, height_, heights_());
+
+    const auto t2 = std::chrono::steady_clock::now();
+    genStats_.noiseMs = std::chrono::duration<double, std::milli>(t1 - t0).count();
+    genStats_.meshMs = std::chrono::duration<double, std::milli>(t2 - t1).count();
+    genStats_.uploadMs = 0.0;
+    genStats_.threads = pool.concurrency();
+    genStats_.simd = SimplexNoise::simdLevelName(SimplexNoise::simdLevel());
+    genStats_.megasamplesPerSec =
+            genStats_.noiseMs > 0.0 ? static_cast<double>(W * H) / (genStats_.noiseMs * 1000.0) : 0.0;
+}
+
+void Terrain::setHeights(Array_2D<float> heights) {
+    const auto t0 = std::chrono::steady_clock::now();
+    width_ = heights.width();
+    height_ = heights.height();
+    heightmap_ = std::move(heights);
+    normals_ = {};
+    auto& pool = rc::common::ThreadPool::shared();
+    constexpr size_t kMinRows = 64;
+    const auto W = static_cast<size_t>(width_), H = static_cast<size_t>(height_);
+    std::vector<float> bandMin(pool.chunkCount(H, kMinRows), std::numeric_limits<float>::max());
+    std::vector<float> bandMax(bandMin.size(), std::numeric_limits<float>::lowest());
+    pool.parallelFor(H, kMinRows, [&](size_t y0, size_t y1, size_t band) {
+        const auto [lo, hi] = std::minmax_element(heightmap_.data() + y0 * W, heightmap_.data() + y1 * W);
+        bandMin[band] = *lo;
+        bandMax[band] = *hi;
+    });
+    minH_ = *std::min_element(bandMin.begin(), bandMin.end());
+    maxH_ = *std::max_element(bandMax.begin(), bandMax.end());
+    meshlets_.clear();
+    pyramid_.build(width_, height_, heights_());
+    if (chunked_)
+        quadtree_.build(width_, height_, heights_());
+
+    genStats_ = {};
+    genStats_.meshMs =
+            std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+    genStats_.threads = pool.concurrency();
+}
+
+namespace {
+    // Interpolacja dwuliniowa z przycinaniem do brzegu. mix rozpisany jak w glm (x * (1 - a) + y * a) -
+    // ścieżka AVX2 wykonuje te same działania, więc wyniki są identyczne.
+    float bilinearHeight(const float* h, int W, int H, float x, float z, glm::vec2* grad) {
+        const int ix = static_cast<int>(std::floor(x));
+        const int iz = static_cast<int>(std::floor(z));
+        const float fx = x - static_cast<float>(ix);
+        const float fz = z - static_cast<float>(iz);
+        const size_t x0 = std::clamp(ix, 0, W - 1), x1 = std::clamp(ix + 1, 0, W - 1);
+        const size_t r0 = static_cast<size_t>(std::clamp(iz, 0, H - 1)) * W;
+        const size_t r1 = static_cast<size_t>(std::clamp(iz + 1, 0, H - 1)) * W;
+
+        const float h00 = h[r0 + x0], h10 = h[r0 + x1];
+        const float h01 = h[r1 + x0], h11 = h[r1 + x1];
+        const float hx0 = h00 * (1.0f - fx) + h10 * fx;
+        const float hx1 = h01 * (1.0f - fx) + h11 * fx;
+        if (grad)
+            *grad = glm::vec2((h10 - h00) * (1.0f - fz) + (h11 - h01) * fz, hx1 - hx0);
+        return hx0 * (1.0f - fz) + hx1 * fz;
+    }
+
+#ifdef RC_SIMD_X86
+    // 8 punktów naraz: cztery narożniki przez gather (indeksy 32-bit - mapa do 2^31 próbek)
+    RC_TARGET("avx2")
+    void bilinearHeightsAVX2(const float* h, int W, int H, const float* xs, const float* zs, float* out,
+                             float* grad, size_t n) {
+        const __m256i zero = _mm256_setzero_si256(), one = _mm256_set1_epi32(1);
+        const __m256i xMax = _mm256_set1_epi32(W - 1), zMax = _mm256_set1_epi32(H - 1), w = _mm256_set1_epi32(W);
+        const __m256 onef = _mm256_set1_ps(1.0f);
+        for (size_t k = 0; k < n; k += 8) {
+            const __m256 x = _mm256_loadu_ps(xs + k), z = _mm256_loadu_ps(zs + k);
+            const __m256 flx = _mm256_floor_ps(x), flz = _mm256_floor_ps(z);
+            const __m256i ix = _mm256_cvttps_epi32(flx), iz = _mm256_cvttps_epi32(flz);
+            const __m256 fx = _mm256_sub_ps(x, flx), fz = _mm256_sub_ps(z, flz);
+            const __m256i x0 = _mm256_min_epi32(_mm256_max_epi32(ix, zero), xMax);
+            const __m256i x1 = _mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(ix, one), zero), xMax);
+            const __m256i r0 = _mm256_mullo_epi32(_mm256_min_epi32(_mm256_max_epi32(iz, zero), zMax), w);
+            const __m256i r1 =
+                    _mm256_mullo_epi32(_mm256_min_epi32(_mm256_max_epi32(_mm256_add_epi32(iz, one), zero), zMax), w);
+
+            const __m256 h00 = _mm256_i32gather_ps(h, _mm256_add_epi32(r0, x0), 4);
+            const __m256 h10 = _mm256_i32gather_ps(h, _mm256_add_epi32(r0, x1), 4);
+            const __m256 h01 = _mm256_i32gather_ps(h, _mm256_add_epi32(r1, x0), 4);
+            const __m256 h11 = _mm256_i32gather_ps(h, _mm256_add_epi32(r1, x1), 4);
+            const __m256 omx = _mm256_sub_ps(onef, fx), omz = _mm256_sub_ps(onef, fz);
+            const __m256 hx0 = _mm256_add_ps(_mm256_mul_ps(h00, omx), _mm256_mul_ps(h10, fx));
+            const __m256 hx1 = _mm256_add_ps(_mm256_mul_ps(h01, omx), _mm256_mul_ps(h11, fx));
+            _mm256_storeu_ps(out + k, _mm256_add_ps(_mm256_mul_ps(hx0, omz), _mm256_mul_ps(hx1, fz)));
+            if (!grad)
+                continue;
+            const __m256 gx = _mm256_add_ps(_mm256_mul_ps(_mm256_sub_ps(h10, h00), omz),
+                                            _mm256_mul_ps(_mm256_sub_ps(h11, h01), fz));
+            const __m256 gz = _mm256_sub_ps(hx1, hx0);
+            // przeplot na pary (dx, dz): unpack działa w połówkach 128-bit
+            const __m256 lo = _mm256_unpacklo_ps(gx, gz), hi = _mm256_unpackhi_ps(gx, gz);
+            _mm256_storeu_ps(grad + 2 * k, _mm256_permute2f128_ps(lo, hi, 0x20));
+            _mm256_storeu_ps(grad + 2 * k + 8, _mm256_permute2f128_ps(lo, hi, 0x31));
+        }
+    }
+#endif
+} // namespace
+
+float Terrain::sampleHeightBilinear(float x, float z) const {
+    return bilinearHeight(heightmap_.data(), width_, height_, x, z, nullptr);
+}
+
+void Terrain::sampleHeights(std::span<const float> x, std::span<const float> z, std::span<float> out,
+                            std::span<glm::vec2> grad) const {
+    static_assert(sizeof(glm::vec2) == 2 * sizeof(float));
+    const auto run = [&](size_t begin, size_t end) {
+        size_t body = 0;
+#ifdef RC_SIMD_X86
+        if (SimplexNoise::simdLevel() == SimplexNoise::SimdLevel::AVX2) {
+            body = (end - begin) - (end - begin) % 8;
+            bilinearHeightsAVX2(heightmap_.data(), width_, height_, x.data() + begin, z.data() + begin,
+                                out.data() + begin, grad.empty() ? nullptr : &grad[begin].x, body);
+        }
+#endif
+        for (size_t k = begin + body; k < end; k++)
+            out[k] = bilinearHeight(heightmap_.data(), width_, height_, x[k], z[k], grad.empty() ? nullptr : &grad[k]);
+    };
+    // Poniżej kilkudziesięciu tysięcy punktów koszt podziału na wątki przewyższa zysk
+    constexpr size_t kParallelMin = size_t{1} << 16, kChunk = size_t{1} << 14;
+    if (out.size() < kParallelMin) {
+        run(0, out.size());
+        return;
+    }
+    rc::common::ThreadPool::shared().parallelFor(out.size(), kChunk,
+                                                 [&](size_t begin, size_t end, size_t) { run(begin, end); });
+}
+
+bool Terrain::raycast(const glm::vec3& origin, const glm::vec3& dir, float tMax, float& tHit) const {
+    return pyramid_.raycast(heights_(), origin, dir, tMax, tHit);
+}
+
+bool Terrain::segmentClear(const glm::vec3& a, const glm::vec3& b, float clearance) const {
+    // odstęp od terenu to przecięcie z terenem podniesionym o clearance, czyli odcinkiem obniżonym o tyle samo
+    const glm::vec3 down(0.0f, clearance, 0.0f);
+    return !pyramid_.segmentHits(heights_(), a - down, b - down);
+}
+
+size_t Terrain::cpuBytes() const {
+    return static_cast<size_t>(width_) * height_ * sizeof(float) + normals_.capacity() * sizeof(std::uint32_t) +
+           meshlets_.capacity() * sizeof(rc::gfx::geometry::Meshlet) + pyramid_.bytes() +
+           quadtree_.nodeCount() * sizeof(glm::vec2);
+}
+
+float Terrain::minH() const {
+    return minH_;
+}
+float Terrain::maxH() const {
+    return maxH_;
+}
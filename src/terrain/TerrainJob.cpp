@@ -0,0 +1,51 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "TerrainJob.hpp"
+
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+void TerrainJob::start(Terrain terrain, Work work) {
+    cancel();
+    progress_.reset();
+    error_.clear();
+    finished_.store(false, std::memory_order_relaxed);
+    thread_ = std::thread([this, terrain = std::move(terrain), work = std::move(work)]() mutable {
+        terrain.setProgress(&progress_);
+        try {
+            work(terrain);
+        } catch (const std::exception& e) {
+            error_ = e.what();
+        }
+        terrain.setProgress(nullptr);
+        if (!progress_.cancelled() && error_.empty()) {
+            std::lock_guard lk(mutex_);
+            result_.emplace(std::move(terrain));
+        }
+        finished_.store(true, std::memory_order_release);
+    });
+}
+
+void TerrainJob::cancel() {
+    progress_.cancel.store(true, std::memory_order_relaxed);
+    join_();
+    std::lock_guard lk(mutex_);
+    result_.reset();
+}
+
+std::optional<Terrain> TerrainJob::take() {
+    if (!thread_.joinable() || !finished_.load(std::memory_order_acquire))
+        return std::nullopt;
+    join_();
+    std::lock_guard lk(mutex_);
+    return std::exchange(result_, std::nullopt);
+}
+
+void TerrainJob::join_() {
+    if (thread_.joinable())
+        thread_.join();
+}
@@ -0,0 +1,51 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_TERRAINJOB_HPP
+#define ROLLERCOASTERGL_TERRAINJOB_HPP
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+
+#include "Terrain.hpp"
+#include "common/Progress.hpp"
+
+// Budowa terenu na osobnym wątku. work (generate albo setHeights) dostaje świeży Terrain bez zasobów GL -
+// bez dotykania GL. Wątek renderu odbiera gotowy teren przez take() i wysyła go na GPU po kawałku
+// (beginUpload / uploadStep), rysując do tego czasu poprzedni. Nowy start przerywa poprzednią pracę.
+class TerrainJob {
+public:
+    using Work = std::function<void(Terrain&)>;
+
+    TerrainJob() = default;
+    ~TerrainJob() { cancel(); }
+    TerrainJob(const TerrainJob&) = delete;
+    TerrainJob& operator=(const TerrainJob&) = delete;
+
+    void start(Terrain terrain, Work work);
+    // przerywa pracę i czeka na wątek (cancel sprawdzany co wiersz); nieodebrany wynik przepada
+    void cancel();
+    [[nodiscard]] bool running() const { return thread_.joinable() && !finished_.load(std::memory_order_acquire); }
+    [[nodiscard]] float progress() const { return progress_.fraction(); }
+    // Gotowy teren - raz, po zakończeniu pracy. Wyjątek z work daje nullopt, a jego treść error().
+    [[nodiscard]] std::optional<Terrain> take();
+    // błąd ostatniej pracy (po take), puste - bez błędu
+    [[nodiscard]] const std::string& error() const { return error_; }
+
+private:
+    void join_();
+
+    std::thread thread_;
+    rc::common::Progress progress_;
+    std::atomic<bool> finished_{false};
+    std::mutex mutex_;
+    std::optional<Terrain> result_; // chroniony mutex_
+    std::string error_;             // pisany przez wątek pracy przed finished_
+};
+
+#endif // ROLLERCOASTERGL_TERRAINJOB_HPP
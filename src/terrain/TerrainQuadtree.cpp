@@ -0,0 +1,245 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#include "TerrainQuadtree.hpp"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include "Terrain.hpp"
+#include "common/ThreadPool.hpp"
+#include "gfx/geometry/PackedVertex.hpp"
+
+void TerrainQuadtree::build(int width, int height, std::span<const float> heights) {
+    width_ = width;
+    height_ = height;
+    bounds_.clear();
+    if (width < 2 || height < 2 || heights.size() < static_cast<std::size_t>(width) * height)
+        return;
+
+    // korzeń to najmniejszy poziom, którego jeden węzeł przykrywa całą mapę
+    int levels = 1;
+    while ((kPatchQuads << (levels - 1)) < std::max(width - 1, height - 1))
+        levels++;
+    bounds_.resize(levels);
+
+    // poziom 0 z wysokości (węzeł z krawędziami, bo sąsiedzi dzielą brzeg), wyższe z czterech dzieci
+    const int nx0 = nodesX_(0), nz0 = nodesZ_(0);
+    bounds_[0].resize(static_cast<std::size_t>(nx0) * nz0);
+    rc::common::ThreadPool::shared().parallelFor(nz0, 1, [&](std::size_t j0, std::size_t j1, std::size_t) {
+        for (auto j = static_cast<int>(j0); j < static_cast<int>(j1); j++) {
+            const int gz0 = j * kPatchQuads, gz1 = std::min(gz0 + kPatchQuads, height_ - 1);
+            for (int i = 0; i < nx0; i++) {
+                const int gx0 = i * kPatchQuads, gx1 = std::min(gx0 + kPatchQuads, width_ - 1);
+                glm::vec2 b(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+                for (int gz = gz0; gz <= gz1; gz++) {
+                    const float* row = heights.data() + static_cast<std::size_t>(gz) * width_;
+                    for (int gx = gx0; gx <= gx1; gx++) {
+                        b.x = std::min(b.x, row[gx]);
+                        b.y = std::max(b.y, row[gx]);
+                    }
+                }
+                bounds_[0][static_cast<std::size_t>(j) * nx0 + i] = b;
+            }
+        }
+    });
+    for (int l = 1; l < levels; l++) {
+        const int nx = nodesX_(l), nz = nodesZ_(l), cnx = nodesX_(l - 1), cnz = nodesZ_(l - 1);
+        bounds_[l].resize(static_cast<std::size_t>(nx) * nz);
+        for (int j = 0; j < nz; j++)
+            for (int i = 0; i < nx; i++) {
+                glm::vec2 b(std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest());
+                for (int cj = 2 * j; cj < std::min(2 * j + 2, cnz); cj++)
+                    for (int ci = 2 * i; ci < std::min(2 * i + 2, cnx); ci++) {
+                        const glm::vec2 c = bounds_[l - 1][static_cast<std::size_t>(cj) * cnx + ci];
+                        b = glm::vec2(std::min(b.x, c.x), std::max(b.y, c.y));
+                    }
+                bounds_[l][static_cast<std::size_t>(j) * nx + i] = b;
+            }
+    }
+}
+
+std::size_t TerrainQuadtree::nodeCount() const {
+    std::size_t n = 0;
+    for (const auto& b: bounds_)
+        n += b.size();
+    return n;
+}
+
+int TerrainQuadtree::nodesX_(int level) const {
+    const int size = kPatchQuads << level;
+    return std::max(1, (width_ - 1 + size - 1) / size);
+}
+
+int TerrainQuadtree::nodesZ_(int level) const {
+    const int size = kPatchQuads << level;
+    return std::max(1, (height_ - 1 + size - 1) / size);
+}
+
+void TerrainQuadtree::nodeBox(const Node& n, glm::vec3& lo, glm::vec3& hi) const {
+    const int size = kPatchQuads << n.level;
+    const glm::vec2 b = bounds_[n.level][static_cast<std::size_t>(n.z) * nodesX_(n.level) + n.x];
+    lo = glm::vec3(n.x * size, b.x, n.z * size);
+    hi = glm::vec3(std::min((n.x + 1) * size, width_ - 1), b.y, std::min((n.z + 1) * size, height_ - 1));
+}
+
+bool TerrainQuadtree::split_(int level, int x, int z, const View& v) const {
+    if (level == 0)
+        return false;
+    const int size = kPatchQuads << level;
+    const float x0 = static_cast<float>(x * size), x1 = static_cast<float>(std::min((x + 1) * size, width_ - 1));
+    const float z0 = static_cast<float>(z * size), z1 = static_cast<float>(std::min((z + 1) * size, height_ - 1));
+    const float dx = std::max({x0 - v.cam.x, 0.0f, v.cam.x - x1});
+    const float dz = std::max({z0 - v.cam.y, 0.0f, v.cam.y - z1});
+    const float range = lodRange_ * static_cast<float>(size);
+    return dx * dx + dz * dz + v.eyeHeight2 < range * range;
+}
+
+int TerrainQuadtree::leafLevelAt_(int gx, int gz, const View& v) const {
+    int level = levels() - 1, x = 0, z = 0;
+    while (split_(level, x, z, v)) {
+        level--;
+        const int size = kPatchQuads << level;
+        x = std::min(gx / size, nodesX_(level) - 1);
+        z = std::min(gz / size, nodesZ_(level) - 1);
+    }
+    return level;
+}
+
+void TerrainQuadtree::select(const glm::vec3& camPos, const rc::math::Frustum* frustum, std::vector<Node>& out,
+                             SelectStats* stats) const {
+    out.clear();
+    SelectStats s;
+    if (!empty()) {
+        // wysokość kamery nad najwyższym punktem węzła poziomu 0 pod nią - ta sama dla wszystkich węzłów
+        const int cx = std::clamp(static_cast<int>(camPos.x) / kPatchQuads, 0, nodesX_(0) - 1);
+        const int cz = std::clamp(static_cast<int>(camPos.z) / kPatchQuads, 0, nodesZ_(0) - 1);
+        const float eye = std::max(0.0f, camPos.y - bounds_[0][static_cast<std::size_t>(cz) * nodesX_(0) + cx].y);
+        const View v{glm::vec2(camPos.x, camPos.z), eye * eye};
+        select_(levels() - 1, 0, 0, v, frustum, out, s);
+    }
+    if (stats)
+        *stats = s;
+}
+
+void TerrainQuadtree::select_(int level, int x, int z, const View& v, const rc::math::Frustum* frustum,
+                              std::vector<Node>& out, SelectStats& stats) const {
+    stats.visited++;
+    Node n{static_cast<std::uint16_t>(x), static_cast<std::uint16_t>(z), static_cast<std::uint8_t>(level), 0};
+    glm::vec3 lo, hi;
+    nodeBox(n, lo, hi);
+    if (frustum && !frustum->intersectsBox(lo, hi)) {
+        stats.culled++;
+        return;
+    }
+    if (split_(level, x, z, v)) {
+        for (int cz = 2 * z; cz < std::min(2 * z + 2, nodesZ_(level - 1)); cz++)
+            for (int cx = 2 * x; cx < std::min(2 * x + 2, nodesX_(level - 1)); cx++)
+                select_(level - 1, cx, cz, v, frustum, out, stats);
+        return;
+    }
+
+    // grubszy sąsiad przykrywa całą krawędź, więc wystarczy zapytać o oczko za jej środkiem
+    const int x0 = static_cast<int>(lo.x), x1 = static_cast<int>(hi.x);
+    const int z0 = static_cast<int>(lo.z), z1 = static_cast<int>(hi.z);
+    const int mx = (x0 + x1) / 2, mz = (z0 + z1) / 2;
+    if (z0 > 0 && leafLevelAt_(mx, z0 - 1, v) > level)
+        n.stitch |= EdgeNegZ;
+    if (x1 < width_ - 1 && leafLevelAt_(x1, mz, v) > level)
+        n.stitch |= EdgePosX;
+    if (z1 < height_ - 1 && leafLevelAt_(mx, z1, v) > level)
+        n.stitch |= EdgePosZ;
+    if (x0 > 0 && leafLevelAt_(x0 - 1, mz, v) > level)
+        n.stitch |= EdgeNegX;
+    out.push_back(n);
+    stats.selected++;
+}
+
+void TerrainQuadtree::buildPatch(const Node& n, std::span<const float> heights, std::span<const std::uint32_t> normals,
+                                 float uvScale, TVertex* out) const {
+    const int step = 1 << n.level;
+    const int gx0 = n.x * (kPatchQuads << n.level), gz0 = n.z * (kPatchQuads << n.level);
+    const auto H = [&](int gx, int gz) { return heights[static_cast<std::size_t>(gz) * width_ + gx]; };
+    std::array<int, kPatchVerts> gxs{};
+    for (int i = 0; i < kPatchVerts; i++)
+        gxs[i] = std::min(gx0 + i * step, width_ - 1);
+
+    for (int j = 0; j < kPatchVerts; j++) {
+        const int gz = std::min(gz0 + j * step, height_ - 1);
+        const int zl = std::max(gz - step, 0), zr = std::min(gz + step, height_ - 1);
+        for (int i = 0; i < kPatchVerts; i++) {
+            const int gx = gxs[i];
+            glm::vec3 nrm;
+            if (n.level == 0 && !normals.empty()) {
+                nrm = rc::gfx::geometry::unpackOctNormal(normals[static_cast<std::size_t>(gz) * width_ + gx]);
+            } else {
+                const int xl = std::max(gx - step, 0), xr = std::min(gx + step, width_ - 1);
+                const float dhdx = (H(xr, gz) - H(xl, gz)) / static_cast<float>(xr - xl);
+                const float dhdz = (H(gx, zr) - H(gx, zl)) / static_cast<float>(zr - zl);
+                nrm = glm::normalize(glm::vec3(-dhdx, 1.0f, -dhdz));
+            }
+            const glm::vec2 g(static_cast<float>(gx), static_cast<float>(gz));
+            out[static_cast<std::size_t>(j) * kPatchVerts + i] = {glm::vec3(g.x, H(gx, gz), g.y), nrm, g * uvScale};
+        }
+    }
+}
+
+TerrainQuadtree::PatchIndices TerrainQuadtree::buildPatchIndices() {
+    constexpr int n = kPatchQuads;
+    PatchIndices out;
+    auto& idx = out.indices;
+    // trójkąt skierowany w górę (+y) jak w Terrain::generate - kolejność wierzchołków wg pola w (x, z)
+    const auto tri = [&](glm::ivec2 a, glm::ivec2 b, glm::ivec2 c) {
+        if ((b.y - a.y) * (c.x - a.x) - (b.x - a.x) * (c.y - a.y) < 0)
+            std::swap(b, c);
+        for (const auto& p: {a, b, c})
+            idx.push_back(static_cast<std::uint16_t>(p.y * kPatchVerts + p.x));
+    };
+
+    for (std::size_t s = 0; s < kStitchVariants; s++) {
+        out.first[s] = static_cast<std::uint32_t>(idx.size());
+
+        // wnętrze w pionowych pasach po 7 kwadów (cache po transformacji, jak Terrain::generate)
+        constexpr int kStripe = 7;
+        for (int sx = 1; sx < n - 1; sx += kStripe)
+            for (int z = 1; z < n - 1; z++)
+                for (int x = sx; x < std::min(sx + kStripe, n - 1); x++) {
+                    tri({x, z}, {x, z + 1}, {x + 1, z});
+                    tri({x, z + 1}, {x + 1, z + 1}, {x + 1, z});
+                }
+
+        // Pierścień brzegowy: każdy bok to trapez między krawędzią (t = 0..n, przy zszyciu co 2) a rzędem
+        // wewnętrznym (t = 1..n-1), zamykany zamkiem błyskawicznym. Narożne przekątne (0,0)-(1,1) itd. są
+        // wspólne dla sąsiednich boków.
+        const std::array<Edge, 4> edges{EdgeNegZ, EdgePosX, EdgePosZ, EdgeNegX};
+        for (const Edge e: edges) {
+            const auto at = [&](int t, int d) -> glm::ivec2 {
+                switch (e) {
+                    case EdgeNegZ: return {t, d};
+                    case EdgePosX: return {n - d, t};
+                    case EdgePosZ: return {t, n - d};
+                    default: return {d, t};
+                }
+            };
+            const int outerStep = (s & e) ? 2 : 1;
+            int o = 0, i = 1; // bieżące t na krawędzi i w rzędzie wewnętrznym
+            while (o < n || i < n - 1) {
+                if (i == n - 1 || (o < n && o + outerStep <= i + 1)) {
+                    tri(at(o, 0), at(o + outerStep, 0), at(i, 1));
+                    o += outerStep;
+                } else {
+                    tri(at(o, 0), at(i, 1), at(i + 1, 1));
+                    i++;
+                }
+            }
+        }
+        out.count[s] = static_cast<std::uint32_t>(idx.size()) - out.first[s];
+    }
+    return out;
+}
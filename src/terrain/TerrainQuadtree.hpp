@@ -0,0 +1,98 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_TERRAINQUADTREE_HPP
+#define ROLLERCOASTERGL_TERRAINQUADTREE_HPP
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <glm/glm.hpp>
+#include <span>
+#include <vector>
+
+#include "math/Frustum.hpp"
+
+struct TVertex;
+
+// Quadtree LOD terenu (bez GL). Każdy węzeł to łata kPatchQuads x kPatchQuads kwadów; poziom l bierze co 2^l-ty
+// wierzchołek mapy, więc łata ma zawsze tyle samo wierzchołków i wszystkie węzły dzielą jeden zestaw indeksów.
+// Węzeł jest dzielony, gdy kamera jest bliżej niż lodRange * bok węzła. Odległość liczona jest w poziomie,
+// z wysokością kamery nad terenem jako stałym składnikiem - dla lodRange >= kMinLodRange sąsiednie liście
+// różnią się wtedy co najwyżej o poziom, a krawędź przy grubszym sąsiedzie zszywa wariant indeksów,
+// który pomija co drugi wierzchołek tej krawędzi (bez T-połączeń i szczelin).
+class TerrainQuadtree {
+public:
+    static constexpr int kPatchQuads = 64;
+    static constexpr int kPatchVerts = kPatchQuads + 1;
+    static constexpr std::size_t kPatchVertexCount = static_cast<std::size_t>(kPatchVerts) * kPatchVerts;
+    static constexpr std::size_t kStitchVariants = 16;
+    // d(B) <= d(rodzic A) + przekątna rodzica A < lodRange * 4 * bok A wymaga lodRange >= sqrt(2)
+    static constexpr float kMinLodRange = 1.5f;
+
+    // bity Node::stitch
+    enum Edge : std::uint8_t { EdgeNegZ = 1, EdgePosX = 2, EdgePosZ = 4, EdgeNegX = 8 };
+
+    struct Node {
+        std::uint16_t x = 0, z = 0; // położenie w węzłach swojego poziomu
+        std::uint8_t level = 0;     // 0 - krok jednego oczka, l - krok 2^l
+        std::uint8_t stitch = 0;    // krawędzie (Edge) przy sąsiedzie o poziom grubszym
+        [[nodiscard]] std::uint32_t key() const {
+            return static_cast<std::uint32_t>(level) << 28 | static_cast<std::uint32_t>(z) << 14 | x;
+        }
+    };
+    struct SelectStats {
+        std::size_t visited = 0;
+        std::size_t selected = 0; // liście w ostrosłupie
+        std::size_t culled = 0;   // poddrzewa odrzucone ostrosłupem
+    };
+    // indeksy 16-bit wspólne dla wszystkich łat; wariant s (maska Edge) to [first[s], first[s] + count[s])
+    struct PatchIndices {
+        std::vector<std::uint16_t> indices;
+        std::array<std::uint32_t, kStitchVariants> first{}, count{};
+    };
+
+    // wymiary siatki wierzchołków i wysokości w świecie (width * height, rzędami) - ramki wysokości węzłów
+    void build(int width, int height, std::span<const float> heights);
+    [[nodiscard]] bool empty() const { return bounds_.empty(); }
+    [[nodiscard]] int levels() const { return static_cast<int>(bounds_.size()); }
+    [[nodiscard]] std::size_t nodeCount() const;
+
+    void setLodRange(float range) { lodRange_ = std::max(range, kMinLodRange); }
+    [[nodiscard]] float lodRange() const { return lodRange_; }
+
+    // liście dla kamery z maskami zszycia; frustum == nullptr - bez odrzucania
+    void select(const glm::vec3& camPos, const rc::math::Frustum* frustum, std::vector<Node>& out,
+                SelectStats* stats = nullptr) const;
+    // ramka węzła: x, z w oczkach mapy, y - wysokości
+    void nodeBox(const Node& n, glm::vec3& lo, glm::vec3& hi) const;
+
+    // kPatchVertexCount wierzchołków łaty (rzędami po kPatchVerts) z tych samych wysokości co build.
+    // Poza mapą współrzędne są przycinane do brzegu (trójkąty zdegenerowane). Normalne: na poziomie 0
+    // z normals (packOctNormal na wierzchołek mapy), jeśli nie jest puste, poza tym z różnic centralnych
+    // z krokiem poziomu. uv = (x, z) * uvScale.
+    void buildPatch(const Node& n, std::span<const float> heights, std::span<const std::uint32_t> normals,
+                    float uvScale, TVertex* out) const;
+    [[nodiscard]] static PatchIndices buildPatchIndices();
+
+private:
+    struct View {
+        glm::vec2 cam;
+        float eyeHeight2;
+    };
+    [[nodiscard]] int nodesX_(int level) const;
+    [[nodiscard]] int nodesZ_(int level) const;
+    [[nodiscard]] bool split_(int level, int x, int z, const View& v) const;
+    // poziom liścia zawierającego oczko (gx, gz)
+    [[nodiscard]] int leafLevelAt_(int gx, int gz, const View& v) const;
+    void select_(int level, int x, int z, const View& v, const rc::math::Frustum* frustum, std::vector<Node>& out,
+                 SelectStats& stats) const;
+
+    int width_ = 0, height_ = 0;
+    float lodRange_ = 2.0f;
+    std::vector<std::vector<glm::vec2>> bounds_; // [poziom][z * nodesX + x] = (min, max) wysokości
+};
+
+#endif // ROLLERCOASTERGL_TERRAINQUADTREE_HPP
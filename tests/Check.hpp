@@ -0,0 +1,39 @@
+//
+// Created by mwed on 18.10.2026.
+//
+
+#ifndef ROLLERCOASTERGL_CHECK_HPP
+#define ROLLERCOASTERGL_CHECK_HPP
+
+#include <cstdio>
+
+// Minimalne asercje testów bez GL: błąd wypisuje miejsce i liczy się do wyniku, test idzie dalej.
+// main() kończy się RC_TEST_RESULT() - kod 1, gdy cokolwiek padło (ctest).
+namespace rc::test {
+    inline int& failures() {
+        static int n = 0;
+        return n;
+    }
+} // namespace rc::test
+
+#define RC_CHECK(cond)                                                                                                 \
+    do {                                                                                                               \
+        if (!(cond)) {                                                                                                 \
+            std::fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond);                              \
+            ++rc::test::failures();                                                                                    \
+        }                                                                                                              \
+    } while (0)
+
+// porównanie z tolerancją, z wartościami w komunikacie
+#define RC_CHECK_LE(value, bound)                                                                                      \
+    do {                                                                                                               \
+        const double rc_v_ = static_cast<double>(value), rc_b_ = static_cast<double>(bound);                           \
+        if (!(rc_v_ <= rc_b_)) {                                                                                       \
+            std::fprintf(stderr, "%s:%d: %s = %.9g > %s = %.9g\n", __FILE__, __LINE__, #value, rc_v_, #bound, rc_b_);  \
+            ++rc::test::failures();                                                                                    \
+        }                                                                                                              \
+    } while (0)
+
+#define RC_TEST_RESULT() (rc::test::failures() ? (std::fprintf(stderr, "%d check(s) failed\n", rc::test::failures()), 1) : 0)
+
+#endif // ROLLERCOASTERGL_CHECK_HPP
@@ -0,0 +1,221 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// HeightPyramid::raycast / segmentHits kontra marsz oczko po oczku po powierzchni dwuliniowej, losowe promienie
+// na mapach o nieparzystych i zdegenerowanych wymiarach (brzegowe węzły przycięte do mapy).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Check.hpp"
+#include "terrain/HeightPyramid.hpp"
+
+namespace {
+    struct Map {
+        int width, height;
+        std::vector<float> h;
+
+        float at(int x, int z) const { return h[static_cast<std::size_t>(z) * width + x]; }
+        // jak Terrain::sampleHeightBilinear w obrębie oczka (cx, cz)
+        float bilinear(int cx, int cz, float x, float z) const {
+            const float u = x - static_cast<float>(cx), v = z - static_cast<float>(cz);
+            const float a = at(cx, cz) + (at(cx + 1, cz) - at(cx, cz)) * u;
+            const float b = at(cx, cz + 1) + (at(cx + 1, cz + 1) - at(cx, cz + 1)) * u;
+            return a + (b - a) * v;
+        }
+    };
+
+    // wzgórza, progi i płaskowyże - węzły piramidy o różnych rozpiętościach, także zerowych
+    Map makeMap(int width, int height, unsigned seed) {
+        Map m{width, height, std::vector<float>(static_cast<std::size_t>(width) * height)};
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+        const float fx = 0.05f + 0.2f * std::abs(u(rng)), fz = 0.05f + 0.2f * std::abs(u(rng));
+        for (int z = 0; z < height; ++z)
+            for (int x = 0; x < width; ++x) {
+                float y = 8.f * std::sin(x * fx) * std::cos(z * fz) + 0.5f * u(rng);
+                if ((x / 7 + z / 5) % 4 == 0)
+                    y = std::floor(y / 3.f) * 3.f; // tarasy
+                m.h[static_cast<std::size_t>(z) * width + x] = y;
+            }
+        return m;
+    }
+
+    // Odniesienie: przejście po wszystkich oczkach na drodze promienia (DDA), w oczku f(t) = y - h jest
+    // kwadratowe w t - dopasowane z trzech próbek, pierwszy pierwiastek z f <= 0.
+    bool marchRaycast(const Map& m, const glm::vec3& o, const glm::vec3& d, float tMax, float& tHit) {
+        const int cellsX = m.width - 1, cellsZ = m.height - 1;
+        float t0 = 0.f, t1 = tMax;
+        auto clip = [&](float p, float v, float lo, float hi) {
+            if (v == 0.f)
+                return p >= lo && p <= hi;
+            float a = (lo - p) / v, b = (hi - p) / v;
+            if (a > b)
+                std::swap(a, b);
+            t0 = std::max(t0, a);
+            t1 = std::min(t1, b);
+            return t0 <= t1;
+        };
+        if (!clip(o.x, d.x, 0.f, float(cellsX)) || !clip(o.z, d.z, 0.f, float(cellsZ)))
+            return false;
+        const glm::vec3 p0 = o + d * t0;
+        int cx = std::clamp(static_cast<int>(std::floor(p0.x)), 0, cellsX - 1);
+        int cz = std::clamp(static_cast<int>(std::floor(p0.z)), 0, cellsZ - 1);
+        constexpr float kInf = std::numeric_limits<float>::infinity();
+        float t = t0;
+        for (;;) {
+            const float tx = d.x > 0.f ? (cx + 1 - o.x) / d.x : d.x < 0.f ? (cx - o.x) / d.x : kInf;
+            const float tz = d.z > 0.f ? (cz + 1 - o.z) / d.z : d.z < 0.f ? (cz - o.z) / d.z : kInf;
+            const float te = std::max(t, std::min({tx, tz, t1}));
+
+            auto f = [&](float s) {
+                const glm::vec3 p = o + d * s;
+                return p.y - m.bilinear(cx, cz, p.x, p.z);
+            };
+            const float fa = f(t);
+            if (fa <= 0.f) {
+                tHit = t;
+                return true;
+            }
+            if (te > t) {
+                // f(s) = fa + B s + A s^2 na s = (t' - t) / (te - t) w [0, 1]
+                const float fm = f(0.5f * (t + te)), fb = f(te);
+                const float A = 2.f * (fa + fb) - 4.f * fm, B = 4.f * fm - 3.f * fa - fb;
+                float s = 2.f;
+                if (std::abs(A) < 1e-6f * (std::abs(B) + std::abs(fa))) {
+                    if (fb <= 0.f)
+                        s = fa / (fa - fb);
+                } else if (const float disc = B * B - 4.f * A * fa; disc >= 0.f) {
+                    // bez odejmowania bliskich liczb przy małym A
+                    const float q = -0.5f * (B + std::copysign(std::sqrt(disc), B));
+                    const float r0 = q / A, r1 = fa / q;
+                    for (const float r: {std::min(r0, r1), std::max(r0, r1)})
+                        if (r >= 0.f && r <= 1.f) {
+                            s = r;
+                            break;
+                        }
+                }
+                if (s <= 1.f) {
+                    tHit = t + s * (te - t);
+                    return true;
+                }
+            }
+            if (te >= t1)
+                return false;
+            t = te;
+            if (tx <= tz)
+                cx += d.x > 0.f ? 1 : -1;
+            else
+                cz += d.z > 0.f ? 1 : -1;
+            if (cx < 0 || cz < 0 || cx >= cellsX || cz >= cellsZ)
+                return false;
+        }
+    }
+
+    // najmniejsze y - h(x, z) na odcinku [ta, tb] promienia (próbki) - do rozpoznania promieni stycznych
+    float minClearance(const Map& m, const glm::vec3& o, const glm::vec3& d, float ta, float tb) {
+        float best = std::numeric_limits<float>::max();
+        for (int i = 0; i <= 4096; ++i) {
+            const glm::vec3 p = o + d * (ta + (tb - ta) * float(i) / 4096.f);
+            if (p.x < 0.f || p.z < 0.f || p.x > float(m.width - 1) || p.z > float(m.height - 1))
+                continue;
+            const int cx = std::min(static_cast<int>(p.x), m.width - 2), cz = std::min(static_cast<int>(p.z), m.height - 2);
+            best = std::min(best, std::abs(p.y - m.bilinear(cx, cz, p.x, p.z)));
+        }
+        return best;
+    }
+
+    void fuzz(int width, int height, int rays, unsigned seed) {
+        const Map m = makeMap(width, height, seed);
+        HeightPyramid pyr;
+        pyr.build(width, height, m.h);
+        RC_CHECK(!pyr.empty());
+
+        std::mt19937 rng(seed * 31 + 1);
+        std::uniform_real_distribution<float> u01(0.f, 1.f);
+        constexpr float kTMax = 400.f;
+        int hits = 0, mismatches = 0, segMismatches = 0, grazing = 0;
+        float worstDt = 0.f;
+        for (int i = 0; i < rays; ++i) {
+            // start także poza mapą i pod powierzchnią, kierunki osiowe i pionowe
+            glm::vec3 o((u01(rng) * 1.4f - 0.2f) * float(width - 1), u01(rng) * 40.f - 12.f,
+                        (u01(rng) * 1.4f - 0.2f) * float(height - 1));
+            glm::vec3 d(u01(rng) * 2.f - 1.f, u01(rng) * 2.f - 1.f, u01(rng) * 2.f - 1.f);
+            switch (i % 6) {
+                case 1: d.x = 0.f; break;
+                case 2: d.z = 0.f; break;
+                case 3: d.x = d.z = 0.f; break;
+                case 4: d.y = -std::abs(d.y) * 0.05f; break; // płasko, długie przeloty nad terenem
+                default: break;
+            }
+            if (d.x == 0.f && d.z == 0.f && d.y == 0.f)
+                d.y = -1.f;
+
+            float tp = 0.f, tr = 0.f;
+            const bool hp = pyr.raycast(m.h, o, d, kTMax, tp);
+            const bool hr = marchRaycast(m, o, d, kTMax, tr);
+            if (hp != hr) {
+                // dopuszczalne tylko dla promienia, który ociera się o powierzchnię
+                if (minClearance(m, o, d, 0.f, kTMax) < 1e-3f * (1.f + glm::length(d) * kTMax * 1e-2f))
+                    grazing++;
+                else
+                    mismatches++;
+            } else if (hp) {
+                hits++;
+                const float dt = std::abs(tp - tr) * glm::length(d);
+                worstDt = std::max(worstDt, dt);
+                RC_CHECK_LE(dt, 1e-3f);
+            }
+
+            // odcinek o długości do 60 jednostek
+            const glm::vec3 b = o + d * (u01(rng) * 60.f);
+            float ts = 0.f;
+            if (pyr.segmentHits(m.h, o, b) != marchRaycast(m, o, b - o, 1.f, ts) &&
+                minClearance(m, o, b - o, 0.f, 1.f) >= 1e-3f)
+                segMismatches++;
+        }
+        std::printf("%dx%d: levels %d, %d rays, %d hits, max |dt| %.2e, %d grazing\n", width, height, pyr.levels(), rays,
+                    hits, worstDt, grazing);
+        RC_CHECK(mismatches == 0);
+        RC_CHECK(segMismatches == 0);
+        RC_CHECK(hits > rays / 10);
+        RC_CHECK_LE(grazing, rays / 1000);
+    }
+
+    void flatMap() {
+        // zerowy zakres wysokości - krok kwantyzacji zastępczy
+        Map m{9, 6, std::vector<float>(9 * 6, 2.5f)};
+        HeightPyramid pyr;
+        pyr.build(m.width, m.height, m.h);
+        float t = 0.f;
+        RC_CHECK(pyr.raycast(m.h, {4.f, 10.f, 3.f}, {0.f, -1.f, 0.f}, 100.f, t));
+        RC_CHECK_LE(std::abs(t - 7.5f), 1e-5f);
+        RC_CHECK(!pyr.raycast(m.h, {4.f, 2.6f, 3.f}, {1.f, 0.f, 0.f}, 100.f, t));
+        RC_CHECK(pyr.segmentHits(m.h, {0.f, 3.f, 0.f}, {8.f, 2.f, 5.f}));
+        RC_CHECK(!pyr.segmentHits(m.h, {0.f, 3.f, 0.f}, {8.f, 2.6f, 5.f}));
+        // poza mapą w (x, z) terenu nie ma
+        RC_CHECK(!pyr.raycast(m.h, {-1.f, 0.f, 3.f}, {0.f, -1.f, 0.f}, 100.f, t));
+
+        // za mała mapa - pusta piramida, bez trafień
+        HeightPyramid none;
+        none.build(1, 5, std::vector<float>(5, 0.f));
+        RC_CHECK(none.empty());
+        RC_CHECK(!none.raycast({}, {0.f, 1.f, 0.f}, {0.f, -1.f, 0.f}, 10.f, t));
+    }
+} // namespace
+
+int main() {
+    flatMap();
+    // 2 x 2 (jedno oczko), 2 x N i N x 2, nieparzyste, nie-potęgi dwójki, większa mapa z wieloma poziomami
+    const int dims[][2] = {{2, 2}, {2, 37}, {41, 2}, {3, 3}, {17, 9}, {33, 65}, {100, 257}, {257, 129}, {513, 300}};
+    unsigned seed = 1;
+    for (const auto& dm: dims)
+        fuzz(dm[0], dm[1], 6000, seed++);
+    return RC_TEST_RESULT();
+}
@@ -0,0 +1,168 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// analyzeVertexCache na przypadkach liczonych ręcznie (FIFO 16) i optimizeVertexFetchRemap - ten sam zbiór
+// trójkątów po przenumerowaniu.
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include "Check.hpp"
+#include "gfx/geometry/MeshOptimizer.hpp"
+
+using namespace rc::gfx::geometry;
+
+namespace {
+    // siatka quadsX x quadsZ quadów, wierzchołek (x, z) = z * (quadsX + 1) + x; quad jako (a, c, b), (b, c, d)
+    void pushQuad(std::vector<std::uint32_t>& idx, std::uint32_t quadsX, std::uint32_t x, std::uint32_t z) {
+        const std::uint32_t a = z * (quadsX + 1) + x, b = a + 1, c = a + quadsX + 1, d = c + 1;
+        idx.insert(idx.end(), {a, c, b, b, c, d});
+    }
+
+    std::vector<std::uint32_t> gridRows(std::uint32_t quadsX, std::uint32_t quadsZ) {
+        std::vector<std::uint32_t> idx;
+        for (std::uint32_t z = 0; z < quadsZ; ++z)
+            for (std::uint32_t x = 0; x < quadsX; ++x)
+                pushQuad(idx, quadsX, x, z);
+        return idx;
+    }
+
+    // pasy po `width` quadów w poprzek, każdy od góry do dołu - jak paski w RailGeometryBuilder i Terrain
+    std::vector<std::uint32_t> gridStripes(std::uint32_t quadsX, std::uint32_t quadsZ, std::uint32_t width) {
+        std::vector<std::uint32_t> idx;
+        for (std::uint32_t x0 = 0; x0 < quadsX; x0 += width)
+            for (std::uint32_t z = 0; z < quadsZ; ++z)
+                for (std::uint32_t x = x0; x < std::min(x0 + width, quadsX); ++x)
+                    pushQuad(idx, quadsX, x, z);
+        return idx;
+    }
+
+    void handChecked() {
+        // jeden trójkąt: 3 transformacje
+        const std::vector<std::uint32_t> one{0, 1, 2};
+        const VertexCacheStats s1 = analyzeVertexCache(one, 3);
+        RC_CHECK(s1.triangles == 1 && s1.vertices == 3 && s1.transformed == 3);
+        RC_CHECK(s1.acmr() == 3.f && s1.atvr() == 1.f);
+
+        // ten sam trójkąt 10 razy: tylko pierwszy kosztuje
+        std::vector<std::uint32_t> rep;
+        for (int k = 0; k < 10; ++k)
+            rep.insert(rep.end(), {4, 5, 6});
+        const VertexCacheStats s2 = analyzeVertexCache(rep, 8);
+        RC_CHECK(s2.triangles == 10 && s2.vertices == 3 && s2.transformed == 3);
+        RC_CHECK(s2.acmr() == 0.3f && s2.atvr() == 1.f);
+
+        // granica FIFO: powrót do trójkąta po cacheSize nowych wierzchołkach - chybienie, po mniej - trafienie
+        const std::vector<std::uint32_t> back{0, 1, 2, 3, 4, 5, 0, 1, 2};
+        RC_CHECK(analyzeVertexCache(back, 6, 3).transformed == 9);
+        RC_CHECK(analyzeVertexCache(back, 6, 6).transformed == 6);
+        RC_CHECK(analyzeVertexCache(back, 6, 5).transformed == 9);
+        // trafienie nie odświeża pozycji w FIFO
+        const std::vector<std::uint32_t> fifo{0, 1, 2, 0, 3, 4, 0, 1, 2};
+        RC_CHECK(analyzeVertexCache(fifo, 5, 4).transformed == 8);
+
+        // pusta siatka
+        const VertexCacheStats s0 = analyzeVertexCache({}, 0);
+        RC_CHECK(s0.triangles == 0 && s0.acmr() == 0.f && s0.atvr() == 0.f);
+
+        // 63 x 64 quadów. Wierszami: wiersz wypycha z FIFO poprzedni, każdy kosztuje 2 * 64 wierzchołki.
+        constexpr std::uint32_t qx = 63, qz = 64;
+        const std::size_t nv = (qx + 1) * (qz + 1);
+        const VertexCacheStats rows = analyzeVertexCache(gridRows(qx, qz), nv);
+        RC_CHECK(rows.triangles == 2 * qx * qz);
+        RC_CHECK(rows.vertices == nv);
+        RC_CHECK(rows.transformed == qz * 2 * (qx + 1));
+
+        // Pasy po 7 quadów: linia paska to 8 wierzchołków, dwie linie mieszczą się w FIFO 16 - każdy wierzchołek
+        // paska raz, brzegi pasów dwa razy.
+        const VertexCacheStats stripes = analyzeVertexCache(gridStripes(qx, qz, 7), nv);
+        RC_CHECK(stripes.triangles == rows.triangles);
+        RC_CHECK(stripes.vertices == nv);
+        RC_CHECK(stripes.transformed == (qx / 7) * 8 * (qz + 1));
+        std::printf("grid %ux%u: rows ACMR %.3f ATVR %.3f, 7-quad stripes ACMR %.3f ATVR %.3f\n", qx, qz, rows.acmr(),
+                    rows.atvr(), stripes.acmr(), stripes.atvr());
+        RC_CHECK(stripes.acmr() < 0.6f && rows.acmr() > 1.f);
+
+        // statystyki się sumują
+        VertexCacheStats sum = rows;
+        sum += stripes;
+        RC_CHECK(sum.triangles == 2 * rows.triangles && sum.transformed == rows.transformed + stripes.transformed);
+    }
+
+    using Tri = std::array<std::uint32_t, 3>;
+
+    std::vector<Tri> triangles(const std::vector<std::uint32_t>& idx) {
+        std::vector<Tri> t(idx.size() / 3);
+        for (std::size_t k = 0; k < t.size(); ++k)
+            t[k] = {idx[3 * k], idx[3 * k + 1], idx[3 * k + 2]};
+        return t;
+    }
+
+    void fetchRemap() {
+        // siatka pasami z przemieszaną numeracją wierzchołków i kilkoma nieużytymi na końcu
+        constexpr std::uint32_t qx = 20, qz = 11, unused = 5;
+        const std::size_t nv = (qx + 1) * (qz + 1) + unused;
+        std::vector<std::uint32_t> shuffle(nv);
+        std::iota(shuffle.begin(), shuffle.end(), 0u);
+        std::shuffle(shuffle.begin(), shuffle.end(), std::mt19937(11));
+        std::vector<std::uint32_t> idx = gridStripes(qx, qz, 7);
+        for (auto& i: idx)
+            i = shuffle[i];
+        const std::vector<std::uint32_t> before = idx;
+
+        std::vector<std::uint32_t> verts(nv); // "wierzchołek" = jego stary numer
+        std::iota(verts.begin(), verts.end(), 0u);
+        const auto remap = optimizeVertexFetchRemap(idx, nv);
+
+        // permutacja
+        std::vector<std::uint32_t> sorted = remap;
+        std::sort(sorted.begin(), sorted.end());
+        std::vector<std::uint32_t> ids(nv);
+        std::iota(ids.begin(), ids.end(), 0u);
+        RC_CHECK(sorted == ids);
+
+        // te same trójkąty w tej samej kolejności i z tym samym nawinięciem
+        const auto tb = triangles(before), ta = triangles(idx);
+        RC_CHECK(ta.size() == tb.size());
+        bool same = true;
+        for (std::size_t k = 0; k < ta.size(); ++k)
+            for (int j = 0; j < 3; ++j)
+                same &= ta[k][j] == remap[tb[k][j]];
+        RC_CHECK(same);
+
+        // numeracja wg pierwszego użycia, nieużyte na końcu
+        std::uint32_t next = 0;
+        bool firstUse = true;
+        for (const auto i: idx) {
+            firstUse &= i <= next;
+            if (i == next)
+                ++next;
+        }
+        RC_CHECK(firstUse);
+        RC_CHECK(next == nv - unused);
+
+        // wersja z wierzchołkami: nowy wierzchołek remap[i] to stary i
+        std::vector<std::uint32_t> idx2 = before;
+        optimizeVertexFetch(verts, std::span<std::uint32_t>(idx2));
+        RC_CHECK(idx2 == idx);
+        bool moved = true;
+        for (std::size_t i = 0; i < nv; ++i)
+            moved &= verts[remap[i]] == i;
+        RC_CHECK(moved);
+
+        // kolejność trójkątów nietknięta - ACMR bez zmian, numeracja wierzchołków nie wpływa na FIFO
+        RC_CHECK(analyzeVertexCache(idx, nv).transformed == analyzeVertexCache(before, nv).transformed);
+    }
+} // namespace
+
+int main() {
+    handChecked();
+    fetchRemap();
+    RC_CHECK(fitsIndex16(0x10000) && !fitsIndex16(0x10001));
+    return RC_TEST_RESULT();
+}
@@ -0,0 +1,176 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// Meshlety na siatce jak teren (pasy po 7 kwadów): limity, pokrycie indeksów, ramki; odrzucanie dla stałych
+// kamer - żaden odrzucony meshlet nie ma trójkąta zwróconego przodem i nie całkiem poza ostrosłupem.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <set>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Check.hpp"
+#include "gfx/geometry/Meshlets.hpp"
+
+using namespace rc::gfx::geometry;
+
+namespace {
+    struct Grid {
+        std::vector<glm::vec3> pos;
+        std::vector<std::uint32_t> idx;
+    };
+
+    // n x n kwadów, wysokość amp * wzgórza; trójkąty (a, c, b), (b, c, d) z normalną +y
+    Grid makeGrid(int n, float amp) {
+        Grid g;
+        for (int z = 0; z <= n; ++z)
+            for (int x = 0; x <= n; ++x)
+                g.pos.emplace_back(float(x), amp * (std::sin(x * 0.09f) * std::cos(z * 0.07f) + 0.3f * std::sin(x * 0.31f + z * 0.23f)),
+                                   float(z));
+        constexpr int kStripe = 7;
+        for (int x0 = 0; x0 < n; x0 += kStripe)
+            for (int z = 0; z < n; ++z)
+                for (int x = x0; x < std::min(x0 + kStripe, n); ++x) {
+                    const auto a = std::uint32_t(z * (n + 1) + x), b = a + 1, c = a + std::uint32_t(n + 1), d = c + 1;
+                    g.idx.insert(g.idx.end(), {a, c, b, b, c, d});
+                }
+        return g;
+    }
+
+    // meshlety kolejno pokrywają [first, first + idx.size()) - każdy indeks raz; limity i sfery
+    void checkPartition(const Grid& g, std::uint32_t first, const std::vector<Meshlet>& ms) {
+        RC_CHECK(!ms.empty());
+        std::uint32_t next = first;
+        int overV = 0, overT = 0, outside = 0;
+        for (const Meshlet& m: ms) {
+            RC_CHECK(m.firstIndex == next && m.indexCount > 0 && m.indexCount % 3 == 0);
+            next = m.firstIndex + m.indexCount;
+            std::set<std::uint32_t> verts;
+            for (std::uint32_t k = m.firstIndex - first; k < m.firstIndex - first + m.indexCount; ++k)
+                verts.insert(g.idx[k]);
+            overV += verts.size() > kMeshletMaxVertices;
+            overT += m.indexCount / 3 > kMeshletMaxTriangles;
+            for (const auto v: verts)
+                outside += glm::length(g.pos[v] - m.center) > m.radius * (1.f + 1e-6f) + 1e-6f;
+        }
+        RC_CHECK(next == first + g.idx.size());
+        RC_CHECK(overV == 0 && overT == 0 && outside == 0);
+    }
+
+    struct Camera {
+        glm::vec3 eye, target;
+        std::size_t frustumCulled, backfaceCulled; // oczekiwane
+    };
+
+    // Odrzucony meshlet nie może mieć trójkąta zwróconego do kamery, który nie leży całkiem za jedną z płaszczyzn.
+    // Zwraca liczbę takich trójkątów.
+    int wronglyCulled(const Grid& g, std::uint32_t first, const Meshlet& m, const rc::math::Frustum& fr,
+                      const glm::vec3& cam) {
+        int bad = 0;
+        for (std::uint32_t k = m.firstIndex - first; k < m.firstIndex - first + m.indexCount; k += 3) {
+            const glm::vec3 a = g.pos[g.idx[k]], b = g.pos[g.idx[k + 1]], c = g.pos[g.idx[k + 2]];
+            const glm::vec3 n = glm::cross(b - a, c - a);
+            if (glm::dot(n, cam - a) <= 1e-6f * glm::length(n))
+                continue; // tyłem albo krawędzią
+            bool maybeIn = true;
+            for (const auto& p: fr.planes) {
+                const glm::vec3 pn(p);
+                maybeIn &= glm::dot(pn, a) + p.w >= 0.f || glm::dot(pn, b) + p.w >= 0.f || glm::dot(pn, c) + p.w >= 0.f;
+            }
+            bad += maybeIn;
+        }
+        return bad;
+    }
+
+    void culling(const Grid& g, std::uint32_t first, const std::vector<Meshlet>& ms, const Camera& c) {
+        const glm::mat4 proj = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.1f, 1000.f);
+        const auto fr = rc::math::Frustum::fromMatrix(proj * glm::lookAt(c.eye, c.target, glm::vec3(0, 1, 0)));
+        std::vector<IndexRange> ranges{{7, 3}}; // wcześniejsza zawartość zostaje
+        MeshletCullStats st;
+        cullMeshlets(ms, fr, c.eye, ranges, st);
+        RC_CHECK(ranges.front().first == 7 && ranges.front().count == 3);
+        RC_CHECK(st.meshlets == ms.size() && st.ranges == ranges.size() - 1);
+
+        // zakresy = scalone widoczne meshlety; rosnące, rozłączne, niestykające się
+        std::vector<std::uint8_t> drawn(ms.size(), 0);
+        std::size_t drawnCount = 0;
+        for (std::size_t r = 1; r < ranges.size(); ++r) {
+            if (r > 1)
+                RC_CHECK(ranges[r].first > ranges[r - 1].first + ranges[r - 1].count);
+            for (std::size_t k = 0; k < ms.size(); ++k)
+                if (ms[k].firstIndex >= ranges[r].first &&
+                    ms[k].firstIndex + ms[k].indexCount <= ranges[r].first + ranges[r].count) {
+                    drawn[k] = 1;
+                    ++drawnCount;
+                }
+        }
+        std::uint32_t drawnIndices = 0;
+        for (std::size_t r = 1; r < ranges.size(); ++r)
+            drawnIndices += ranges[r].count;
+        std::uint32_t visibleIndices = 0;
+        for (std::size_t k = 0; k < ms.size(); ++k)
+            visibleIndices += drawn[k] ? ms[k].indexCount : 0;
+        RC_CHECK(drawnCount == st.visible() && drawnIndices == visibleIndices);
+
+        int bad = 0;
+        for (std::size_t k = 0; k < ms.size(); ++k)
+            if (!drawn[k])
+                bad += wronglyCulled(g, first, ms[k], fr, c.eye);
+        RC_CHECK(bad == 0);
+
+        std::printf("camera (%.0f, %.0f, %.0f): %zu meshlets, %zu frustum, %zu backface, %zu ranges, %.0f%% indices drawn\n",
+                    c.eye.x, c.eye.y, c.eye.z, st.meshlets, st.frustumCulled, st.backfaceCulled, st.ranges,
+                    100.0 * drawnIndices / double(g.idx.size()));
+        RC_CHECK(st.frustumCulled == c.frustumCulled);
+        RC_CHECK(st.backfaceCulled == c.backfaceCulled);
+    }
+} // namespace
+
+int main() {
+    constexpr std::uint32_t kFirst = 300; // meshlety fragmentu większego bufora
+    {
+        // płaska siatka: stożki zerowe; z góry wszystko widać jednym zakresem, spod spodu wszystko tyłem
+        const Grid flat = makeGrid(64, 0.f);
+        std::vector<Meshlet> ms;
+        buildMeshlets(flat.pos, flat.idx, kFirst, ms);
+        checkPartition(flat, kFirst, ms);
+        for (const auto& m: ms)
+            RC_CHECK(m.coneAxis == glm::vec3(0, 1, 0) && m.coneCutoff == 0.f);
+        culling(flat, kFirst, ms, {{32.f, 200.f, 32.1f}, {32.f, 0.f, 32.f}, 0, 0});
+        culling(flat, kFirst, ms, {{32.f, -200.f, 32.1f}, {32.f, 0.f, 32.f}, 0, ms.size()});
+    }
+
+    const Grid g = makeGrid(256, 15.f);
+    std::vector<Meshlet> ms{Meshlet{}}; // dopisywane za istniejącymi
+    buildMeshlets(g.pos, g.idx, kFirst, ms);
+    ms.erase(ms.begin());
+    checkPartition(g, kFirst, ms);
+    std::printf("%zu meshlets for %zu triangles\n", ms.size(), g.idx.size() / 3);
+
+    // mniejsze limity też trzymane
+    std::vector<Meshlet> small;
+    buildMeshlets(g.pos, g.idx, kFirst, small, 16, 20);
+    int over = 0;
+    for (const auto& m: small) {
+        std::set<std::uint32_t> v(g.idx.begin() + (m.firstIndex - kFirst), g.idx.begin() + (m.firstIndex - kFirst + m.indexCount));
+        over += v.size() > 16 || m.indexCount > 60;
+    }
+    RC_CHECK(over == 0 && small.size() > ms.size());
+
+    // Przy ziemi wzdłuż mapy, nisko w głąb, z góry na róg, ukośnie z brzegu, tyłem do mapy, spod terenu.
+    // Stożki na zboczach są szerokie (7 x 9 kwadów), więc tyłem odpada mało - pełne odrzucanie sprawdza płaska siatka.
+    const Camera cams[] = {{{5.f, 20.f, 128.f}, {250.f, 0.f, 128.f}, 299, 5},
+                           {{128.f, 16.f, -20.f}, {128.f, 0.f, 100.f}, 178, 2},
+                           {{64.f, 60.f, 64.5f}, {64.f, 0.f, 64.f}, 1088, 0},
+                           {{200.f, 25.f, 40.f}, {140.f, 0.f, 180.f}, 381, 0},
+                           {{300.f, 30.f, 300.f}, {500.f, 0.f, 500.f}, 1342, 0},
+                           {{128.f, -60.f, 100.f}, {128.f, 0.f, 150.f}, 659, 9}};
+    for (const auto& c: cams)
+        culling(g, kFirst, ms, c);
+    return RC_TEST_RESULT();
+}
@@ -0,0 +1,161 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// Błędy kwantyzacji PackedVertex: half, normalne oktaedryczne, pozycje w ramce, UV.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
+#include <random>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Check.hpp"
+#include "gfx/geometry/PackedVertex.hpp"
+
+using namespace rc::gfx::geometry;
+
+namespace {
+    void halfEdgeCases() {
+        RC_CHECK(floatToHalf(0.f) == 0x0000);
+        RC_CHECK(floatToHalf(-0.f) == 0x8000);
+        RC_CHECK(floatToHalf(1.f) == 0x3C00);
+        RC_CHECK(floatToHalf(-2.f) == 0xC000);
+
+        // największa skończona i granica zaokrąglenia do inf
+        RC_CHECK(floatToHalf(65504.f) == 0x7BFF);
+        RC_CHECK(halfToFloat(0x7BFF) == 65504.f);
+        RC_CHECK(floatToHalf(65519.f) == 0x7BFF);
+        RC_CHECK(floatToHalf(65520.f) == 0x7C00);
+        RC_CHECK(floatToHalf(-1e6f) == 0xFC00);
+
+        RC_CHECK(floatToHalf(std::numeric_limits<float>::infinity()) == 0x7C00);
+        RC_CHECK(floatToHalf(-std::numeric_limits<float>::infinity()) == 0xFC00);
+        RC_CHECK(std::isinf(halfToFloat(0x7C00)) && halfToFloat(0x7C00) > 0.f);
+        RC_CHECK(std::isinf(halfToFloat(0xFC00)) && halfToFloat(0xFC00) < 0.f);
+        const std::uint16_t nan = floatToHalf(std::numeric_limits<float>::quiet_NaN());
+        RC_CHECK((nan & 0x7C00) == 0x7C00 && (nan & 0x03FF) != 0);
+        RC_CHECK(std::isnan(halfToFloat(nan)));
+
+        // subnormalne: 2^-24 najmniejsza, 2^-14 najmniejsza normalna, remisy do parzystej
+        RC_CHECK(floatToHalf(std::ldexp(1.f, -24)) == 0x0001);
+        RC_CHECK(floatToHalf(std::ldexp(1.f, -25)) == 0x0000);
+        RC_CHECK(floatToHalf(std::ldexp(3.f, -25)) == 0x0002);
+        RC_CHECK(floatToHalf(std::ldexp(1023.f, -24)) == 0x03FF);
+        RC_CHECK(floatToHalf(std::ldexp(1.f, -14)) == 0x0400);
+        RC_CHECK(floatToHalf(-std::ldexp(5.f, -24)) == 0x8005);
+        RC_CHECK(halfToFloat(0x0001) == std::ldexp(1.f, -24));
+        RC_CHECK(halfToFloat(0x83FF) == -std::ldexp(1023.f, -24));
+
+        // normalne: remis do parzystej mantysy
+        RC_CHECK(floatToHalf(1.f + std::ldexp(1.f, -11)) == 0x3C00);
+        RC_CHECK(floatToHalf(1.f + std::ldexp(3.f, -11)) == 0x3C02);
+
+        // każda skończona wartość half przechodzi w obie strony bez zmian
+        int mismatches = 0;
+        for (std::uint32_t h = 0; h <= 0xFFFF; ++h) {
+            if ((h & 0x7C00) == 0x7C00 && (h & 0x03FF))
+                continue; // NaN
+            if (floatToHalf(halfToFloat(static_cast<std::uint16_t>(h))) != h)
+                ++mismatches;
+        }
+        RC_CHECK(mismatches == 0);
+    }
+
+    float angleDeg(const glm::vec3& a, const glm::vec3& b) {
+        return glm::degrees(std::acos(std::clamp(glm::dot(glm::normalize(a), glm::normalize(b)), -1.f, 1.f)));
+    }
+
+    void octNormals() {
+        // snorm 10:10 z wyborem najbliższego z czterech zaokrągleń
+        constexpr float kMaxDeg = 0.2f;
+        float worst = 0.f;
+        auto check = [&](const glm::vec3& n) { worst = std::max(worst, angleDeg(n, unpackOctNormal(packOctNormal(n)))); };
+
+        for (const glm::vec3 n: {glm::vec3(1, 0, 0), glm::vec3(-1, 0, 0), glm::vec3(0, 1, 0), glm::vec3(0, -1, 0),
+                                 glm::vec3(0, 0, 1), glm::vec3(0, 0, -1), glm::vec3(1, 1, 1), glm::vec3(-1, -1, -1),
+                                 glm::vec3(1, 1, -1e-6f), glm::vec3(-1, 1, -1e-6f), glm::vec3(1e-6f, 0, -1)})
+            check(glm::normalize(n));
+        // osie dokładnie
+        RC_CHECK_LE(angleDeg(glm::vec3(0, 0, 1), unpackOctNormal(packOctNormal({0, 0, 1}))), 1e-3f);
+        RC_CHECK_LE(angleDeg(glm::vec3(0, 0, -1), unpackOctNormal(packOctNormal({0, 0, -1}))), 1e-3f);
+
+        std::mt19937 rng(37);
+        std::normal_distribution<float> g;
+        for (int i = 0; i < 200000; ++i) {
+            const glm::vec3 n(g(rng), g(rng), g(rng));
+            if (glm::dot(n, n) > 1e-12f)
+                check(glm::normalize(n));
+        }
+        std::printf("octahedral normal max error %.4f deg\n", worst);
+        RC_CHECK_LE(worst, kMaxDeg);
+    }
+
+    void positionsAndUvs() {
+        std::mt19937 rng(7);
+        std::uniform_real_distribution<float> u01(0.f, 1.f);
+        float worstUv = 0.f;
+        for (int box = 0; box < 200; ++box) {
+            // ramki od centymetrów do kilometra, przesunięte od początku świata
+            const glm::vec3 lo = (glm::vec3(u01(rng), u01(rng), u01(rng)) - glm::vec3(0.5f)) * 2000.f;
+            const glm::vec3 size = glm::vec3(u01(rng), u01(rng), u01(rng)) * std::pow(10.f, u01(rng) * 5.f - 2.f);
+            const glm::vec2 uvLo = (glm::vec2(u01(rng), u01(rng)) - glm::vec2(0.5f)) * 20.f;
+            constexpr float kUvSpan = 8.f;
+
+            std::vector<Vertex> verts(500);
+            for (std::size_t i = 0; i < verts.size(); ++i) {
+                const glm::vec3 t = i < 2 ? glm::vec3(float(i)) : glm::vec3(u01(rng), u01(rng), u01(rng));
+                verts[i] = {lo + t * size, glm::vec3(0, 1, 0), uvLo + glm::vec2(u01(rng), u01(rng)) * kUvSpan};
+            }
+            const QuantBox qb = fitQuantBox(verts);
+            // pół kroku unorm16 na oś plus zaokrąglenie float przy |lo| do 1000
+            const glm::vec3 posBound = qb.extent / (2.f * 65535.f) + glm::vec3(std::ldexp(1000.f, -22));
+
+            for (const auto& v: verts) {
+                const PackedVertex p = packVertex(v.pos, v.normal, v.uv, qb);
+                const Vertex back = unpackVertex(p, qb);
+                for (int k = 0; k < 3; ++k) {
+                    const float e = std::abs(back.pos[k] - v.pos[k]);
+                    RC_CHECK_LE(e, posBound[k]);
+                }
+                for (int k = 0; k < 2; ++k) {
+                    // half względem całkowitego uvOrigin: 2^-11 względnie, UV < uvOrigin + kUvSpan + 1
+                    const float rel = std::abs(v.uv[k] - qb.uvOrigin[k]);
+                    const float e = std::abs(back.uv[k] - v.uv[k]);
+                    RC_CHECK_LE(e, rel * std::ldexp(1.f, -11) + std::ldexp(1.f, -20));
+                    worstUv = std::max(worstUv, e);
+                }
+            }
+        }
+        std::printf("uv max error %.4f\n", worstUv);
+
+        // chunk toru 50 m: pół kroku unorm16 na oś, czyli do 0.66 mm w 3D
+        const QuantBox chunk = fitQuantBox({100.f, 0.f, -300.f}, {150.f, 50.f, -250.f}, {0.f, 0.f});
+        float worstMm = 0.f;
+        for (int i = 0; i < 100000; ++i) {
+            const glm::vec3 pos = chunk.origin + glm::vec3(u01(rng), u01(rng), u01(rng)) * chunk.extent;
+            const Vertex back = unpackVertex(packVertex(pos, {0, 1, 0}, {0, 0}, chunk), chunk);
+            worstMm = std::max(worstMm, glm::length(back.pos - pos) * 1000.f);
+        }
+        std::printf("50 m chunk position max error %.3f mm\n", worstMm);
+        RC_CHECK_LE(worstMm, std::sqrt(3.f) * 50.f / (2.f * 65535.f) * 1000.f * 1.001f);
+
+        // ramka pojedynczego wierzchołka (extent = 0) nie dzieli przez zero
+        const Vertex one{{3.f, -2.f, 7.f}, {0, 0, 1}, {0.25f, 0.5f}};
+        const QuantBox flat = fitQuantBox(std::span<const Vertex>(&one, 1));
+        const Vertex back = unpackVertex(packVertex(one.pos, one.normal, one.uv, flat), flat);
+        RC_CHECK_LE(glm::length(back.pos - one.pos), 1e-5f);
+        RC_CHECK(back.uv == one.uv);
+    }
+} // namespace
+
+int main() {
+    halfEdgeCases();
+    octNormals();
+    positionsAndUvs();
+    return RC_TEST_RESULT();
+}
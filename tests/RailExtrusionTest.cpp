@@ -0,0 +1,145 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// extrudeRailVertex po buildRailStream kontra RailGeometryBuilder::build na torze demo (otwartym i zamkniętym):
+// te same trójkąty z tym samym nawinięciem, pozycje do 1.7e-5 m. Wyjątek - zamykający ring pętli: builder przesuwa
+// środek o własne B ramki, a okrąg kładzie na N/B pierwszej; strumień bierze całą orientację z pierwszej (~0.2 mm,
+// widać tylko przy ringu na każdą ramkę - z domyślną tolerancją ramka przed duplikatem zwykle wypada).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+#include "Check.hpp"
+#include "gameplay/TrackComponent.hpp"
+#include "gfx/geometry/RailExtrusion.hpp"
+
+using namespace rc::gfx::geometry;
+
+namespace {
+    // węzły jak w buildDemoTrack (main.cpp)
+    void demoTrack(rc::gameplay::TrackComponent& track, bool closed) {
+        constexpr float nodes[][3] = {
+                {110, 22, 29},  {62, 18, 20},  {56, 18, 21},   {38, 18, 31},  {43, 18, 45},  {45, 20, 50},
+                {88, 12, 55},   {108, 14, 50}, {132, 16, 47},  {157, 22, 47}, {176, 38, 49}, {196, 58, 53},
+                {209, 65, 67},  {224, 70, 90}, {224, 70, 93},  {224, 63, 103}, {220, 51, 112}, {215, 29, 120},
+                {206, 35, 121}, {196, 39, 101}, {199, 35, 95}, {202, 29, 92},  {232, 11, 87}, {239, 15, 82},
+                {236, 21, 62},  {218, 24, 41}, {182, 85, 37},  {164, 85, 35}, {157, 72, 34}, {147, 29, 33},
+                {137, 34, 32}};
+        for (const auto& n: nodes)
+            track.spline().addNode({{n[0], n[1], n[2]}});
+        track.setClosed(closed);
+        track.setDs(0.05f);
+        track.setUp({0.f, 1.f, 0.f});
+        track.markDirty();
+        track.rebuild();
+    }
+
+    float dist(const glm::vec3& a, const glm::vec3& b) {
+        return glm::length(a - b);
+    }
+
+    // Zwraca największą odchyłkę pozycji na zamykającym ringu (0, gdy go nie ma).
+    float compare(const std::vector<rc::common::Frame>& frames, bool closed, float lodTolerance) {
+        RailParams p;
+        p.closedLoop = closed;
+        p.lodTolerance = lodTolerance;
+        MeshOut mesh;
+        RC_CHECK(RailGeometryBuilder(frames, mesh).build(p));
+        std::vector<RailStreamFrame> stream;
+        RC_CHECK(buildRailStream(frames, p, stream));
+        const glm::vec4 header = railStreamHeader(p);
+
+        // ringi: te same ramki, przy pętli plus kopia pierwszej na końcu
+        std::vector<uint32_t> keep = RailGeometryBuilder::selectRings(frames, p, p.lodTolerance);
+        if (closed)
+            keep.pop_back();
+        const uint32_t ring = p.ringSides + 1u;
+        const auto rings = static_cast<uint32_t>(keep.size());
+        RC_CHECK(mesh.vertices.size() == std::size_t{rings} * ring * 2u);
+        RC_CHECK(stream.size() == rings + (closed ? 1u : 0u));
+
+        // liczba trójkątów: dwie instancje po railStreamVertexCount wierzchołków
+        const std::uint32_t perRail = railStreamVertexCount(stream.size(), p.ringSides);
+        RC_CHECK(2u * perRail == mesh.indices.size());
+
+        // Trójkąt buildera (a, b, c) / (b, c, d) na quadzie r segmentu i szyny rail -> wierzchołki
+        // seg * 6 * sides + r * 6 + {0..2 | 3..5} instancji rail. Każdy dokładnie raz, narożniki w tej samej
+        // kolejności.
+        const auto closingRing = static_cast<uint32_t>(frames.size()) - 2u;
+        std::vector<std::uint8_t> hit(2u * perRail / 3u, 0);
+        float maxErr = 0.f, maxClosing = 0.f, maxNormal = 0.f, maxUv = 0.f;
+        bool mapped = true;
+        for (std::size_t t = 0; t < mesh.indices.size(); t += 3) {
+            const uint32_t i0 = mesh.indices[t], i1 = mesh.indices[t + 1];
+            const uint32_t seg = i0 / (2u * ring);
+            const uint32_t rail = (i0 % (2u * ring)) / ring;
+            const uint32_t r = i0 % ring;
+            const bool second = i1 / (2u * ring) != seg; // (b, c, d): b i c na różnych ringach
+            const uint32_t quad = second ? r - 1u : r;
+            const uint32_t base = seg * p.ringSides * 6u + quad * 6u + (second ? 3u : 0u);
+            if (quad >= p.ringSides || base >= perRail) {
+                mapped = false;
+                continue;
+            }
+            ++hit[(rail * perRail + base) / 3u];
+            for (uint32_t k = 0; k < 3; ++k) {
+                const Vertex& ref = mesh.vertices[mesh.indices[t + k]];
+                const Vertex v = extrudeRailVertex(stream, header, base + k, rail);
+                const float e = dist(v.pos, ref.pos);
+                const uint32_t vRing = mesh.indices[t + k] / (2u * ring);
+                if (closed && keep[vRing] == closingRing)
+                    maxClosing = std::max(maxClosing, e);
+                else
+                    maxErr = std::max(maxErr, e);
+                maxNormal = std::max(maxNormal, dist(v.normal, ref.normal));
+                maxUv = std::max(maxUv, std::max(std::abs(v.uv.x - ref.uv.x), std::abs(v.uv.y - ref.uv.y)));
+            }
+        }
+        RC_CHECK(mapped);
+        RC_CHECK(std::all_of(hit.begin(), hit.end(), [](std::uint8_t h) { return h == 1; }));
+
+        std::printf("%s, tol %g: %zu frames, %u rings, %zu tris, max |dP| %.2e m (closing ring %.2e m), |dN| %.2e, "
+                    "|dUV| %.2e\n",
+                    closed ? "closed" : "open", lodTolerance, frames.size(), rings, mesh.indices.size() / 3, maxErr,
+                    maxClosing, maxNormal, maxUv);
+        RC_CHECK_LE(maxErr, 1.7e-5f);
+        RC_CHECK_LE(maxNormal, 1e-5f);
+        RC_CHECK_LE(maxUv, 1e-3f); // v = s * texScaleV do kilkuset, float
+        if (!closed)
+            RC_CHECK(maxClosing == 0.f);
+        return maxClosing;
+    }
+
+    void openTrack() {
+        rc::gameplay::TrackComponent track;
+        demoTrack(track, false);
+        compare(track.frames(), false, RailParams{}.lodTolerance);
+        compare(track.frames(), false, 0.f);
+    }
+
+    void closedTrack() {
+        rc::gameplay::TrackComponent track;
+        demoTrack(track, true);
+        const auto& frames = track.frames();
+        compare(frames, true, RailParams{}.lodTolerance);
+
+        // Bez pomijania ringów zamykający ring (ramka przed duplikatem) jest zawsze; różnica to dokładnie
+        // przesunięcie środka gauge/2 * |B - B0|.
+        const float closing = compare(frames, true, 0.f);
+        const RailParams p;
+        const auto& last = frames[frames.size() - 2];
+        const float expected = 0.5f * p.gauge * dist(last.B, frames.front().B);
+        std::printf("closing ring: %.3f mm (gauge/2 |B - B0| = %.3f mm)\n", closing * 1e3f, expected * 1e3f);
+        RC_CHECK(closing > 0.1e-3f && closing < 0.3e-3f);
+        RC_CHECK_LE(std::abs(closing - expected), 2e-5f);
+    }
+} // namespace
+
+int main() {
+    openTrack();
+    closedTrack();
+    return RC_TEST_RESULT();
+}
@@ -0,0 +1,115 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// Ścieżki wsadowe SimplexNoise (Scalar, SSE4.1, AVX2 - forceSimdLevel) kontra pojedyncze noise() / fbm():
+// te same bity wartości i gradientu, także na resztach wierszy krótszych niż szerokość wektora.
+
+#include <bit>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "Check.hpp"
+#include "terrain/SimplexNoise.hpp"
+
+namespace {
+    using Level = SimplexNoise::SimdLevel;
+
+    bool same(float a, float b) { return std::bit_cast<std::uint32_t>(a) == std::bit_cast<std::uint32_t>(b); }
+
+    // współrzędne jak w Terrain::generate (x * scale + 137) i dalekie, ujemne
+    std::vector<float> coords(std::mt19937& rng, std::size_t n) {
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+        std::vector<float> v(n);
+        const float base = u(rng) > 0.f ? 137.f : u(rng) * 3000.f;
+        for (std::size_t k = 0; k < n; ++k)
+            v[k] = base + static_cast<float>(k) * 0.013f + u(rng) * 0.01f;
+        return v;
+    }
+
+    void checkLevel(const SimplexNoise& noise, Level level) {
+        std::mt19937 rng(static_cast<unsigned>(level) + 5);
+        std::uniform_real_distribution<float> u(-1.f, 1.f);
+        int noise8Diff = 0, batchDiff = 0, rowDiff = 0, rowGradDiff = 0, fbmDiff = 0, fbmGradDiff = 0, partialDiff = 0;
+        std::size_t samples = 0;
+
+        for (int it = 0; it < 300; ++it) {
+            // noise8 i noise(span) dla dowolnych par (x, y)
+            float x8[8], y8[8], o8[8];
+            for (int k = 0; k < 8; ++k) {
+                x8[k] = u(rng) * 500.f;
+                y8[k] = u(rng) * 500.f;
+            }
+            noise.noise8(x8, y8, o8);
+            for (int k = 0; k < 8; ++k)
+                noise8Diff += !same(o8[k], noise.noise(x8[k], y8[k]));
+
+            // długości z resztą: 1..7, 8k + r
+            const std::size_t n = 1 + static_cast<std::size_t>(it % 37) + (it % 3 == 0 ? 64 : 0);
+            const std::vector<float> xs = coords(rng, n), ys = coords(rng, n);
+            const float y = ys[0];
+            std::vector<float> out(n), dx(n), dy(n);
+            noise.noise(xs, ys, out);
+            for (std::size_t k = 0; k < n; ++k)
+                batchDiff += !same(out[k], noise.noise(xs[k], ys[k]));
+
+            noise.noiseRow(xs, y, out);
+            for (std::size_t k = 0; k < n; ++k)
+                rowDiff += !same(out[k], noise.noise(xs[k], y));
+            noise.noiseRow(xs, y, out, dx, dy);
+            for (std::size_t k = 0; k < n; ++k) {
+                glm::vec2 g;
+                const float v = noise.noise(xs[k], y, g);
+                rowGradDiff += !same(out[k], v) || !same(dx[k], g.x) || !same(dy[k], g.y);
+            }
+
+            // fbm z parametrami aplikacji i losowymi
+            const int octaves = 1 + it % 10;
+            const float freq = it % 2 ? 0.02f : 0.5f + 0.4f * u(rng);
+            const float lac = it % 2 ? 2.166f : 2.f + 0.3f * u(rng);
+            const float pers = it % 2 ? 1.483f : 0.5f + 0.2f * u(rng);
+            noise.fbmRow(xs, y, out, freq, octaves, lac, pers);
+            for (std::size_t k = 0; k < n; ++k)
+                fbmDiff += !same(out[k], noise.fbm(xs[k], y, freq, octaves, lac, pers));
+            noise.fbmRow(xs, y, out, dx, dy, freq, octaves, lac, pers);
+            for (std::size_t k = 0; k < n; ++k) {
+                glm::vec2 g;
+                const float v = noise.fbm(xs[k], y, g, freq, octaves, lac, pers);
+                fbmGradDiff += !same(out[k], v) || !same(dx[k], g.x) || !same(dy[k], g.y);
+            }
+            // gradient z części oktaw nie zmienia wartości
+            noise.fbmRow(xs, y, out, dx, dy, freq, octaves, lac, pers, octaves / 2);
+            for (std::size_t k = 0; k < n; ++k)
+                partialDiff += !same(out[k], noise.fbm(xs[k], y, freq, octaves, lac, pers));
+            samples += n;
+        }
+        std::printf("%s: %zu samples, mismatches noise8 %d, noise %d, noiseRow %d/%d (grad), fbmRow %d/%d (grad), "
+                    "partial grad %d\n",
+                    SimplexNoise::simdLevelName(level), samples, noise8Diff, batchDiff, rowDiff, rowGradDiff, fbmDiff,
+                    fbmGradDiff, partialDiff);
+        RC_CHECK(noise8Diff == 0);
+        RC_CHECK(batchDiff == 0);
+        RC_CHECK(rowDiff == 0 && rowGradDiff == 0);
+        RC_CHECK(fbmDiff == 0 && fbmGradDiff == 0);
+        RC_CHECK(partialDiff == 0);
+    }
+} // namespace
+
+int main() {
+    const SimplexNoise noise(4245221);
+    const Level detected = SimplexNoise::simdLevel();
+    for (const Level level: {Level::Scalar, Level::SSE41, Level::AVX2}) {
+        SimplexNoise::forceSimdLevel(level);
+        if (SimplexNoise::simdLevel() != level) {
+            std::printf("%s: not supported by this CPU, skipped\n", SimplexNoise::simdLevelName(level));
+            continue;
+        }
+        checkLevel(noise, level);
+    }
+    SimplexNoise::forceSimdLevel(detected);
+    RC_CHECK(SimplexNoise::simdLevel() == detected);
+    return RC_TEST_RESULT();
+}
@@ -0,0 +1,166 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// Instancje poprzeczek, słupów i stopek nałożone na szablony (SupportInstanceBuilder::apply) kontra ta sama bryła
+// wypalona przez SupportGeometryBuilder dla tych samych danych: te same indeksy i uv, pozycje i normalne do
+// błędu float.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "Check.hpp"
+#include "gfx/geometry/SupportGeometryBuilder.hpp"
+#include "gfx/geometry/SupportInstances.hpp"
+
+using namespace rc::gfx::geometry;
+
+namespace {
+    struct Err {
+        float pos = 0.f, normal = 0.f;
+        int meshes = 0;
+    };
+
+    // wszystkie instancje na jednym szablonie, jak glDrawElementsInstanced
+    MeshOut expand(const MeshOut& tmpl, const std::vector<InstanceXform>& xs) {
+        MeshOut m;
+        for (const auto& x: xs) {
+            const auto base = static_cast<uint32_t>(m.vertices.size());
+            for (const auto& v: tmpl.vertices)
+                m.vertices.push_back(SupportInstanceBuilder::apply(x, v));
+            for (const auto i: tmpl.indices)
+                m.indices.push_back(base + i);
+        }
+        return m;
+    }
+
+    // pozycje względnie do skali współrzędnych (tor do kilkuset metrów od początku)
+    void compare(const MeshOut& ref, const MeshOut& inst, Err& err) {
+        RC_CHECK(ref.vertices.size() == inst.vertices.size());
+        RC_CHECK(ref.indices == inst.indices);
+        if (ref.vertices.size() != inst.vertices.size())
+            return;
+        bool uv = true;
+        for (std::size_t k = 0; k < ref.vertices.size(); ++k) {
+            const Vertex& a = ref.vertices[k];
+            const Vertex& b = inst.vertices[k];
+            const float scale = std::max({1.f, std::abs(a.pos.x), std::abs(a.pos.y), std::abs(a.pos.z)});
+            err.pos = std::max(err.pos, glm::length(a.pos - b.pos) / scale);
+            err.normal = std::max(err.normal, glm::length(a.normal - b.normal));
+            uv &= a.uv.x == b.uv.x && a.uv.y == b.uv.y;
+        }
+        RC_CHECK(uv);
+        ++err.meshes;
+    }
+
+    glm::vec3 randomPoint(std::mt19937& rng, float range) {
+        std::uniform_real_distribution<float> d(-range, range);
+        return {d(rng), d(rng), d(rng)};
+    }
+
+    glm::vec3 randomDir(std::mt19937& rng) {
+        for (;;) {
+            const glm::vec3 v = randomPoint(rng, 1.f);
+            const float l = glm::length(v);
+            if (l > 0.1f && l <= 1.f)
+                return v / l;
+        }
+    }
+
+    // kierunki przy progu |T.y| = 0.99, gdzie baza przechodzi z up na oś x, i dokładnie pionowe
+    std::vector<glm::vec3> edgeDirs() {
+        std::vector<glm::vec3> dirs = {{0, 1, 0}, {0, -1, 0}, {1, 0, 0}, {0, 0, 1}, {1, 0, 1}};
+        for (const float y: {0.985f, 0.9899f, 0.9901f, 0.995f, 0.99999f}) {
+            const float h = std::sqrt(1.f - y * y);
+            dirs.push_back({h, y, 0});
+            dirs.push_back({0, -y, h});
+            dirs.push_back({-0.6f * h, y, 0.8f * h});
+        }
+        return dirs;
+    }
+
+    void beams(std::mt19937& rng, Err& err) {
+        std::uniform_real_distribution<float> len(0.2f, 4.f), size(0.05f, 0.5f);
+        std::vector<glm::vec3> dirs = edgeDirs();
+        for (int k = 0; k < 200; ++k)
+            dirs.push_back(randomDir(rng));
+        for (const auto& dir: dirs) {
+            const glm::vec3 A = randomPoint(rng, 300.f);
+            const glm::vec3 B = A + dir * len(rng);
+            const float thick = size(rng), height = size(rng);
+            MeshOut ref;
+            SupportGeometryBuilder(ref).addBeamBox(A, B, thick, height);
+            SupportInstances si;
+            SupportInstanceBuilder(si).addBeamBox(A, B, thick, height);
+            RC_CHECK(si.ties.size() == 1 && si.columns.empty() && si.feet.empty());
+            compare(ref, expand(SupportInstanceBuilder::tieTemplate(), si.ties), err);
+        }
+    }
+
+    void columns(std::mt19937& rng, Err& err) {
+        std::uniform_real_distribution<float> len(0.5f, 60.f), radius(0.05f, 0.6f);
+        std::vector<glm::vec3> dirs = edgeDirs();
+        for (int k = 0; k < 200; ++k)
+            dirs.push_back(randomDir(rng));
+        for (const int sides: {6, 12, 16}) {
+            const MeshOut tmpl = SupportInstanceBuilder::columnTemplate(sides);
+            for (const auto& dir: dirs) {
+                const glm::vec3 top = randomPoint(rng, 300.f);
+                const glm::vec3 bottom = top + dir * len(rng);
+                const float r = radius(rng);
+                MeshOut ref;
+                SupportGeometryBuilder(ref).addSupportCylinder(top, bottom, r, sides);
+                SupportInstances si;
+                SupportInstanceBuilder(si).addSupportCylinder(top, bottom, r);
+                RC_CHECK(si.columns.size() == 1);
+                compare(ref, expand(tmpl, si.columns), err);
+            }
+        }
+    }
+
+    void feet(std::mt19937& rng, Err& err) {
+        std::uniform_real_distribution<float> radius(0.1f, 1.5f);
+        for (const int sides: {6, 12, 16}) {
+            const MeshOut tmpl = SupportInstanceBuilder::footTemplate(sides);
+            // kilka stopek na jednym szablonie - indeksy kolejnych instancji jak w jednej wypalonej siatce
+            MeshOut ref;
+            SupportInstances si;
+            for (int k = 0; k < 50; ++k) {
+                const glm::vec3 c = randomPoint(rng, 300.f);
+                const float r = radius(rng);
+                SupportGeometryBuilder(ref).addFootDisk(c, r, sides);
+                SupportInstanceBuilder(si).addFootDisk(c, r);
+            }
+            RC_CHECK(si.feet.size() == 50);
+            compare(ref, expand(tmpl, si.feet), err);
+        }
+    }
+
+    void degenerate() {
+        // za krótkie belki i słupy nie dają ani geometrii, ani instancji
+        const glm::vec3 p(10, 20, 30);
+        MeshOut ref;
+        SupportGeometryBuilder(ref).addBeamBox(p, p + glm::vec3(5e-7f, 0, 0), 0.2f, 0.2f);
+        SupportGeometryBuilder(ref).addSupportCylinder(p, p + glm::vec3(0, -5e-6f, 0), 0.2f);
+        SupportInstances si;
+        SupportInstanceBuilder(si).addBeamBox(p, p + glm::vec3(5e-7f, 0, 0), 0.2f, 0.2f);
+        SupportInstanceBuilder(si).addSupportCylinder(p, p + glm::vec3(0, -5e-6f, 0), 0.2f);
+        RC_CHECK(ref.vertices.empty() && ref.indices.empty());
+        RC_CHECK(si.ties.empty() && si.columns.empty());
+    }
+} // namespace
+
+int main() {
+    std::mt19937 rng(34);
+    Err err;
+    beams(rng, err);
+    columns(rng, err);
+    feet(rng, err);
+    degenerate();
+    std::printf("%d meshes: max |dP| / max(1, |P|) %.2e, max |dN| %.2e\n", err.meshes, err.pos, err.normal);
+    RC_CHECK_LE(err.pos, 1e-6f);
+    RC_CHECK_LE(err.normal, 1e-6f);
+    return RC_TEST_RESULT();
+}
@@ -0,0 +1,266 @@
+//
+// Created by mwed on 18.10.2026.
+//
+// TerrainQuadtree bez GL: liście pokrywają mapę raz, ramki wysokości są dokładne, sąsiedzi różnią się o co najwyżej poziom, maski zszycia
+// zgadzają się z sąsiadami, zszyte łaty są szczelne (każda krawędź wewnętrzna w dwóch trójkątach w przeciwnych
+// kierunkach, pole = pole mapy), odrzucanie ostrosłupem zostawia dokładnie liście przecinające ostrosłup.
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "Check.hpp"
+#include "terrain/Terrain.hpp"
+#include "terrain/TerrainQuadtree.hpp"
+
+namespace {
+    using Node = TerrainQuadtree::Node;
+
+    struct Map {
+        int width, height;
+        std::vector<float> h;
+    };
+
+    Map makeMap(int width, int height) {
+        Map m{width, height, std::vector<float>(static_cast<std::size_t>(width) * height)};
+        for (int z = 0; z < height; ++z)
+            for (int x = 0; x < width; ++x)
+                m.h[static_cast<std::size_t>(z) * width + x] =
+                        20.f * std::sin(x * 0.013f) * std::cos(z * 0.021f) + 3.f * std::sin(x * 0.11f + z * 0.07f);
+        return m;
+    }
+
+    struct Leaves {
+        int cellsX, cellsZ;
+        std::vector<int> level; // poziom liścia na oczko, -1 - nic, -2 - więcej niż jeden liść
+        int at(int x, int z) const { return level[static_cast<std::size_t>(z) * cellsX + x]; }
+    };
+
+    Leaves rasterize(const TerrainQuadtree& qt, const Map& m, const std::vector<Node>& nodes) {
+        Leaves lv{m.width - 1, m.height - 1, std::vector<int>(static_cast<std::size_t>(m.width - 1) * (m.height - 1), -1)};
+        for (const Node& n: nodes) {
+            glm::vec3 lo, hi;
+            qt.nodeBox(n, lo, hi);
+            for (int z = int(lo.z); z < int(hi.z); ++z)
+                for (int x = int(lo.x); x < int(hi.x); ++x) {
+                    int& c = lv.level[static_cast<std::size_t>(z) * lv.cellsX + x];
+                    c = c == -1 ? n.level : -2;
+                }
+        }
+        return lv;
+    }
+
+    // pokrycie raz, balans poziomów, maski zszycia jak u sąsiadów
+    void checkLeaves(const TerrainQuadtree& qt, const Map& m, const std::vector<Node>& nodes, int& maxDiff) {
+        const Leaves lv = rasterize(qt, m, nodes);
+        int holes = 0;
+        for (const int l: lv.level)
+            holes += l < 0;
+        RC_CHECK(holes == 0);
+        for (int z = 0; z < lv.cellsZ; ++z)
+            for (int x = 0; x < lv.cellsX; ++x) {
+                if (x + 1 < lv.cellsX)
+                    maxDiff = std::max(maxDiff, std::abs(lv.at(x, z) - lv.at(x + 1, z)));
+                if (z + 1 < lv.cellsZ)
+                    maxDiff = std::max(maxDiff, std::abs(lv.at(x, z) - lv.at(x, z + 1)));
+            }
+
+        int wrongStitch = 0, wrongBox = 0;
+        for (const Node& n: nodes) {
+            glm::vec3 lo, hi;
+            qt.nodeBox(n, lo, hi);
+            // ramka wysokości = dokładnie min/max wierzchołków węzła
+            float hMin = 1e30f, hMax = -1e30f;
+            for (int z = int(lo.z); z <= int(hi.z); ++z)
+                for (int x = int(lo.x); x <= int(hi.x); ++x) {
+                    hMin = std::min(hMin, m.h[static_cast<std::size_t>(z) * m.width + x]);
+                    hMax = std::max(hMax, m.h[static_cast<std::size_t>(z) * m.width + x]);
+                }
+            wrongBox += hMin != lo.y || hMax != hi.y;
+            const int x0 = int(lo.x), x1 = int(hi.x), z0 = int(lo.z), z1 = int(hi.z);
+            // krawędź zszyta <=> za nią jest grubszy liść (po balansie - wzdłuż całej krawędzi)
+            auto coarser = [&](bool alongX, int fixed, int a, int b) {
+                bool any = false;
+                for (int t = a; t < b; ++t)
+                    any |= (alongX ? lv.at(t, fixed) : lv.at(fixed, t)) > n.level;
+                return any;
+            };
+            std::uint8_t expect = 0;
+            if (z0 > 0 && coarser(true, z0 - 1, x0, x1)) expect |= TerrainQuadtree::EdgeNegZ;
+            if (x1 < lv.cellsX && coarser(false, x1, z0, z1)) expect |= TerrainQuadtree::EdgePosX;
+            if (z1 < lv.cellsZ && coarser(true, z1, x0, x1)) expect |= TerrainQuadtree::EdgePosZ;
+            if (x0 > 0 && coarser(false, x0 - 1, z0, z1)) expect |= TerrainQuadtree::EdgeNegX;
+            wrongStitch += expect != n.stitch;
+        }
+        RC_CHECK(wrongStitch == 0);
+        RC_CHECK(wrongBox == 0);
+    }
+
+    // Zszyte łaty jako jedna siatka w oczkach mapy. Bez trójkątów zdegenerowanych (przycięte do brzegu) każdy
+    // trójkąt ma normalną +y, pola sumują się do pola mapy, a każda krawędź skierowana ma partnera w drugą
+    // stronę - albo leży na brzegu mapy. T-połączenie zostawiłoby krawędź bez partnera w środku mapy.
+    void checkWatertight(const TerrainQuadtree& qt, const Map& m, const std::vector<Node>& nodes,
+                         const TerrainQuadtree::PatchIndices& pi) {
+        std::vector<TVertex> verts(TerrainQuadtree::kPatchVertexCount);
+        std::unordered_map<std::uint64_t, int> edges; // (a, b) -> +1, (b, a) -> -1
+        edges.reserve(nodes.size() * TerrainQuadtree::kPatchVertexCount * 3);
+        const auto key = [&](const glm::vec3& p) {
+            return static_cast<std::uint64_t>(p.z) * static_cast<std::uint64_t>(m.width) + static_cast<std::uint64_t>(p.x);
+        };
+        double area = 0.0;
+        int downFacing = 0;
+        for (const Node& n: nodes) {
+            qt.buildPatch(n, m.h, {}, 1.f, verts.data());
+            const std::uint32_t first = pi.first[n.stitch], count = pi.count[n.stitch];
+            for (std::uint32_t k = first; k < first + count; k += 3) {
+                const glm::vec3 a = verts[pi.indices[k]].pos, b = verts[pi.indices[k + 1]].pos,
+                                c = verts[pi.indices[k + 2]].pos;
+                const double ny = double(b.z - a.z) * (c.x - a.x) - double(b.x - a.x) * (c.z - a.z);
+                if (ny == 0.0)
+                    continue;
+                downFacing += ny < 0.0;
+                area += 0.5 * ny;
+                for (const auto& [p, q]: {std::pair{a, b}, std::pair{b, c}, std::pair{c, a}}) {
+                    const std::uint64_t kp = key(p), kq = key(q);
+                    if (kp < kq)
+                        edges[kp << 32 | kq]++;
+                    else
+                        edges[kq << 32 | kp]--;
+                }
+            }
+        }
+        RC_CHECK(downFacing == 0);
+        RC_CHECK_LE(std::abs(area - double(m.width - 1) * (m.height - 1)), 1e-6);
+
+        int open = 0;
+        for (const auto& [e, bal]: edges) {
+            if (bal == 0)
+                continue;
+            const auto a = e >> 32, b = e & 0xFFFFFFFFu;
+            const auto ax = a % m.width, az = a / m.width, bx = b % m.width, bz = b / m.width;
+            const bool boundary = std::abs(bal) == 1 &&
+                                  ((ax == bx && (ax == 0 || ax == std::uint64_t(m.width - 1))) ||
+                                   (az == bz && (az == 0 || az == std::uint64_t(m.height - 1))));
+            open += !boundary;
+        }
+        RC_CHECK(open == 0);
+    }
+
+    void selection() {
+        const auto pi = TerrainQuadtree::buildPatchIndices();
+        // kwadratowe, nieparzyste, mapy na jeden węzeł i dużo dłuższe niż szersze
+        const int dims[][2] = {{65, 65}, {100, 37}, {257, 257}, {1025, 513}, {300, 777}, {2049, 130}};
+        for (const auto& d: dims) {
+            const Map m = makeMap(d[0], d[1]);
+            TerrainQuadtree qt;
+            qt.build(m.width, m.height, m.h);
+            RC_CHECK(!qt.empty());
+            const float W = float(m.width - 1), H = float(m.height - 1);
+            const glm::vec3 cams[] = {{0.5f * W, 30.f, 0.5f * H}, {0.f, 5.f, 0.f},    {W, 80.f, 0.3f * H},
+                                      {0.37f * W, 2.f, H},        {-200.f, 10.f, 0.5f * H}, {0.7f * W, 600.f, 0.2f * H},
+                                      // pod terenem (wysokość oka 0) na brzegu węzła 128 przy węźle 256 - przy lodRange < sqrt(2)
+                                      // liść 64 stykałby się z liściem 256
+                                      {128.f, -100.f, 0.5f * H}};
+            int maxDiff = 0, maxLeaves = 0;
+            for (const float range: {0.5f, 2.5f}) { // 0.5 - przycięte do kMinLodRange
+                qt.setLodRange(range);
+                RC_CHECK(qt.lodRange() >= TerrainQuadtree::kMinLodRange);
+                for (const auto& cam: cams) {
+                    std::vector<Node> nodes;
+                    TerrainQuadtree::SelectStats st;
+                    qt.select(cam, nullptr, nodes, &st);
+                    RC_CHECK(st.selected == nodes.size() && st.culled == 0);
+                    checkLeaves(qt, m, nodes, maxDiff);
+                    checkWatertight(qt, m, nodes, pi);
+                    maxLeaves = std::max(maxLeaves, int(nodes.size()));
+                }
+            }
+            std::printf("%dx%d: levels %d, up to %d leaves, max level step %d\n", m.width, m.height, qt.levels(),
+                        maxLeaves, maxDiff);
+            RC_CHECK(maxDiff <= 1);
+        }
+    }
+
+    void frustumCulling() {
+        // niekwadratowa mapa, kamera na brzegu patrzy w głąb wzdłuż x i ukośnie w dół
+        const Map m = makeMap(1025, 385);
+        TerrainQuadtree qt;
+        qt.build(m.width, m.height, m.h);
+        qt.setLodRange(2.f);
+        struct Cam {
+            glm::vec3 eye, target;
+            bool anyVisible;
+        };
+        const Cam cams[] = {{{10.f, 40.f, 190.f}, {600.f, 0.f, 200.f}, true},
+                            {{900.f, 120.f, 50.f}, {700.f, 0.f, 300.f}, true},
+                            {{512.f, 150.f, 190.f}, {512.f, 0.f, 191.f}, true},     // z góry
+                            {{-50.f, 30.f, 190.f}, {-600.f, 0.f, 190.f}, false}}; // tyłem do mapy
+        for (const Cam& c: cams) {
+            const glm::mat4 proj = glm::perspective(glm::radians(60.f), 16.f / 9.f, 0.5f, 3000.f);
+            const glm::mat4 view = glm::lookAt(c.eye, c.target, glm::vec3(0, 1, 0));
+            const auto fr = rc::math::Frustum::fromMatrix(proj * view);
+
+            std::vector<Node> all, vis;
+            TerrainQuadtree::SelectStats st;
+            qt.select(c.eye, nullptr, all, nullptr);
+            qt.select(c.eye, &fr, vis, &st);
+
+            // to samo drzewo, te same maski - wypadają tylko liście, których ramka nie przecina ostrosłupa
+            std::vector<std::uint64_t> expect, got;
+            for (const Node& n: all) {
+                glm::vec3 lo, hi;
+                qt.nodeBox(n, lo, hi);
+                if (fr.intersectsBox(lo, hi))
+                    expect.push_back(std::uint64_t(n.key()) << 8 | n.stitch);
+            }
+            for (const Node& n: vis)
+                got.push_back(std::uint64_t(n.key()) << 8 | n.stitch);
+            std::sort(expect.begin(), expect.end());
+            std::sort(got.begin(), got.end());
+            RC_CHECK(got == expect);
+            RC_CHECK(st.selected == vis.size());
+            RC_CHECK(c.anyVisible == !vis.empty());
+            if (c.anyVisible)
+                RC_CHECK(st.culled > 0);
+
+            // każdy punkt terenu w ostrosłupie leży w którymś widocznym liściu
+            int missing = 0;
+            for (int z = 0; z < m.height; z += 3)
+                for (int x = 0; x < m.width; x += 3) {
+                    const glm::vec3 p(float(x), m.h[static_cast<std::size_t>(z) * m.width + x], float(z));
+                    if (!fr.intersectsSphere(p, 0.f))
+                        continue;
+                    bool in = false;
+                    for (const Node& n: vis) {
+                        glm::vec3 lo, hi;
+                        qt.nodeBox(n, lo, hi);
+                        in |= p.x >= lo.x && p.x <= hi.x && p.z >= lo.z && p.z <= hi.z;
+                    }
+                    missing += !in;
+                }
+            RC_CHECK(missing == 0);
+            std::printf("camera (%.0f, %.0f, %.0f): %zu of %zu leaves, %zu subtrees culled\n", c.eye.x, c.eye.y,
+                        c.eye.z, vis.size(), all.size(), st.culled);
+        }
+    }
+} // namespace
+
+int main() {
+    selection();
+    frustumCulling();
+
+    // za mała mapa - nic do wyboru
+    TerrainQuadtree none;
+    none.build(1, 40, std::vector<float>(40, 0.f));
+    std::vector<Node> out{Node{}};
+    none.select({0.f, 0.f, 0.f}, nullptr, out);
+    RC_CHECK(none.empty() && out.empty());
+    return RC_TEST_RESULT();
+}